@@ -8,6 +8,17 @@
 #include "ArlnFrame.hpp"
 #include "ArlnImage.hpp"
 #include "ArlnDescriptor.hpp"
+#include "ArlnUploadEngine.hpp"
+#include "ArlnSync.hpp"
+#include "ArlnDeletionQueue.hpp"
+#include "ArlnWorkerPool.hpp"
+#include "ArlnRenderGraph.hpp"
+#include "ArlnTransientAllocator.hpp"
+#include "ArlnBufferAllocator.hpp"
+#include "ArlnReadback.hpp"
+#include "ArlnDefragmenter.hpp"
+#include "ArlnProfiler.hpp"
+#include "ArlnCapture.hpp"
 #include "ArlnWindow.hpp"
 #include "ArlnMath.hpp"
 #include "ArlnTypes.hpp"
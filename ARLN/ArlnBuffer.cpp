@@ -1,18 +1,83 @@
 #include "ArlnBuffer.hpp"
 #include "ArlnContext.hpp"
 #include <cstring>
+#include <algorithm>
 
 namespace arln {
 
-    Buffer::Buffer(BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept
+    Buffer::Buffer(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept
+        : m_context{ &t_context }
     {
-        recreate(t_usage, t_memoryType, t_size);
+        recreate(t_context, t_usage, t_memoryType, t_size);
     }
 
-    void Buffer::recreate(BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept
+    Buffer::~Buffer() noexcept
+    {
+        if (m_tracked) m_context->getDefragmenter().untrack(*this);
+    }
+
+    Buffer::Buffer(Buffer const& t_other) noexcept
+    {
+        *this = t_other;
+    }
+
+    Buffer::Buffer(Buffer&& t_other) noexcept
+    {
+        *this = std::move(t_other);
+    }
+
+    Buffer& Buffer::operator=(Buffer const& t_other) noexcept
+    {
+        if (this == &t_other)
+        {
+            return *this;
+        }
+
+        if (m_tracked) m_context->getDefragmenter().untrack(*this);
+
+        m_context             = t_other.m_context;
+        m_handle              = t_other.m_handle;
+        m_allocation          = t_other.m_allocation;
+        m_allocationInfo      = t_other.m_allocationInfo;
+        m_deviceAddress       = t_other.m_deviceAddress;
+        m_opaqueAddress       = t_other.m_opaqueAddress;
+        m_opaqueMemoryAddress = t_other.m_opaqueMemoryAddress;
+        m_usage               = t_other.m_usage;
+        m_tracked             = false;
+
+        return *this;
+    }
+
+    Buffer& Buffer::operator=(Buffer&& t_other) noexcept
+    {
+        if (this == &t_other)
+        {
+            return *this;
+        }
+
+        *this = static_cast<Buffer const&>(t_other);
+
+        if (t_other.m_tracked)
+        {
+            m_context->getDefragmenter().retrack(t_other, *this);
+            t_other.m_tracked = false;
+            m_tracked = true;
+        }
+
+        return *this;
+    }
+
+    void Buffer::recreate(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept
+    {
+        recreate(t_context, t_usage, t_memoryType, t_size, 0, 0);
+    }
+
+    void Buffer::recreate(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_size, u64 t_opaqueAddress, u64 t_opaqueMemoryAddress) noexcept
     {
         free();
 
+        m_context = &t_context;
+
         VkBufferCreateInfo bufferCreateInfo;
         bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferCreateInfo.pNext = nullptr;
@@ -23,6 +88,13 @@ namespace arln {
         bufferCreateInfo.queueFamilyIndexCount = 0;
         bufferCreateInfo.pQueueFamilyIndices = nullptr;
 
+        if (auto& queueFamilyIndices = m_context->getQueueFamilyIndices(); queueFamilyIndices.size() > 1)
+        {
+            bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferCreateInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilyIndices.size());
+            bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+        }
+
         VmaAllocationCreateInfo allocationCreateInfo{};
         allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
 
@@ -44,104 +116,188 @@ namespace arln {
                 allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
                                              VMA_ALLOCATION_CREATE_MAPPED_BIT;
                 break;
+            case MemoryType::eReadback:
+                allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                             VMA_ALLOCATION_CREATE_MAPPED_BIT;
+                allocationCreateInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                break;
             default:
                 break;
         }
 
-        if (vmaCreateBuffer(
-            CurrentContext()->getAllocator(),
-            &bufferCreateInfo,
-            &allocationCreateInfo,
-            &m_handle,
-            &m_allocation,
-            &m_allocationInfo)
-            != VK_SUCCESS)
+        // Only dedicated allocations carry their own priority, the rest share blocks at the default of 0.5.
+        // Host memory used for staging and readbacks is the first that may leave device local heaps
+        allocationCreateInfo.priority = t_memoryType == MemoryType::eCpu || t_memoryType == MemoryType::eReadback ? 0.0f : 0.5f;
+
+        // Replayable addresses belong to a buffer and its own memory, so those buffers are never suballocated
+        bool const captureAddress = m_context->isAddressCaptureSupported() && (m_context->getCapture().isEnabled() || t_opaqueAddress);
+
+        VkBufferOpaqueCaptureAddressCreateInfo opaqueAddressCreateInfo{ VK_STRUCTURE_TYPE_BUFFER_OPAQUE_CAPTURE_ADDRESS_CREATE_INFO };
+        opaqueAddressCreateInfo.opaqueCaptureAddress = t_opaqueAddress;
+
+        if (captureAddress)
+        {
+            bufferCreateInfo.pNext = &opaqueAddressCreateInfo;
+            bufferCreateInfo.flags |= VK_BUFFER_CREATE_DEVICE_ADDRESS_CAPTURE_REPLAY_BIT;
+            allocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        }
+
+        auto create = [&]
+        {
+            Context::setMemoryCaptureAddress(captureAddress ? m_context : nullptr, t_opaqueMemoryAddress);
+
+            VkResult const result = vmaCreateBuffer(
+                m_context->getAllocator(),
+                &bufferCreateInfo,
+                &allocationCreateInfo,
+                &m_handle,
+                &m_allocation,
+                &m_allocationInfo);
+
+            Context::setMemoryCaptureAddress(nullptr, 0);
+            return result;
+        };
+
+        VkResult result = create();
+
+        if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+        {
+            // VMA probes with a temporary buffer, which must not claim a replayed address
+            VkBufferCreateInfo probeCreateInfo = bufferCreateInfo;
+            probeCreateInfo.pNext = nullptr;
+            probeCreateInfo.flags = 0;
+
+            u32 memoryTypeIndex = ~0u;
+            vmaFindMemoryTypeIndexForBufferInfo(m_context->getAllocator(), &probeCreateInfo, &allocationCreateInfo, &memoryTypeIndex);
+
+            m_context->relieveMemoryPressure(memoryTypeIndex);
+            result = create();
+        }
+
+        if (result != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to allocate buffer");
+            m_context->getErrorCallback()("Failed to allocate buffer");
         }
 
-        vmaGetAllocationMemoryProperties(CurrentContext()->getAllocator(), m_allocation, &m_allocationInfo.memoryType);
+        vmaGetAllocationMemoryProperties(m_context->getAllocator(), m_allocation, &m_allocationInfo.memoryType);
+        m_usage = bufferCreateInfo.usage;
 
         VkBufferDeviceAddressInfo bufferDeviceAddressInfo;
         bufferDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
         bufferDeviceAddressInfo.buffer = m_handle;
         bufferDeviceAddressInfo.pNext = nullptr;
 
-        m_deviceAddress = vkGetBufferDeviceAddress(CurrentContext()->getDevice(), &bufferDeviceAddressInfo);
+        m_deviceAddress = m_context->getDeviceTable().vkGetBufferDeviceAddress(m_context->getDevice(), &bufferDeviceAddressInfo);
+        m_opaqueAddress = 0;
+        m_opaqueMemoryAddress = 0;
+
+        if (captureAddress)
+        {
+            VkDeviceMemoryOpaqueCaptureAddressInfo memoryOpaqueAddressInfo{ VK_STRUCTURE_TYPE_DEVICE_MEMORY_OPAQUE_CAPTURE_ADDRESS_INFO };
+            memoryOpaqueAddressInfo.memory = m_allocationInfo.deviceMemory;
+
+            m_opaqueAddress = m_context->getDeviceTable().vkGetBufferOpaqueCaptureAddress(m_context->getDevice(), &bufferDeviceAddressInfo);
+            m_opaqueMemoryAddress = m_context->getDeviceTable().vkGetDeviceMemoryOpaqueCaptureAddress(m_context->getDevice(), &memoryOpaqueAddressInfo);
+        }
+
+        m_context->getCapture().createBuffer(*this, t_usage, t_memoryType);
     }
 
     void Buffer::free() noexcept
     {
         if (m_handle)
         {
-            CurrentContext()->getFrame().addBufferToFree(*this);
+            m_context->getCapture().freeBuffer(m_handle);
+            m_context->getDefragmenter().release(*this);
+            m_context->getDeletionQueue().push(*this);
         }
 
         m_handle         = nullptr;
         m_allocation     = nullptr;
         m_allocationInfo = { };
+        m_tracked        = false;
+    }
+
+    auto Buffer::getDeviceAddress() const noexcept -> u64 const*
+    {
+        if (m_handle)
+        {
+            m_context->getDefragmenter().pin(m_handle);
+        }
+
+        return &m_deviceAddress;
     }
 
     void Buffer::writeData(void const* t_data, size_t t_size, size_t t_offset) noexcept
     {
-        if (m_allocationInfo.memoryType & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        BufferWrite const write{ t_data, t_size, t_offset };
+        writeData({ &write, 1 });
+    }
+
+    void Buffer::writeData(std::span<const BufferWrite> t_writes) noexcept
+    {
+        for (auto& write : t_writes)
         {
-            u8* memoryOffset = (u8*)m_allocationInfo.pMappedData;
-            memoryOffset += t_offset;
-            memcpy(memoryOffset, t_data, t_size);
+            m_context->getCapture().writeBuffer(*this, write.data, write.size, write.offset);
+        }
 
-            vmaFlushAllocation(CurrentContext()->getAllocator(), m_allocation, 0, ~0ULL);
+        if (!(m_allocationInfo.memoryType & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+        {
+            for (auto& write : t_writes)
+            {
+                m_context->getFrame().uploadBuffer(m_handle, write.data, write.size, write.offset);
+            }
+            return;
+        }
+
+        for (auto& write : t_writes)
+        {
+            memcpy(static_cast<u8*>(m_allocationInfo.pMappedData) + write.offset, write.data, write.size);
+        }
+
+        if (m_allocationInfo.memoryType & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+        {
+            return;
         }
-        else
+
+        // Flushed ranges must start and end on nonCoherentAtomSize, neighbouring writes share one range
+        VkDeviceSize const atomSize = std::max<VkDeviceSize>(m_context->getPhysicalDeviceProperties().properties.limits.nonCoherentAtomSize, 1);
+        std::vector<std::pair<VkDeviceSize, VkDeviceSize>> ranges;
+        ranges.reserve(t_writes.size());
+
+        for (auto& write : t_writes)
         {
-            if (t_size > CurrentContext()->getFrame().getStagingBuffer().getSize())
+            if (write.size)
             {
-                Buffer staging;
-                staging.recreate(0, MemoryType::eCpu, t_size);
-
-                staging.writeData(t_data, t_size);
-
-                CurrentContext()->immediateSubmit([&](VkCommandBuffer t_cmd)
-                {
-                    VkBufferCopy bufferCopy = {
-                        .srcOffset = 0,
-                        .dstOffset = t_offset,
-                        .size = t_size
-                    };
-
-                    vkCmdCopyBuffer(
-                        t_cmd,
-                        staging.getHandle(),
-                        m_handle,
-                        1,
-                        &bufferCopy
-                    );
-                });
-
-                staging.free();
+                VkDeviceSize const begin = write.offset / atomSize * atomSize;
+                VkDeviceSize const end = (write.offset + write.size + atomSize - 1) / atomSize * atomSize;
+                ranges.emplace_back(begin, std::min<VkDeviceSize>(end, m_allocationInfo.size));
             }
-            else
+        }
+
+        if (ranges.empty())
+        {
+            return;
+        }
+
+        std::sort(ranges.begin(), ranges.end());
+
+        std::vector<VkDeviceSize> offsets;
+        std::vector<VkDeviceSize> sizes;
+
+        for (auto [begin, end] : ranges)
+        {
+            if (!offsets.empty() && begin <= offsets.back() + sizes.back())
             {
-                CurrentContext()->getFrame().getStagingBuffer().writeData(t_data, t_size, 0);
-
-                CurrentContext()->immediateSubmit([&](VkCommandBuffer t_cmd)
-                {
-                    VkBufferCopy bufferCopy = {
-                        .srcOffset = 0,
-                        .dstOffset = t_offset,
-                        .size = t_size
-                    };
-
-                    vkCmdCopyBuffer(
-                        t_cmd,
-                        CurrentContext()->getFrame().getStagingBuffer().getHandle(),
-                        m_handle,
-                        1,
-                        &bufferCopy
-                    );
-                });
+                sizes.back() = std::max(sizes.back(), end - offsets.back());
+                continue;
             }
 
+            offsets.push_back(begin);
+            sizes.push_back(end - begin);
         }
+
+        std::vector<VmaAllocation> allocations(offsets.size(), m_allocation);
+        vmaFlushAllocations(m_context->getAllocator(), static_cast<u32>(allocations.size()), allocations.data(), offsets.data(), sizes.data());
     }
 }
\ No newline at end of file
@@ -7,30 +7,51 @@ namespace arln {
     {
     private:
         friend class Context;
-        Buffer(BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept;
+        friend class TransientAllocator;
+        friend class Defragmenter;
+        friend class CaptureReplay;
+        Buffer(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept;
+
+        // Non-zero opaque addresses recreate a captured buffer at its captured device address
+        void recreate(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_size, u64 t_opaqueAddress, u64 t_opaqueMemoryAddress) noexcept;
 
     public:
         Buffer() = default;
-        ~Buffer() = default;
-        Buffer(Buffer const&) = default;
-        Buffer(Buffer&&) = default;
-        Buffer& operator=(Buffer const&) = default;
-        Buffer& operator=(Buffer&&) = default;
+        ~Buffer() noexcept;
+
+        // Copies are never tracked by the defragmenter, moves take the registration along
+        Buffer(Buffer const& t_other) noexcept;
+        Buffer(Buffer&& t_other) noexcept;
+        Buffer& operator=(Buffer const& t_other) noexcept;
+        Buffer& operator=(Buffer&& t_other) noexcept;
 
-        void recreate(BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept;
+        void recreate(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_size) noexcept;
         void free() noexcept;
         void writeData(void const* t_data, size_t t_size, size_t t_offset = 0) noexcept;
 
-        inline auto& getHandle()         const noexcept { return m_handle;              }
-        inline auto& getAllocation()     const noexcept { return m_allocation;          }
-        inline auto& getAllocationInfo() const noexcept { return m_allocationInfo;      }
-        inline auto& getSize()           const noexcept { return m_allocationInfo.size; }
-        inline auto* getDeviceAddress()  const noexcept { return &m_deviceAddress;      }
+        // Copies every region and flushes only the touched ranges of non-coherent memory, in a single call
+        void writeData(std::span<const BufferWrite> t_writes) noexcept;
+
+        // The defragmenter can not update addresses written to GPU memory, the buffer stays where it is
+        auto getDeviceAddress() const noexcept -> u64 const*;
+
+        inline auto  getContext()             const noexcept { return m_context;             }
+        inline auto& getHandle()              const noexcept { return m_handle;              }
+        inline auto& getAllocation()          const noexcept { return m_allocation;          }
+        inline auto& getAllocationInfo()      const noexcept { return m_allocationInfo;      }
+        inline auto& getSize()                const noexcept { return m_allocationInfo.size; }
+        inline auto  getOpaqueAddress()       const noexcept { return m_opaqueAddress;       }
+        inline auto  getOpaqueMemoryAddress() const noexcept { return m_opaqueMemoryAddress; }
 
     private:
-        VkBuffer          m_handle        { };
-        VmaAllocation     m_allocation    { };
-        VmaAllocationInfo m_allocationInfo{ };
-        u64               m_deviceAddress { };
+        Context*          m_context            { };
+        VkBuffer          m_handle             { };
+        VmaAllocation     m_allocation         { };
+        VmaAllocationInfo m_allocationInfo     { };
+        u64               m_deviceAddress      { };
+        u64               m_opaqueAddress      { };
+        u64               m_opaqueMemoryAddress{ };
+        BufferUsage       m_usage              { };
+        bool              m_tracked            { };
     };
 }
\ No newline at end of file
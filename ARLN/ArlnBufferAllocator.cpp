@@ -0,0 +1,147 @@
+#include "ArlnBufferAllocator.hpp"
+#include "ArlnContext.hpp"
+
+namespace arln {
+
+    BufferAllocator::BufferAllocator(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_blockSize) noexcept
+        : m_context{ &t_context }
+        , m_usage{ t_usage }
+        , m_memoryType{ t_memoryType }
+        , m_blockSize{ t_blockSize }
+        , m_alignment{ 16 }
+    {
+        auto& limits = m_context->getPhysicalDeviceProperties().properties.limits;
+
+        if (t_usage & BufferUsageBits::eUniformBuffer)
+        {
+            m_alignment = std::max<size_t>(m_alignment, limits.minUniformBufferOffsetAlignment);
+        }
+
+        if (t_usage & BufferUsageBits::eStorageBuffer)
+        {
+            m_alignment = std::max<size_t>(m_alignment, limits.minStorageBufferOffsetAlignment);
+        }
+    }
+
+    auto BufferAllocator::allocate(size_t t_size, size_t t_alignment) noexcept -> BufferSlice
+    {
+        collect();
+
+        VmaVirtualAllocationCreateInfo allocationCreateInfo{ };
+        allocationCreateInfo.size = t_size;
+        allocationCreateInfo.alignment = std::max(t_alignment, m_alignment);
+
+        BufferSlice slice;
+        slice.size = t_size;
+
+        auto tryBlock = [&](u32 t_block)
+        {
+            VkDeviceSize offset;
+            if (vmaVirtualAllocate(m_blocks[t_block].virtualBlock, &allocationCreateInfo, &slice.allocation, &offset) != VK_SUCCESS)
+            {
+                return false;
+            }
+
+            slice.buffer = &m_blocks[t_block].buffer;
+            slice.offset = offset;
+            slice.deviceAddress = *slice.buffer->getDeviceAddress() + offset;
+            slice.block = t_block;
+            return true;
+        };
+
+        u32 block = 0;
+        while (block < m_blocks.size() && !tryBlock(block))
+        {
+            ++block;
+        }
+
+        // Every block is full, a new one is made large enough for the request
+        if (!slice)
+        {
+            size_t const alignedSize = (t_size + allocationCreateInfo.alignment - 1) / allocationCreateInfo.alignment * allocationCreateInfo.alignment;
+
+            VmaVirtualBlockCreateInfo blockCreateInfo{ };
+            blockCreateInfo.size = std::max(m_blockSize, alignedSize);
+
+            auto& newBlock = m_blocks.emplace_back();
+            newBlock.buffer = m_context->allocateBuffer(m_usage, m_memoryType, blockCreateInfo.size);
+
+            if (vmaCreateVirtualBlock(&blockCreateInfo, &newBlock.virtualBlock) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to create virtual block");
+            }
+
+            m_capacity += blockCreateInfo.size;
+            tryBlock(block);
+        }
+
+        if (!slice)
+        {
+            m_context->getErrorCallback()("Failed to allocate buffer slice");
+            return { };
+        }
+
+        m_allocatedSize += t_size;
+
+        return slice;
+    }
+
+    void BufferAllocator::free(BufferSlice const& t_slice) noexcept
+    {
+        if (!t_slice)
+        {
+            return;
+        }
+
+        // Same values the deletion queue waits for, work of the frame being recorded may still use the slice
+        m_pendingFrees.push_back(PendingFree{
+            .slice = t_slice,
+            .graphicsValue = m_context->getGraphicsTimeline().getSubmittedValue() + 1,
+            .computeValue = m_context->getComputeTimeline().getSubmittedValue()
+        });
+    }
+
+    void BufferAllocator::destroy() noexcept
+    {
+        for (auto& block : m_blocks)
+        {
+            vmaClearVirtualBlock(block.virtualBlock);
+            vmaDestroyVirtualBlock(block.virtualBlock);
+            block.buffer.free();
+        }
+
+        m_blocks.clear();
+        m_pendingFrees.clear();
+        m_capacity = 0;
+        m_allocatedSize = 0;
+    }
+
+    void BufferAllocator::collect() noexcept
+    {
+        if (m_pendingFrees.empty())
+        {
+            return;
+        }
+
+        u64 const graphicsValue = m_context->getGraphicsTimeline().getCompletedValue();
+        u64 const computeValue  = m_context->getComputeTimeline().getCompletedValue();
+
+        for (size_t i = m_pendingFrees.size(); i--; )
+        {
+            auto& pendingFree = m_pendingFrees[i];
+
+            if (pendingFree.graphicsValue <= graphicsValue && pendingFree.computeValue <= computeValue)
+            {
+                release(pendingFree.slice);
+                m_pendingFrees[i] = m_pendingFrees.back();
+                m_pendingFrees.pop_back();
+            }
+        }
+    }
+
+    void BufferAllocator::release(BufferSlice const& t_slice) noexcept
+    {
+        vmaVirtualFree(m_blocks[t_slice.block].virtualBlock, t_slice.allocation);
+        m_allocatedSize -= t_slice.size;
+    }
+}
\ No newline at end of file
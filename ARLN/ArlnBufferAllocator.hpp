@@ -0,0 +1,63 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include "ArlnBuffer.hpp"
+#include <deque>
+
+namespace arln {
+
+    // Carves slices out of large backing buffers through VMA virtual blocks, so many small uniform or storage
+    // buffers share one VkBuffer, one allocation and one device address range. Not thread safe, like the other allocators
+    class BufferAllocator
+    {
+    private:
+        friend class Context;
+        BufferAllocator(Context& t_context, BufferUsage t_usage, MemoryType t_memoryType, size_t t_blockSize) noexcept;
+
+    public:
+        BufferAllocator() = default;
+        ~BufferAllocator() = default;
+        BufferAllocator(BufferAllocator const&) = delete;
+        BufferAllocator(BufferAllocator&&) = default;
+        BufferAllocator& operator=(BufferAllocator const&) = delete;
+        BufferAllocator& operator=(BufferAllocator&&) = default;
+
+        // Zero alignment uses the offset alignment the usage requires for descriptors
+        auto allocate(size_t t_size, size_t t_alignment = 0) noexcept -> BufferSlice;
+
+        // The range is handed out again once the frames that may still read it have finished
+        void free(BufferSlice const& t_slice) noexcept;
+        void destroy() noexcept;
+
+        inline auto getBlockCount()    const noexcept { return static_cast<u32>(m_blocks.size()); }
+        inline auto getCapacity()      const noexcept { return m_capacity;                        }
+        inline auto getAllocatedSize() const noexcept { return m_allocatedSize;                   }
+        inline auto getAlignment()     const noexcept { return m_alignment;                       }
+
+    private:
+        struct Block
+        {
+            Buffer          buffer;
+            VmaVirtualBlock virtualBlock;
+        };
+
+        struct PendingFree
+        {
+            BufferSlice slice;
+            u64         graphicsValue;
+            u64         computeValue;
+        };
+
+        void collect() noexcept;
+        void release(BufferSlice const& t_slice) noexcept;
+
+        Context*                 m_context      { };
+        std::deque<Block>        m_blocks       { };
+        std::vector<PendingFree> m_pendingFrees { };
+        BufferUsage              m_usage        { };
+        MemoryType               m_memoryType   { };
+        size_t                   m_blockSize    { };
+        size_t                   m_alignment    { };
+        size_t                   m_capacity     { };
+        size_t                   m_allocatedSize{ };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,1529 @@
+#include "ArlnCapture.hpp"
+#include "ArlnContext.hpp"
+#include <filesystem>
+#include <algorithm>
+
+namespace arln {
+
+    static auto readShader(std::string_view t_path) noexcept -> std::vector<char>
+    {
+        if (t_path.empty())
+        {
+            return {};
+        }
+
+        std::ifstream file(std::string(t_path), std::ios::ate | std::ios::binary);
+
+        if (!file.is_open())
+        {
+            return {};
+        }
+
+        std::vector<char> code(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(code.data(), static_cast<std::streamsize>(code.size()));
+
+        return code;
+    }
+
+    void CaptureWriter::begin(CaptureOp t_op) noexcept
+    {
+        m_recordStart = m_data.size();
+        put(t_op);
+        put(u32{ 0 });
+    }
+
+    void CaptureWriter::end() noexcept
+    {
+        u32 const size = static_cast<u32>(m_data.size() - m_recordStart - sizeof(CaptureOp) - sizeof(u32));
+        std::memcpy(m_data.data() + m_recordStart + sizeof(CaptureOp), &size, sizeof(u32));
+    }
+
+    void CaptureWriter::putBytes(void const* t_data, size_t t_size) noexcept
+    {
+        put(static_cast<u64>(t_size));
+
+        if (t_size)
+        {
+            size_t const offset = m_data.size();
+            m_data.resize(offset + t_size);
+            std::memcpy(m_data.data() + offset, t_data, t_size);
+        }
+    }
+
+    void CaptureWriter::putString(std::string_view t_string) noexcept
+    {
+        putBytes(t_string.data(), t_string.size());
+    }
+
+    auto CaptureReader::next(CaptureOp& t_op, CaptureReader& t_payload) noexcept -> bool
+    {
+        if (m_offset + sizeof(CaptureOp) + sizeof(u32) > m_data.size())
+        {
+            return false;
+        }
+
+        t_op = get<CaptureOp>();
+        u32 const size = get<u32>();
+
+        if (m_offset + size > m_data.size())
+        {
+            return false;
+        }
+
+        t_payload = CaptureReader(m_data.subspan(m_offset, size));
+        m_offset += size;
+
+        return true;
+    }
+
+    auto CaptureReader::getBytes() noexcept -> std::span<const u8>
+    {
+        u64 const size = get<u64>();
+
+        if (m_offset > m_data.size() || size > m_data.size() - m_offset)
+        {
+            m_offset = m_data.size() + 1;
+            return {};
+        }
+
+        auto bytes = m_data.subspan(m_offset, size);
+        m_offset += size;
+
+        return bytes;
+    }
+
+    auto CaptureReader::getString() noexcept -> std::string_view
+    {
+        auto const bytes = getBytes();
+        return { reinterpret_cast<char const*>(bytes.data()), bytes.size() };
+    }
+
+    void Capture::create(Context& t_context, std::string const& t_path, u64 t_firstFrame, u64 t_frameCount) noexcept
+    {
+        m_context = &t_context;
+        m_path = t_path;
+        m_file.open(t_path, std::ios::binary | std::ios::trunc);
+
+        if (!m_file.is_open())
+        {
+            m_context->getErrorCallback()("Failed to open capture file: " + t_path);
+            return;
+        }
+
+        CaptureHeader header;
+        header.extent = m_context->getCurrentExtent();
+        header.colorFormat = m_context->getDefaultColorFormat();
+        header.depthFormat = m_context->getDefaultDepthFormat();
+
+        m_file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+        m_epoch = std::chrono::steady_clock::now();
+        m_frame = 0;
+        m_firstFrame = t_firstFrame;
+        m_lastFrame = t_firstFrame + std::max<u64>(t_frameCount, 1);
+        m_enabled = true;
+        m_recording = false;
+
+        // The uniform ring predates the capture but is bound by application descriptors, unlike the other frame buffers
+        if (auto& uniformRing = m_context->getFrame().getUniformRing(); uniformRing.getHandle())
+        {
+            createBuffer(uniformRing, BufferUsageBits::eUniformBuffer, MemoryType::eCpu);
+        }
+
+        if (!m_context->isAddressCaptureSupported())
+        {
+            m_context->getInfoCallback()("Buffer device addresses can not be captured on this device, replays will not match them");
+        }
+
+        m_context->getInfoCallback()("Capturing frames " + std::to_string(m_firstFrame) + " to " + std::to_string(m_lastFrame - 1) + " into " + t_path);
+    }
+
+    void Capture::teardown() noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_enabled)
+        {
+            finish();
+        }
+    }
+
+    void Capture::beginFrame() noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        CaptureWriter record;
+
+        if (m_frame == m_firstFrame)
+        {
+            for (auto& [buffer, shadow] : m_shadows)
+            {
+                if (shadow.end > shadow.begin)
+                {
+                    record.begin(CaptureOp::eWriteBuffer);
+                    record.put(buffer);
+                    record.put(static_cast<u64>(shadow.begin));
+                    record.putBytes(shadow.data.data() + shadow.begin, shadow.end - shadow.begin);
+                    record.end();
+                }
+            }
+
+            m_shadows.clear();
+            m_recording = true;
+        }
+
+        if (m_recording)
+        {
+            record.begin(CaptureOp::eBeginFrame);
+            record.put(m_frame);
+            record.put(std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - m_epoch).count());
+            record.end();
+        }
+
+        write(record);
+    }
+
+    void Capture::endFrame(std::span<const CommandBufferHandle> t_commandBuffers, std::span<const CommandBufferHandle> t_computeCommandBuffers, PipelineStage t_computeWaitStage) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        if (m_recording)
+        {
+            auto toIds = [](std::span<const CommandBufferHandle> t_handles)
+            {
+                std::vector<u64> ids(t_handles.size());
+
+                for (size_t i = ids.size(); i--; )
+                {
+                    ids[i] = captureId(t_handles[i]);
+                }
+
+                return ids;
+            };
+
+            CaptureWriter record;
+
+            for (auto& [commandBuffer, stream] : m_streams)
+            {
+                record.begin(CaptureOp::eCommandStream);
+                record.put(commandBuffer);
+                record.putBytes(stream.getData().data(), stream.getData().size());
+                record.end();
+            }
+
+            auto const graphicsIds = toIds(t_commandBuffers);
+            auto const computeIds = toIds(t_computeCommandBuffers);
+
+            record.begin(CaptureOp::eEndFrame);
+            record.put(std::span<const u64>(graphicsIds));
+            record.put(std::span<const u64>(computeIds));
+            record.put(t_computeWaitStage);
+            record.end();
+
+            write(record);
+            m_streams.clear();
+        }
+
+        if (++m_frame == m_lastFrame)
+        {
+            finish();
+        }
+    }
+
+    void Capture::createBuffer(Buffer const& t_buffer, BufferUsage t_usage, MemoryType t_memoryType) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateBuffer);
+        record.put(captureId(t_buffer.getHandle()));
+        record.put(t_usage);
+        record.put(t_memoryType);
+        record.put(static_cast<u64>(t_buffer.getSize()));
+        record.put(t_buffer.getOpaqueAddress());
+        record.put(t_buffer.getOpaqueMemoryAddress());
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::freeBuffer(VkBuffer t_buffer) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eFreeBuffer);
+        record.put(captureId(t_buffer));
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        m_shadows.erase(captureId(t_buffer));
+        write(record);
+    }
+
+    void Capture::writeBuffer(Buffer const& t_buffer, void const* t_data, size_t t_size, size_t t_offset) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        if (!m_recording)
+        {
+            auto& shadow = m_shadows[captureId(t_buffer.getHandle())];
+
+            if (shadow.data.empty())
+            {
+                shadow.data.resize(t_buffer.getSize());
+                shadow.begin = shadow.data.size();
+                shadow.end = 0;
+            }
+
+            if (t_offset + t_size <= shadow.data.size())
+            {
+                std::memcpy(shadow.data.data() + t_offset, t_data, t_size);
+                shadow.begin = std::min(shadow.begin, t_offset);
+                shadow.end = std::max(shadow.end, t_offset + t_size);
+            }
+
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eWriteBuffer);
+        record.put(captureId(t_buffer.getHandle()));
+        record.put(static_cast<u64>(t_offset));
+        record.putBytes(t_data, t_size);
+        record.end();
+
+        write(record);
+    }
+
+    void Capture::createImage(Image const& t_image, u32 t_width, u32 t_height, ImageUsage t_usage, MemoryType t_memoryType) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateImage);
+        record.put(captureId(t_image.getHandle()));
+        record.put(captureId(t_image.getView()));
+        record.put(t_width);
+        record.put(t_height);
+        record.put(t_image.getFormat());
+        record.put(t_usage);
+        record.put(t_memoryType);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        m_images.insert(captureId(t_image.getHandle()));
+        write(record);
+    }
+
+    void Capture::freeImage(VkImage t_image) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eFreeImage);
+        record.put(captureId(t_image));
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        m_images.erase(captureId(t_image));
+        write(record);
+    }
+
+    void Capture::writeImage(Image const& t_image, void const* t_data, size_t t_size, uvec2 t_extent) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eWriteImage);
+        record.put(image(t_image));
+        record.put(t_extent);
+        record.putBytes(t_data, t_size);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::transitionImage(Image const& t_image, ImageLayout t_old, ImageLayout t_new, PipelineStage t_srcStage, PipelineStage t_dstStage, Access t_srcAccess, Access t_dstAccess) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eTransitionImage);
+        record.put(image(t_image));
+        record.put(t_old);
+        record.put(t_new);
+        record.put(t_srcStage);
+        record.put(t_dstStage);
+        record.put(t_srcAccess);
+        record.put(t_dstAccess);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::createSampler(Sampler const& t_sampler, SamplerOptions const& t_options) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateSampler);
+        record.put(captureId(t_sampler.getHandle()));
+        record.put(t_options);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::freeSampler(VkSampler t_sampler) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eFreeSampler);
+        record.put(captureId(t_sampler));
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::createDescriptor(VkDescriptorPool t_pool, VkDescriptorSet t_set, VkDescriptorSetLayout t_layout, u32 t_setLayout, std::span<const VkDescriptorSetLayoutBinding> t_bindings) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateDescriptor);
+        record.put(captureId(t_pool));
+        record.put(captureId(t_set));
+        record.put(captureId(t_layout));
+        record.put(t_setLayout);
+        record.put(t_bindings);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::writeDescriptors(std::span<const VkWriteDescriptorSet> t_writes) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::vector<CaptureDescriptorWrite> writes(t_writes.size());
+
+        for (size_t i = writes.size(); i--; )
+        {
+            writes[i].set = captureId(t_writes[i].dstSet);
+            writes[i].binding = t_writes[i].dstBinding;
+            writes[i].element = t_writes[i].dstArrayElement;
+            writes[i].type = static_cast<DescriptorType>(t_writes[i].descriptorType);
+            writes[i].buffer = t_writes[i].pBufferInfo ? captureId(t_writes[i].pBufferInfo->buffer) : 0;
+            writes[i].bufferOffset = t_writes[i].pBufferInfo ? t_writes[i].pBufferInfo->offset : 0;
+            writes[i].bufferRange = t_writes[i].pBufferInfo ? t_writes[i].pBufferInfo->range : 0;
+            writes[i].imageView = t_writes[i].pImageInfo ? captureId(t_writes[i].pImageInfo->imageView) : 0;
+            writes[i].sampler = t_writes[i].pImageInfo ? captureId(t_writes[i].pImageInfo->sampler) : 0;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eWriteDescriptors);
+        record.put(std::span<const CaptureDescriptorWrite>(writes));
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::resetDescriptorPool(VkDescriptorPool t_pool) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eResetDescriptorPool);
+        record.put(captureId(t_pool));
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::createPipeline(Pipeline const& t_pipeline, GraphicsPipelineInfo const& t_info) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::vector<u64> layouts;
+        for (auto descriptor : t_info.descriptors.layouts)
+        {
+            layouts.emplace_back(captureId(descriptor->getLayout()));
+        }
+
+        std::vector<Format> colorFormats = t_info.colorFormats;
+        if (colorFormats.empty())
+        {
+            colorFormats.emplace_back(m_context->getDefaultColorFormat());
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateGraphicsPipeline);
+        record.put(captureId(t_pipeline.getHandle()));
+        record.put(std::span<const BindingDescription>(t_info.bindings.bindingDescriptions));
+        record.put(std::span<const AttributeDescription>(t_info.attributes.attributeDescriptions));
+        record.put(std::span<const PushConstantRange>(t_info.pushConstants.pushConstantRanges));
+        record.put(std::span<const u64>(layouts));
+        putShader(record, t_info.vertShaderPath);
+        putShader(record, t_info.fragShaderPath);
+        putShader(record, t_info.meshShaderPath);
+        putShader(record, t_info.taskShaderPath);
+        record.put(std::span<const Format>(colorFormats));
+        record.put(t_info.depthFormat);
+        record.put(t_info.stencilFormat);
+        record.put(t_info.polygonMode);
+        record.put(t_info.frontFace);
+        record.put(t_info.cullMode);
+        record.put(t_info.topology);
+        record.put(t_info.lineWidth);
+        record.put(t_info.depthStencil);
+        record.put(t_info.colorBlending);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::createPipeline(Pipeline const& t_pipeline, ComputePipelineInfo const& t_info) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::vector<u64> layouts;
+        for (auto descriptor : t_info.descriptors.layouts)
+        {
+            layouts.emplace_back(captureId(descriptor->getLayout()));
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateComputePipeline);
+        record.put(captureId(t_pipeline.getHandle()));
+        record.put(std::span<const PushConstantRange>(t_info.pushConstants.pushConstantRanges));
+        record.put(std::span<const u64>(layouts));
+        putShader(record, t_info.compShaderPath);
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    void Capture::destroyPipeline(VkPipeline t_pipeline) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eDestroyPipeline);
+        record.put(captureId(t_pipeline));
+        record.end();
+
+        std::scoped_lock lock(m_mutex);
+        write(record);
+    }
+
+    auto Capture::image(Image const& t_image) noexcept -> u64
+    {
+        u64 const id = captureId(t_image.getHandle());
+
+        if (!m_enabled)
+        {
+            return id;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        if (!m_images.insert(id).second)
+        {
+            return id;
+        }
+
+        auto const extent = m_context->getCurrentExtent();
+
+        CaptureWriter record;
+        record.begin(CaptureOp::eCreateImage);
+        record.put(id);
+        record.put(captureId(t_image.getView()));
+        record.put(extent.x);
+        record.put(extent.y);
+        record.put(t_image.getFormat());
+        record.put(static_cast<ImageUsage>(ImageUsageBits::eColorAttachment | ImageUsageBits::eSampled));
+        record.put(MemoryType::eGpuOnly);
+        record.end();
+
+        write(record);
+
+        return id;
+    }
+
+    auto Capture::rendering(RenderingInfo const& t_renderingInfo) noexcept -> CaptureRendering
+    {
+        CaptureRendering rendering{ };
+        rendering.size = t_renderingInfo.size;
+        rendering.offset = t_renderingInfo.offset;
+        rendering.secondaryCommandBuffers = t_renderingInfo.secondaryCommandBuffers;
+
+        if (auto color = t_renderingInfo.pColorAttachment; color && color->image)
+        {
+            rendering.colorImage = image(*color->image);
+            rendering.clearColor = color->clearColor;
+            rendering.colorLate = color->late;
+        }
+
+        if (auto depth = t_renderingInfo.pDepthAttachment; depth && depth->image)
+        {
+            rendering.depthImage = image(*depth->image);
+            rendering.stencil = depth->stencil;
+            rendering.depth = depth->depth;
+            rendering.depthLate = depth->late;
+        }
+
+        return rendering;
+    }
+
+    auto Capture::barriers(std::span<const ImageTransitionInfo> t_transitionInfos) noexcept -> std::vector<CaptureBarrier>
+    {
+        std::vector<CaptureBarrier> barriers(t_transitionInfos.size());
+
+        for (size_t i = barriers.size(); i--; )
+        {
+            barriers[i].image = image(*t_transitionInfos[i].image);
+            barriers[i].oldLayout = t_transitionInfos[i].oldLayout;
+            barriers[i].newLayout = t_transitionInfos[i].newLayout;
+            barriers[i].srcStageMask = t_transitionInfos[i].srcStageMask;
+            barriers[i].dstStageMask = t_transitionInfos[i].dstStageMask;
+            barriers[i].srcAccessMask = t_transitionInfos[i].srcAccessMask;
+            barriers[i].dstAccessMask = t_transitionInfos[i].dstAccessMask;
+            barriers[i].baseMipLevel = t_transitionInfos[i].baseMipLevel;
+            barriers[i].levelCount = t_transitionInfos[i].levelCount;
+            barriers[i].baseArrayLayer = t_transitionInfos[i].baseArrayLayer;
+            barriers[i].layerCount = t_transitionInfos[i].layerCount;
+        }
+
+        return barriers;
+    }
+
+    void Capture::write(CaptureWriter& t_record) noexcept
+    {
+        if (!t_record.empty() && m_file.is_open())
+        {
+            m_file.write(reinterpret_cast<char const*>(t_record.getData().data()), static_cast<std::streamsize>(t_record.getData().size()));
+        }
+
+        t_record.clear();
+    }
+
+    void Capture::finish() noexcept
+    {
+        u64 const frameCount = m_recording ? m_frame - m_firstFrame : 0;
+
+        m_file.close();
+        m_enabled = false;
+        m_recording = false;
+        m_streams.clear();
+        m_shadows.clear();
+        m_images.clear();
+
+        m_context->getInfoCallback()("Capture of " + std::to_string(frameCount) + " frames written to " + m_path);
+    }
+
+    void Capture::putShader(CaptureWriter& t_record, std::string_view t_path) noexcept
+    {
+        auto const code = readShader(t_path);
+        t_record.putBytes(code.data(), code.size());
+    }
+
+    CaptureReplay::~CaptureReplay() noexcept
+    {
+        m_context->waitIdle();
+
+        for (auto& [id, pipeline] : m_pipelines)     pipeline.destroy();
+        for (auto& [id, sampler] : m_samplers)       sampler.destroy();
+        for (auto& [id, pool] : m_descriptorPools)   pool.destroy();
+        for (auto& [id, buffer] : m_buffers)         buffer.free();
+        for (auto& [id, image] : m_images)           image.free();
+
+        if (!m_shaderDirectory.empty())
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_shaderDirectory, error);
+        }
+    }
+
+    auto CaptureReplay::readHeader(std::string const& t_path, CaptureHeader& t_header) noexcept -> bool
+    {
+        std::ifstream file(t_path, std::ios::binary);
+
+        if (!file.is_open() || !file.read(reinterpret_cast<char*>(&t_header), sizeof(t_header)))
+        {
+            return false;
+        }
+
+        return t_header.magic == CaptureHeader{ }.magic && t_header.version == CaptureHeader{ }.version;
+    }
+
+    auto CaptureReplay::load(std::string const& t_path) noexcept -> bool
+    {
+        if (!readHeader(t_path, m_header))
+        {
+            m_context->getErrorCallback()("Not a capture file: " + t_path);
+            return false;
+        }
+
+        std::ifstream file(t_path, std::ios::ate | std::ios::binary);
+        m_data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(m_data.data()), static_cast<std::streamsize>(m_data.size()));
+
+        CaptureReader reader(std::span<const u8>(m_data).subspan(sizeof(CaptureHeader)));
+        CaptureReader payload;
+        CaptureOp op;
+        size_t offset = reader.getOffset();
+
+        while (reader.next(op, payload))
+        {
+            if (op == CaptureOp::eBeginFrame)
+            {
+                if (!m_frames.empty())
+                {
+                    m_frames.back().end = sizeof(CaptureHeader) + offset;
+                }
+
+                payload.get<u64>();
+                m_frames.push_back(FrameRange{ sizeof(CaptureHeader) + offset, m_data.size(), payload.get<f64>() });
+            }
+
+            offset = reader.getOffset();
+        }
+
+        if (!m_frames.empty())
+        {
+            m_frames.back().end = sizeof(CaptureHeader) + offset;
+        }
+
+        m_shaderDirectory = (std::filesystem::temp_directory_path() /
+            ("arln_replay_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()))).string();
+
+        std::error_code error;
+        std::filesystem::create_directories(m_shaderDirectory, error);
+
+        execute(sizeof(CaptureHeader), m_frames.empty() ? sizeof(CaptureHeader) + offset : m_frames.front().begin, false);
+
+        m_context->getInfoCallback()("Loaded capture with " + std::to_string(m_frames.size()) + " frames from " + t_path);
+
+        return true;
+    }
+
+    auto CaptureReplay::playFrame(u32 t_frame) noexcept -> GpuFuture
+    {
+        if (t_frame >= m_frames.size())
+        {
+            return { };
+        }
+
+        execute(m_frames[t_frame].begin, m_frames[t_frame].end, true);
+        m_streams.clear();
+
+        return m_lastFuture;
+    }
+
+    void CaptureReplay::execute(size_t t_begin, size_t t_end, bool t_inRange) noexcept
+    {
+        CaptureReader reader(std::span<const u8>(m_data).subspan(t_begin, t_end - t_begin));
+        CaptureReader payload;
+        CaptureOp op;
+
+        while (reader.next(op, payload))
+        {
+            executeRecord(op, payload, t_inRange);
+        }
+    }
+
+    void CaptureReplay::executeRecord(CaptureOp t_op, CaptureReader& t_payload, bool t_inRange) noexcept
+    {
+        switch (t_op)
+        {
+        case CaptureOp::eCreateBuffer:
+        {
+            u64 const id = t_payload.get<u64>();
+            auto const usage = t_payload.get<BufferUsage>();
+            auto const memoryType = t_payload.get<MemoryType>();
+            auto const size = t_payload.get<u64>();
+            auto const opaqueAddress = t_payload.get<u64>();
+            auto const opaqueMemoryAddress = t_payload.get<u64>();
+
+            forgetBuffer(id);
+            m_buffers[id].recreate(*m_context, usage, memoryType, size, opaqueAddress, opaqueMemoryAddress);
+            break;
+        }
+        case CaptureOp::eFreeBuffer:
+            if (!t_inRange) forgetBuffer(t_payload.get<u64>());
+            break;
+        case CaptureOp::eWriteBuffer:
+        {
+            u64 const id = t_payload.get<u64>();
+            auto const offset = t_payload.get<u64>();
+            auto const bytes = t_payload.getBytes();
+
+            if (auto buffer = findBuffer(id))
+            {
+                buffer->writeData(bytes.data(), bytes.size(), offset);
+            }
+            break;
+        }
+        case CaptureOp::eCreateImage:
+        {
+            u64 const id = t_payload.get<u64>();
+            u64 const view = t_payload.get<u64>();
+            auto const width = t_payload.get<u32>();
+            auto const height = t_payload.get<u32>();
+            auto const format = t_payload.get<Format>();
+            auto const usage = t_payload.get<ImageUsage>();
+            auto const memoryType = t_payload.get<MemoryType>();
+
+            forgetImage(id);
+            m_images[id] = m_context->allocateImage(width, height, format, usage, memoryType);
+            m_imageViews[view] = id;
+            break;
+        }
+        case CaptureOp::eFreeImage:
+            if (!t_inRange) forgetImage(t_payload.get<u64>());
+            break;
+        case CaptureOp::eWriteImage:
+        {
+            u64 const id = t_payload.get<u64>();
+            auto const extent = t_payload.get<uvec2>();
+            auto const bytes = t_payload.getBytes();
+
+            if (auto image = findImage(id))
+            {
+                image->writeToImage(bytes.data(), bytes.size(), extent);
+            }
+            break;
+        }
+        case CaptureOp::eTransitionImage:
+        {
+            u64 const id = t_payload.get<u64>();
+            auto const oldLayout = t_payload.get<ImageLayout>();
+            auto const newLayout = t_payload.get<ImageLayout>();
+            auto const srcStage = t_payload.get<PipelineStage>();
+            auto const dstStage = t_payload.get<PipelineStage>();
+            auto const srcAccess = t_payload.get<Access>();
+            auto const dstAccess = t_payload.get<Access>();
+
+            if (auto image = findImage(id))
+            {
+                image->transition(oldLayout, newLayout, srcStage, dstStage, srcAccess, dstAccess);
+            }
+            break;
+        }
+        case CaptureOp::eCreateSampler:
+        {
+            u64 const id = t_payload.get<u64>();
+            auto const options = t_payload.get<SamplerOptions>();
+
+            if (auto it = m_samplers.find(id); it != m_samplers.end())
+            {
+                it->second.destroy();
+            }
+            m_samplers[id] = m_context->createSampler(options);
+            break;
+        }
+        case CaptureOp::eFreeSampler:
+            if (auto it = m_samplers.find(t_payload.get<u64>()); !t_inRange && it != m_samplers.end())
+            {
+                it->second.destroy();
+                m_samplers.erase(it);
+            }
+            break;
+        case CaptureOp::eCreateDescriptor:
+        {
+            u64 const poolId = t_payload.get<u64>();
+            u64 const set = t_payload.get<u64>();
+            u64 const layout = t_payload.get<u64>();
+            auto const setLayout = t_payload.get<u32>();
+            auto const bindings = t_payload.getArray<VkDescriptorSetLayoutBinding>();
+
+            auto pool = m_descriptorPools.find(poolId);
+            if (pool == m_descriptorPools.end())
+            {
+                pool = m_descriptorPools.emplace(poolId, m_context->createDescriptorPool()).first;
+            }
+
+            for (auto& binding : bindings)
+            {
+                pool->second.addBinding(binding.binding, static_cast<DescriptorType>(binding.descriptorType), binding.stageFlags, binding.descriptorCount);
+            }
+
+            auto descriptor = pool->second.createDescriptor(setLayout);
+            m_descriptors[set] = descriptor;
+            m_layouts.try_emplace(layout, descriptor);
+            break;
+        }
+        case CaptureOp::eWriteDescriptors:
+        {
+            DescriptorWriter writer;
+
+            for (auto& write : t_payload.getArray<CaptureDescriptorWrite>())
+            {
+                auto descriptor = findDescriptor(write.set);
+
+                if (!descriptor)
+                {
+                    continue;
+                }
+
+                if (write.buffer)
+                {
+                    if (auto buffer = findBuffer(write.buffer))
+                    {
+                        BufferSlice const slice{ .buffer = buffer, .size = write.bufferRange, .offset = write.bufferOffset };
+                        writer.addBuffer(*descriptor, slice, write.binding, write.type, write.element);
+                    }
+                    continue;
+                }
+
+                Image* image = nullptr;
+                Sampler* sampler = nullptr;
+
+                if (auto view = m_imageViews.find(write.imageView); view != m_imageViews.end())
+                {
+                    image = findImage(view->second);
+                }
+
+                if (auto it = m_samplers.find(write.sampler); it != m_samplers.end())
+                {
+                    sampler = &it->second;
+                }
+
+                writer.addImage(*descriptor, image, sampler, write.binding, write.type, write.element);
+            }
+
+            writer.write();
+            break;
+        }
+        case CaptureOp::eResetDescriptorPool:
+            if (auto pool = m_descriptorPools.find(t_payload.get<u64>()); pool != m_descriptorPools.end())
+            {
+                pool->second.reset();
+            }
+            break;
+        case CaptureOp::eCreateGraphicsPipeline:
+            createGraphicsPipeline(t_payload.get<u64>(), t_payload);
+            break;
+        case CaptureOp::eCreateComputePipeline:
+            createComputePipeline(t_payload.get<u64>(), t_payload);
+            break;
+        case CaptureOp::eDestroyPipeline:
+            if (auto it = m_pipelines.find(t_payload.get<u64>()); !t_inRange && it != m_pipelines.end())
+            {
+                it->second.destroy();
+                m_pipelines.erase(it);
+            }
+            break;
+        case CaptureOp::eBeginFrame:
+            m_context->beginFrame();
+            break;
+        case CaptureOp::eCommandStream:
+        {
+            u64 const id = t_payload.get<u64>();
+            m_streams[id] = t_payload.getBytes();
+            break;
+        }
+        case CaptureOp::eEndFrame:
+        {
+            auto const graphicsIds = t_payload.getArray<u64>();
+            auto const computeIds = t_payload.getArray<u64>();
+            auto const computeWaitStage = t_payload.get<PipelineStage>();
+
+            std::vector<CommandBufferHandle> graphics;
+            std::vector<CommandBufferHandle> compute;
+
+            for (auto [ids, handles, computeQueue] : { std::tuple{ &graphicsIds, &graphics, false }, std::tuple{ &computeIds, &compute, true } })
+            {
+                for (u64 id : *ids)
+                {
+                    auto commandBuffer = m_commandBuffers.find(id);
+                    if (commandBuffer == m_commandBuffers.end())
+                    {
+                        commandBuffer = m_commandBuffers.emplace(id, computeQueue ? m_context->allocateComputeCommandBuffer() : m_context->allocateCommandBuffer()).first;
+                    }
+
+                    playCommands(commandBuffer->second, id);
+                    handles->emplace_back(commandBuffer->second);
+                }
+            }
+
+            m_lastFuture = m_context->endFrame(graphics, compute, computeWaitStage);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void CaptureReplay::playCommands(CommandBuffer& t_commandBuffer, u64 t_stream) noexcept
+    {
+        auto stream = m_streams.find(t_stream);
+
+        if (stream == m_streams.end())
+        {
+            ++m_missingReferences;
+            return;
+        }
+
+        CaptureReader reader(stream->second);
+        CaptureReader payload;
+        CaptureOp op;
+
+        while (reader.next(op, payload))
+        {
+            switch (op)
+            {
+            case CaptureOp::eBegin:
+                t_commandBuffer.begin();
+                break;
+            case CaptureOp::eBeginSecondary:
+            case CaptureOp::eBeginRendering:
+            {
+                ColorAttachmentInfo color;
+                DepthAttachmentInfo depth;
+                auto const renderingInfo = toRenderingInfo(payload.get<CaptureRendering>(), color, depth);
+
+                if (!color.image)
+                {
+                    break;
+                }
+
+                if (op == CaptureOp::eBeginSecondary)
+                {
+                    t_commandBuffer.beginSecondary(renderingInfo);
+                }
+                else
+                {
+                    t_commandBuffer.beginRendering(renderingInfo);
+                }
+                break;
+            }
+            case CaptureOp::eEnd:
+                t_commandBuffer.end();
+                break;
+            case CaptureOp::eEndRendering:
+                t_commandBuffer.endRendering();
+                break;
+            case CaptureOp::eExecuteCommands:
+            {
+                std::vector<CommandBuffer> secondaryCommandBuffers;
+
+                for (u64 id : payload.getArray<u64>())
+                {
+                    auto& secondary = secondaryCommandBuffers.emplace_back(m_context->allocateSecondaryCommandBuffer());
+                    playCommands(secondary, id);
+                }
+
+                t_commandBuffer.executeCommands(secondaryCommandBuffers);
+                break;
+            }
+            case CaptureOp::eBindGraphicsPipeline:
+                if (auto pipeline = findPipeline(payload.get<u64>())) t_commandBuffer.bindGraphicsPipeline(*pipeline);
+                break;
+            case CaptureOp::eBindComputePipeline:
+                if (auto pipeline = findPipeline(payload.get<u64>())) t_commandBuffer.bindComputePipeline(*pipeline);
+                break;
+            case CaptureOp::eDispatch:
+            {
+                auto const x = payload.get<u32>();
+                auto const y = payload.get<u32>();
+                auto const z = payload.get<u32>();
+                t_commandBuffer.dispatch(x, y, z);
+                break;
+            }
+            case CaptureOp::eDraw:
+            {
+                auto const vertexCount = payload.get<u32>();
+                auto const instanceCount = payload.get<u32>();
+                auto const firstVertex = payload.get<i32>();
+                auto const firstInstance = payload.get<u32>();
+                t_commandBuffer.draw(vertexCount, instanceCount, firstVertex, firstInstance);
+                break;
+            }
+            case CaptureOp::eDrawIndexed:
+            {
+                auto const indexCount = payload.get<u32>();
+                auto const instanceCount = payload.get<u32>();
+                auto const firstIndex = payload.get<u32>();
+                auto const vertexOffset = payload.get<i32>();
+                auto const firstInstance = payload.get<u32>();
+                t_commandBuffer.drawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+                break;
+            }
+            case CaptureOp::eDrawIndirect:
+            case CaptureOp::eDrawIndexedIndirect:
+            case CaptureOp::eDrawMeshTaskIndirect:
+            {
+                auto const buffer = findBuffer(payload.get<u64>());
+                auto const offset = payload.get<size_t>();
+                auto const drawCount = payload.get<u32>();
+                auto const stride = payload.get<u32>();
+
+                if (!buffer)
+                {
+                    break;
+                }
+
+                if (op == CaptureOp::eDrawIndirect)              t_commandBuffer.drawIndirect(*buffer, offset, drawCount, stride);
+                else if (op == CaptureOp::eDrawIndexedIndirect)  t_commandBuffer.drawIndexedIndirect(*buffer, offset, drawCount, stride);
+                else                                             t_commandBuffer.drawMeshTaskIndirect(*buffer, offset, drawCount, stride);
+                break;
+            }
+            case CaptureOp::eDrawIndirectCount:
+            case CaptureOp::eDrawIndexedIndirectCount:
+            case CaptureOp::eDrawMeshTaskIndirectCount:
+            {
+                auto const buffer = findBuffer(payload.get<u64>());
+                auto const offset = payload.get<size_t>();
+                auto const countBuffer = findBuffer(payload.get<u64>());
+                auto const countBufferOffset = payload.get<size_t>();
+                auto const maxDrawCount = payload.get<u32>();
+                auto const stride = payload.get<u32>();
+
+                if (!buffer || !countBuffer)
+                {
+                    break;
+                }
+
+                if (op == CaptureOp::eDrawIndirectCount)             t_commandBuffer.drawIndirectCount(*buffer, offset, *countBuffer, countBufferOffset, maxDrawCount, stride);
+                else if (op == CaptureOp::eDrawIndexedIndirectCount) t_commandBuffer.drawIndexedIndirectCount(*buffer, offset, *countBuffer, countBufferOffset, maxDrawCount, stride);
+                else                                                 t_commandBuffer.drawMeshTaskIndirectCount(*buffer, offset, *countBuffer, countBufferOffset, maxDrawCount, stride);
+                break;
+            }
+            case CaptureOp::eDrawMeshTask:
+            {
+                auto const x = payload.get<u32>();
+                auto const y = payload.get<u32>();
+                auto const z = payload.get<u32>();
+                t_commandBuffer.drawMeshTask(x, y, z);
+                break;
+            }
+            case CaptureOp::eSetViewport:
+            {
+                auto const x = payload.get<f32>();
+                auto const y = payload.get<f32>();
+                auto const width = payload.get<f32>();
+                auto const height = payload.get<f32>();
+                t_commandBuffer.setViewport(x, y, width, height);
+                break;
+            }
+            case CaptureOp::eSetScissor:
+            {
+                auto const x = payload.get<i32>();
+                auto const y = payload.get<i32>();
+                auto const width = payload.get<u32>();
+                auto const height = payload.get<u32>();
+                t_commandBuffer.setScissor(x, y, width, height);
+                break;
+            }
+            case CaptureOp::eBindVertexBuffer:
+            {
+                auto const buffer = findBuffer(payload.get<u64>());
+                auto const offset = payload.get<size_t>();
+                auto const firstBinding = payload.get<u32>();
+
+                if (buffer) t_commandBuffer.bindVertexBuffer(*buffer, offset, firstBinding);
+                break;
+            }
+            case CaptureOp::eBindIndexBuffer16:
+            case CaptureOp::eBindIndexBuffer32:
+            {
+                auto const buffer = findBuffer(payload.get<u64>());
+                auto const offset = payload.get<size_t>();
+
+                if (buffer && op == CaptureOp::eBindIndexBuffer16) t_commandBuffer.bindIndexBuffer16(*buffer, offset);
+                if (buffer && op == CaptureOp::eBindIndexBuffer32) t_commandBuffer.bindIndexBuffer32(*buffer, offset);
+                break;
+            }
+            case CaptureOp::ePushConstant:
+            {
+                auto const pipeline = findPipeline(payload.get<u64>());
+                auto const stage = payload.get<ShaderStage>();
+                auto const bytes = payload.getArray<u8>();
+
+                if (pipeline)
+                {
+                    t_commandBuffer.pushConstant(*pipeline, stage, static_cast<u32>(bytes.size()), bytes.data());
+                }
+                break;
+            }
+            case CaptureOp::eBindDescriptorsGraphics:
+            case CaptureOp::eBindDescriptorsCompute:
+            {
+                auto const pipeline = findPipeline(payload.get<u64>());
+                auto const firstSet = payload.get<u32>();
+                std::vector<std::reference_wrapper<Descriptor>> descriptors;
+
+                for (u64 id : payload.getArray<u64>())
+                {
+                    if (auto descriptor = findDescriptor(id))
+                    {
+                        descriptors.emplace_back(*descriptor);
+                    }
+                }
+
+                auto const dynamicOffsets = payload.getArray<u32>();
+
+                if (!pipeline || descriptors.empty())
+                {
+                    break;
+                }
+
+                if (op == CaptureOp::eBindDescriptorsGraphics) t_commandBuffer.bindDescriptorGraphics(*pipeline, descriptors, firstSet, dynamicOffsets);
+                else                                           t_commandBuffer.bindDescriptorCompute(*pipeline, descriptors, firstSet, dynamicOffsets);
+                break;
+            }
+            case CaptureOp::eBarriers:
+            {
+                auto const barriers = payload.getArray<CaptureBarrier>();
+                auto const memoryBarriers = payload.getArray<MemoryBarrierInfo>();
+                std::vector<ImageTransitionInfo> transitionInfos;
+
+                for (auto& barrier : barriers)
+                {
+                    if (auto image = findImage(barrier.image))
+                    {
+                        transitionInfos.push_back(ImageTransitionInfo{
+                            .image = image,
+                            .oldLayout = barrier.oldLayout,
+                            .newLayout = barrier.newLayout,
+                            .srcStageMask = barrier.srcStageMask,
+                            .dstStageMask = barrier.dstStageMask,
+                            .srcAccessMask = barrier.srcAccessMask,
+                            .dstAccessMask = barrier.dstAccessMask,
+                            .baseMipLevel = barrier.baseMipLevel,
+                            .levelCount = barrier.levelCount,
+                            .baseArrayLayer = barrier.baseArrayLayer,
+                            .layerCount = barrier.layerCount
+                        });
+                    }
+                }
+
+                t_commandBuffer.recordBarriers(transitionInfos, memoryBarriers);
+                break;
+            }
+            case CaptureOp::eBeginZone:
+            {
+                bool const statistics = payload.get<bool>();
+                t_commandBuffer.beginZone(payload.getString(), statistics);
+                break;
+            }
+            case CaptureOp::eEndZone:
+                t_commandBuffer.endZone();
+                break;
+            case CaptureOp::eBlitImage:
+            {
+                auto const src = findImage(payload.get<u64>());
+                auto const dst = findImage(payload.get<u64>());
+                auto const blit = payload.get<ImageBlit>();
+
+                if (src && dst) t_commandBuffer.blitImage(*src, *dst, blit);
+                break;
+            }
+            case CaptureOp::eCopyImage:
+            {
+                auto const src = findImage(payload.get<u64>());
+                auto const dst = findImage(payload.get<u64>());
+                auto const copyInfo = payload.get<ImageCopy>();
+
+                if (src && dst) t_commandBuffer.copyImage(*src, *dst, copyInfo);
+                break;
+            }
+            case CaptureOp::eCopyBuffer:
+            {
+                auto const src = findBuffer(payload.get<u64>());
+                auto const dst = findBuffer(payload.get<u64>());
+                auto const size = payload.get<size_t>();
+                auto const dstOffset = payload.get<size_t>();
+                auto const srcOffset = payload.get<size_t>();
+
+                if (src && dst) t_commandBuffer.copyBuffer(*src, *dst, size, dstOffset, srcOffset);
+                break;
+            }
+            case CaptureOp::eCopyBufferToImage:
+            {
+                auto const src = findBuffer(payload.get<u64>());
+                auto const dst = findImage(payload.get<u64>());
+                auto const copyInfo = payload.get<BufferImageCopy>();
+
+                if (src && dst) t_commandBuffer.copyBufferToImage(*src, *dst, copyInfo);
+                break;
+            }
+            case CaptureOp::eCopyImageToBuffer:
+            {
+                auto const src = findImage(payload.get<u64>());
+                auto const dst = findBuffer(payload.get<u64>());
+                auto const copyInfo = payload.get<BufferImageCopy>();
+
+                if (src && dst) t_commandBuffer.copyImageToBuffer(*src, *dst, copyInfo);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    void CaptureReplay::createGraphicsPipeline(u64 t_id, CaptureReader& t_payload) noexcept
+    {
+        GraphicsPipelineInfo info;
+        info.bindings.bindingDescriptions = t_payload.getArray<BindingDescription>();
+        info.attributes.attributeDescriptions = t_payload.getArray<AttributeDescription>();
+        info.pushConstants.pushConstantRanges = t_payload.getArray<PushConstantRange>();
+
+        for (u64 layout : t_payload.getArray<u64>())
+        {
+            if (auto descriptor = m_layouts.find(layout); descriptor != m_layouts.end())
+            {
+                info.descriptors.layouts.emplace_back(&descriptor->second);
+            }
+            else
+            {
+                ++m_missingReferences;
+            }
+        }
+
+        auto const vertShaderPath = writeShader(t_id, "vert", t_payload.getBytes());
+        auto const fragShaderPath = writeShader(t_id, "frag", t_payload.getBytes());
+        auto const meshShaderPath = writeShader(t_id, "mesh", t_payload.getBytes());
+        auto const taskShaderPath = writeShader(t_id, "task", t_payload.getBytes());
+
+        info.vertShaderPath = vertShaderPath;
+        info.fragShaderPath = fragShaderPath;
+        info.meshShaderPath = meshShaderPath;
+        info.taskShaderPath = taskShaderPath;
+        info.colorFormats = t_payload.getArray<Format>();
+        info.depthFormat = t_payload.get<Format>();
+        info.stencilFormat = t_payload.get<Format>();
+        info.polygonMode = t_payload.get<PolygonMode>();
+        info.frontFace = t_payload.get<FrontFace>();
+        info.cullMode = t_payload.get<CullMode>();
+        info.topology = t_payload.get<Topology>();
+        info.lineWidth = t_payload.get<f32>();
+        info.depthStencil = t_payload.get<bool>();
+        info.colorBlending = t_payload.get<bool>();
+
+        if (auto it = m_pipelines.find(t_id); it != m_pipelines.end())
+        {
+            it->second.destroy();
+        }
+        m_pipelines[t_id] = m_context->createGraphicsPipeline(info);
+    }
+
+    void CaptureReplay::createComputePipeline(u64 t_id, CaptureReader& t_payload) noexcept
+    {
+        ComputePipelineInfo info;
+        info.pushConstants.pushConstantRanges = t_payload.getArray<PushConstantRange>();
+
+        for (u64 layout : t_payload.getArray<u64>())
+        {
+            if (auto descriptor = m_layouts.find(layout); descriptor != m_layouts.end())
+            {
+                info.descriptors.layouts.emplace_back(&descriptor->second);
+            }
+            else
+            {
+                ++m_missingReferences;
+            }
+        }
+
+        auto const compShaderPath = writeShader(t_id, "comp", t_payload.getBytes());
+        info.compShaderPath = compShaderPath;
+
+        if (auto it = m_pipelines.find(t_id); it != m_pipelines.end())
+        {
+            it->second.destroy();
+        }
+        m_pipelines[t_id] = m_context->createComputePipeline(info);
+    }
+
+    auto CaptureReplay::writeShader(u64 t_id, std::string_view t_stage, std::span<const u8> t_code) noexcept -> std::string
+    {
+        if (t_code.empty())
+        {
+            return {};
+        }
+
+        std::string path = m_shaderDirectory + "/" + std::to_string(t_id) + "." + std::string(t_stage) + ".spv";
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const*>(t_code.data()), static_cast<std::streamsize>(t_code.size()));
+
+        return path;
+    }
+
+    void CaptureReplay::forgetBuffer(u64 t_id) noexcept
+    {
+        auto entry = m_buffers.find(t_id);
+
+        if (entry == m_buffers.end())
+        {
+            return;
+        }
+
+        bool const captureAddress = entry->second.getOpaqueAddress();
+
+        entry->second.free();
+        m_buffers.erase(entry);
+
+        // Captured addresses are reused by later buffers
+        if (captureAddress)
+        {
+            m_context->waitIdle();
+            m_context->getDeletionQueue().collect(true);
+        }
+    }
+
+    void CaptureReplay::forgetImage(u64 t_id) noexcept
+    {
+        auto image = m_images.find(t_id);
+
+        if (image == m_images.end())
+        {
+            return;
+        }
+
+        std::erase_if(m_imageViews, [&](auto const& t_view) { return t_view.second == t_id; });
+
+        image->second.free();
+        m_images.erase(image);
+    }
+
+    auto CaptureReplay::findBuffer(u64 t_id) noexcept -> Buffer*
+    {
+        if (auto entry = m_buffers.find(t_id); entry != m_buffers.end())
+        {
+            return &entry->second;
+        }
+
+        ++m_missingReferences;
+        return nullptr;
+    }
+
+    auto CaptureReplay::findImage(u64 t_id) noexcept -> Image*
+    {
+        if (auto image = m_images.find(t_id); image != m_images.end())
+        {
+            return &image->second;
+        }
+
+        ++m_missingReferences;
+        return nullptr;
+    }
+
+    auto CaptureReplay::findPipeline(u64 t_id) noexcept -> Pipeline*
+    {
+        if (auto pipeline = m_pipelines.find(t_id); pipeline != m_pipelines.end())
+        {
+            return &pipeline->second;
+        }
+
+        ++m_missingReferences;
+        return nullptr;
+    }
+
+    auto CaptureReplay::findDescriptor(u64 t_id) noexcept -> Descriptor*
+    {
+        if (auto descriptor = m_descriptors.find(t_id); descriptor != m_descriptors.end())
+        {
+            return &descriptor->second;
+        }
+
+        ++m_missingReferences;
+        return nullptr;
+    }
+
+    auto CaptureReplay::toRenderingInfo(CaptureRendering const& t_rendering, ColorAttachmentInfo& t_color, DepthAttachmentInfo& t_depth) noexcept -> RenderingInfo
+    {
+        RenderingInfo renderingInfo;
+        renderingInfo.size = t_rendering.size;
+        renderingInfo.offset = t_rendering.offset;
+        renderingInfo.secondaryCommandBuffers = t_rendering.secondaryCommandBuffers;
+
+        t_color.image = findImage(t_rendering.colorImage);
+        t_color.clearColor = t_rendering.clearColor;
+        t_color.late = t_rendering.colorLate;
+        renderingInfo.pColorAttachment = &t_color;
+
+        if (t_rendering.depthImage)
+        {
+            t_depth.image = findImage(t_rendering.depthImage);
+            t_depth.stencil = t_rendering.stencil;
+            t_depth.depth = t_rendering.depth;
+            t_depth.late = t_rendering.depthLate;
+            renderingInfo.pDepthAttachment = t_depth.image ? &t_depth : nullptr;
+        }
+
+        return renderingInfo;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,346 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include "ArlnCommandBuffer.hpp"
+#include "ArlnDescriptor.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace arln {
+
+    // Part of the file format, append only
+    enum class CaptureOp : u32
+    {
+        eCreateBuffer = 0,
+        eFreeBuffer = 1,
+        eWriteBuffer = 2,
+        eCreateImage = 3,
+        eFreeImage = 4,
+        eWriteImage = 5,
+        eTransitionImage = 6,
+        eCreateSampler = 7,
+        eFreeSampler = 8,
+        eCreateDescriptor = 9,
+        eWriteDescriptors = 10,
+        eResetDescriptorPool = 11,
+        eCreateGraphicsPipeline = 12,
+        eCreateComputePipeline = 13,
+        eDestroyPipeline = 14,
+        eBeginFrame = 15,
+        eCommandStream = 16,
+        eEndFrame = 17,
+        eBegin = 18,
+        eBeginSecondary = 19,
+        eEnd = 20,
+        eBeginRendering = 21,
+        eEndRendering = 22,
+        eExecuteCommands = 23,
+        eBindGraphicsPipeline = 24,
+        eBindComputePipeline = 25,
+        eDispatch = 26,
+        eDraw = 27,
+        eDrawIndexed = 28,
+        eDrawIndirect = 29,
+        eDrawIndirectCount = 30,
+        eDrawIndexedIndirect = 31,
+        eDrawIndexedIndirectCount = 32,
+        eDrawMeshTask = 33,
+        eDrawMeshTaskIndirect = 34,
+        eDrawMeshTaskIndirectCount = 35,
+        eSetViewport = 36,
+        eSetScissor = 37,
+        eBindVertexBuffer = 38,
+        eBindIndexBuffer16 = 39,
+        eBindIndexBuffer32 = 40,
+        ePushConstant = 41,
+        eBindDescriptorsGraphics = 42,
+        eBindDescriptorsCompute = 43,
+        eBarriers = 44,
+        eBeginZone = 45,
+        eEndZone = 46,
+        eBlitImage = 47,
+        eCopyImage = 48,
+        eCopyBuffer = 49,
+        eCopyBufferToImage = 50,
+        eCopyImageToBuffer = 51
+    };
+
+    struct CaptureHeader
+    {
+        std::array<char, 8> magic{ 'A', 'R', 'L', 'N', 'C', 'A', 'P', 0 };
+        u32                 version{ 4 };
+        uvec2               extent{ };
+        Format              colorFormat{ };
+        Format              depthFormat{ };
+    };
+
+    template<typename T>
+    inline auto captureId(T t_handle) noexcept -> u64 { return (u64)t_handle; }
+
+    class CaptureWriter
+    {
+    public:
+        void begin(CaptureOp t_op) noexcept;
+        void end() noexcept;
+        void putBytes(void const* t_data, size_t t_size) noexcept;
+        void putString(std::string_view t_string) noexcept;
+
+        template<typename T>
+        void put(T const& t_value) noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            size_t const offset = m_data.size();
+            m_data.resize(offset + sizeof(T));
+            std::memcpy(m_data.data() + offset, &t_value, sizeof(T));
+        }
+
+        template<typename T>
+        void put(std::span<const T> t_values) noexcept
+        {
+            put(static_cast<u32>(t_values.size()));
+            putBytes(t_values.data(), t_values.size_bytes());
+        }
+
+        void put(std::string_view t_string) noexcept { putString(t_string); }
+
+        inline auto& getData()       noexcept { return m_data;         }
+        inline auto  empty()   const noexcept { return m_data.empty(); }
+        inline void  clear()         noexcept { m_data.clear();        }
+
+    private:
+        std::vector<u8> m_data       { };
+        size_t          m_recordStart{ };
+    };
+
+    class CaptureReader
+    {
+    public:
+        CaptureReader() = default;
+        explicit CaptureReader(std::span<const u8> t_data) noexcept : m_data{ t_data } { }
+
+        auto next(CaptureOp& t_op, CaptureReader& t_payload) noexcept -> bool;
+        auto getBytes() noexcept -> std::span<const u8>;
+        auto getString() noexcept -> std::string_view;
+
+        template<typename T>
+        auto get() noexcept -> T
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value{ };
+
+            if (m_offset + sizeof(T) <= m_data.size())
+            {
+                std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+            }
+
+            m_offset += sizeof(T);
+            return value;
+        }
+
+        template<typename T>
+        auto getArray() noexcept -> std::vector<T>
+        {
+            u32 const count = get<u32>();
+            auto const bytes = getBytes();
+            std::vector<T> values(std::min<size_t>(count, bytes.size() / sizeof(T)));
+
+            if (!values.empty())
+            {
+                std::memcpy(values.data(), bytes.data(), values.size() * sizeof(T));
+            }
+
+            return values;
+        }
+
+        inline auto getOffset() const noexcept { return m_offset;                   }
+        inline auto isValid()   const noexcept { return m_offset <= m_data.size(); }
+
+    private:
+        std::span<const u8> m_data  { };
+        size_t              m_offset{ };
+    };
+
+    struct CaptureBarrier
+    {
+        u64           image;
+        ImageLayout   oldLayout;
+        ImageLayout   newLayout;
+        PipelineStage srcStageMask;
+        PipelineStage dstStageMask;
+        Access        srcAccessMask;
+        Access        dstAccessMask;
+        u32           baseMipLevel;
+        u32           levelCount;
+        u32           baseArrayLayer;
+        u32           layerCount;
+    };
+
+    struct CaptureRendering
+    {
+        u64                colorImage;
+        std::array<f32, 4> clearColor;
+        u64                depthImage;
+        u32                stencil;
+        f32                depth;
+        ivec2              size;
+        ivec2              offset;
+        bool               colorLate;
+        bool               depthLate;
+        bool               secondaryCommandBuffers;
+    };
+
+    struct CaptureDescriptorWrite
+    {
+        u64            set;
+        u32            binding;
+        u32            element;
+        DescriptorType type;
+        u64            buffer;
+        u64            bufferOffset;
+        u64            bufferRange;
+        u64            imageView;
+        u64            sampler;
+    };
+
+    class Capture
+    {
+    public:
+        Capture() = default;
+        Capture(Capture const&) = delete;
+        Capture(Capture&&) = delete;
+        Capture& operator=(Capture const&) = delete;
+        Capture& operator=(Capture&&) = delete;
+        ~Capture() = default;
+
+        void create(Context& t_context, std::string const& t_path, u64 t_firstFrame, u64 t_frameCount) noexcept;
+        void teardown() noexcept;
+
+        void beginFrame() noexcept;
+        void endFrame(std::span<const CommandBufferHandle> t_commandBuffers, std::span<const CommandBufferHandle> t_computeCommandBuffers, PipelineStage t_computeWaitStage) noexcept;
+
+        void createBuffer(Buffer const& t_buffer, BufferUsage t_usage, MemoryType t_memoryType) noexcept;
+        void freeBuffer(VkBuffer t_buffer) noexcept;
+        void writeBuffer(Buffer const& t_buffer, void const* t_data, size_t t_size, size_t t_offset) noexcept;
+        void createImage(Image const& t_image, u32 t_width, u32 t_height, ImageUsage t_usage, MemoryType t_memoryType) noexcept;
+        void freeImage(VkImage t_image) noexcept;
+        void writeImage(Image const& t_image, void const* t_data, size_t t_size, uvec2 t_extent) noexcept;
+        void transitionImage(Image const& t_image, ImageLayout t_old, ImageLayout t_new, PipelineStage t_srcStage, PipelineStage t_dstStage, Access t_srcAccess, Access t_dstAccess) noexcept;
+        void createSampler(Sampler const& t_sampler, SamplerOptions const& t_options) noexcept;
+        void freeSampler(VkSampler t_sampler) noexcept;
+        void createDescriptor(VkDescriptorPool t_pool, VkDescriptorSet t_set, VkDescriptorSetLayout t_layout, u32 t_setLayout, std::span<const VkDescriptorSetLayoutBinding> t_bindings) noexcept;
+        void writeDescriptors(std::span<const VkWriteDescriptorSet> t_writes) noexcept;
+        void resetDescriptorPool(VkDescriptorPool t_pool) noexcept;
+        void createPipeline(Pipeline const& t_pipeline, GraphicsPipelineInfo const& t_info) noexcept;
+        void createPipeline(Pipeline const& t_pipeline, ComputePipelineInfo const& t_info) noexcept;
+        void destroyPipeline(VkPipeline t_pipeline) noexcept;
+
+        auto image(Image const& t_image) noexcept -> u64;
+        auto rendering(RenderingInfo const& t_renderingInfo) noexcept -> CaptureRendering;
+        auto barriers(std::span<const ImageTransitionInfo> t_transitionInfos) noexcept -> std::vector<CaptureBarrier>;
+
+        template<typename... Args>
+        void command(VkCommandBuffer t_commandBuffer, CaptureOp t_op, Args const&... t_args) noexcept
+        {
+            std::scoped_lock lock(m_mutex);
+
+            auto& stream = m_streams[captureId(t_commandBuffer)];
+            stream.begin(t_op);
+            (stream.put(t_args), ...);
+            stream.end();
+        }
+
+        inline auto isEnabled()   const noexcept { return m_enabled;   }
+        inline auto isRecording() const noexcept { return m_recording; }
+
+    private:
+        struct Shadow
+        {
+            std::vector<u8> data;
+            size_t          begin;
+            size_t          end;
+        };
+
+        void write(CaptureWriter& t_record) noexcept;
+        void finish() noexcept;
+        void putShader(CaptureWriter& t_record, std::string_view t_path) noexcept;
+
+        Context*                               m_context   { };
+        std::ofstream                          m_file      { };
+        std::string                            m_path      { };
+        std::mutex                             m_mutex     { };
+        std::unordered_map<u64, CaptureWriter> m_streams   { };
+        std::unordered_map<u64, Shadow>        m_shadows   { };
+        std::unordered_set<u64>                m_images    { };
+        std::chrono::steady_clock::time_point  m_epoch     { };
+        u64                                    m_frame     { };
+        u64                                    m_firstFrame{ };
+        u64                                    m_lastFrame { };
+        bool                                   m_enabled   { };
+        bool                                   m_recording { };
+    };
+
+    class CaptureReplay
+    {
+    public:
+        explicit CaptureReplay(Context& t_context) noexcept : m_context{ &t_context } { }
+        CaptureReplay(CaptureReplay const&) = delete;
+        CaptureReplay(CaptureReplay&&) = delete;
+        CaptureReplay& operator=(CaptureReplay const&) = delete;
+        CaptureReplay& operator=(CaptureReplay&&) = delete;
+        ~CaptureReplay() noexcept;
+
+        static auto readHeader(std::string const& t_path, CaptureHeader& t_header) noexcept -> bool;
+
+        auto load(std::string const& t_path) noexcept -> bool;
+
+        auto playFrame(u32 t_frame) noexcept -> GpuFuture;
+
+        inline auto  getFrameCount()                 const noexcept { return static_cast<u32>(m_frames.size()); }
+        inline auto  getFrameTimestamp(u32 t_frame)  const noexcept { return m_frames[t_frame].timestamp;     }
+        inline auto& getHeader()                     const noexcept { return m_header;                         }
+        inline auto  getMissingReferences()          const noexcept { return m_missingReferences;              }
+
+    private:
+        struct FrameRange
+        {
+            size_t begin;
+            size_t end;
+            f64    timestamp;
+        };
+
+        void execute(size_t t_begin, size_t t_end, bool t_inRange) noexcept;
+        void executeRecord(CaptureOp t_op, CaptureReader& t_payload, bool t_inRange) noexcept;
+        void playCommands(CommandBuffer& t_commandBuffer, u64 t_stream) noexcept;
+        void createGraphicsPipeline(u64 t_id, CaptureReader& t_payload) noexcept;
+        void createComputePipeline(u64 t_id, CaptureReader& t_payload) noexcept;
+        auto writeShader(u64 t_id, std::string_view t_stage, std::span<const u8> t_code) noexcept -> std::string;
+        void forgetBuffer(u64 t_id) noexcept;
+        void forgetImage(u64 t_id) noexcept;
+        auto findBuffer(u64 t_id) noexcept -> Buffer*;
+        auto findImage(u64 t_id) noexcept -> Image*;
+        auto findPipeline(u64 t_id) noexcept -> Pipeline*;
+        auto findDescriptor(u64 t_id) noexcept -> Descriptor*;
+        auto toRenderingInfo(CaptureRendering const& t_rendering, ColorAttachmentInfo& t_color, DepthAttachmentInfo& t_depth) noexcept -> RenderingInfo;
+
+        Context*                                     m_context          { };
+        std::vector<u8>                              m_data             { };
+        CaptureHeader                                m_header           { };
+        std::vector<FrameRange>                      m_frames           { };
+        std::unordered_map<u64, Buffer>              m_buffers          { };
+        std::unordered_map<u64, Image>               m_images           { };
+        std::unordered_map<u64, u64>                 m_imageViews       { };
+        std::unordered_map<u64, Sampler>             m_samplers         { };
+        std::unordered_map<u64, DescriptorPool>      m_descriptorPools  { };
+        std::unordered_map<u64, Descriptor>          m_descriptors      { };
+        std::unordered_map<u64, Descriptor>          m_layouts          { };
+        std::unordered_map<u64, Pipeline>            m_pipelines        { };
+        std::unordered_map<u64, CommandBuffer>       m_commandBuffers   { };
+        std::unordered_map<u64, std::span<const u8>> m_streams          { };
+        std::string                                  m_shaderDirectory  { };
+        GpuFuture                                    m_lastFuture       { };
+        u64                                          m_missingReferences{ };
+    };
+}
\ No newline at end of file
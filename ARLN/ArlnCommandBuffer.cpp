@@ -2,27 +2,38 @@
 #include "ArlnContext.hpp"
 #include "ArlnPipeline.hpp"
 #include "ArlnDescriptor.hpp"
+#include <algorithm>
 
 namespace arln {
 
-    CommandBuffer::CommandBuffer(CommandPoolArray const& t_commandPools) noexcept
+    static auto toVkLayout(Context const& t_context, ImageLayout t_layout) noexcept -> VkImageLayout
     {
-        VkCommandBufferAllocateInfo allocateInfo;
-        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocateInfo.pNext = nullptr;
-        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocateInfo.commandBufferCount = 1;
-
-        for (size_t i = t_commandPools.size(); i--; )
+        if (t_layout == ImageLayout::ePresentSrc && t_context.isHeadless())
         {
-            allocateInfo.commandPool = t_commandPools[i];
-            vkAllocateCommandBuffers(CurrentContext()->getDevice(), &allocateInfo, &m_commandBuffers[i]);
+            return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         }
+
+        return static_cast<VkImageLayout>(t_layout);
+    }
+
+    CommandBuffer::CommandBuffer(Context& t_context, CommandBufferSetRef const& t_commandBuffers) noexcept
+        : m_context{ &t_context }
+        , m_commandBuffers{ t_commandBuffers }
+    {
+    }
+
+    CommandBuffer::CommandBuffer(Context& t_context, VkCommandBuffer t_secondaryCommandBuffer) noexcept
+        : m_context{ &t_context }
+        , m_currentHandle{ t_secondaryCommandBuffer }
+    {
     }
 
     void CommandBuffer::begin() noexcept
     {
-        m_currentHandle = &m_commandBuffers[CurrentContext()->getFrame().getIndex()];
+        if (m_commandBuffers)
+        {
+            m_currentHandle = m_commandBuffers->commandBuffers[m_context->getFrame().getIndex()];
+        }
 
         VkCommandBufferBeginInfo beginInfo;
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -30,16 +41,59 @@ namespace arln {
         beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         beginInfo.pInheritanceInfo = nullptr;
 
-        vkBeginCommandBuffer(*m_currentHandle, &beginInfo);
+        m_context->getDeviceTable().vkBeginCommandBuffer(m_currentHandle, &beginInfo);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBegin);
+    }
+
+    void CommandBuffer::beginSecondary(RenderingInfo const& t_renderingInfo) noexcept
+    {
+        VkFormat colorFormat = static_cast<VkFormat>(t_renderingInfo.pColorAttachment->image->getFormat());
+
+        VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO };
+        inheritanceRenderingInfo.flags = 0;
+        inheritanceRenderingInfo.viewMask = 0;
+        inheritanceRenderingInfo.colorAttachmentCount = 1;
+        inheritanceRenderingInfo.pColorAttachmentFormats = &colorFormat;
+        inheritanceRenderingInfo.depthAttachmentFormat = t_renderingInfo.pDepthAttachment
+            ? static_cast<VkFormat>(t_renderingInfo.pDepthAttachment->image->getFormat())
+            : VK_FORMAT_UNDEFINED;
+        inheritanceRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+        inheritanceRenderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkCommandBufferInheritanceInfo inheritanceInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+        inheritanceInfo.pNext = &inheritanceRenderingInfo;
+
+        // Lets the secondaries run inside a statistics zone of the primary
+        if (m_context->getPhysicalDeviceFeatures().features.inheritedQueries)
+        {
+            inheritanceInfo.pipelineStatistics = m_context->getProfiler().getStatisticsFlags();
+        }
+
+        VkCommandBufferBeginInfo beginInfo;
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        m_context->getDeviceTable().vkBeginCommandBuffer(m_currentHandle, &beginInfo);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBeginSecondary, capture->rendering(t_renderingInfo));
     }
 
     void CommandBuffer::end() noexcept
     {
-        vkEndCommandBuffer(*m_currentHandle);
+        while (!m_zones.empty())
+        {
+            endZone();
+        }
+
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eEnd);
+        m_context->getDeviceTable().vkEndCommandBuffer(m_currentHandle);
     }
 
     void CommandBuffer::beginRendering(RenderingInfo const& t_renderingInfo) noexcept
     {
+        flushBarriers();
         VkRenderingInfo renderingInfo{};
         VkRenderingAttachmentInfo colorAttachment;
         VkRenderingAttachmentInfo depthAttachment;
@@ -78,9 +132,9 @@ namespace arln {
 
         renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
         renderingInfo.pNext = nullptr;
-        renderingInfo.flags = 0;
-        renderingInfo.renderArea.extent.width = t_renderingInfo.size.x == 0 ? CurrentContext()->getSwapchain().getExtent().width : t_renderingInfo.size.x;
-        renderingInfo.renderArea.extent.height = t_renderingInfo.size.y == 0 ? CurrentContext()->getSwapchain().getExtent().height : t_renderingInfo.size.y;
+        renderingInfo.flags = t_renderingInfo.secondaryCommandBuffers ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
+        renderingInfo.renderArea.extent.width = t_renderingInfo.size.x == 0 ? m_context->getSwapchain().getExtent().width : t_renderingInfo.size.x;
+        renderingInfo.renderArea.extent.height = t_renderingInfo.size.y == 0 ? m_context->getSwapchain().getExtent().height : t_renderingInfo.size.y;
         renderingInfo.renderArea.offset.x = t_renderingInfo.offset.x;
         renderingInfo.renderArea.offset.y = t_renderingInfo.offset.y;
         renderingInfo.layerCount = 1;
@@ -89,72 +143,148 @@ namespace arln {
         renderingInfo.pColorAttachments = &colorAttachment;
         renderingInfo.pStencilAttachment = nullptr;
 
-        vkCmdBeginRendering(*m_currentHandle, &renderingInfo);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBeginRendering, capture->rendering(t_renderingInfo));
+        m_context->getDeviceTable().vkCmdBeginRendering(m_currentHandle, &renderingInfo);
     }
 
     void CommandBuffer::endRendering() noexcept
     {
-        vkCmdEndRendering(*m_currentHandle);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eEndRendering);
+        m_context->getDeviceTable().vkCmdEndRendering(m_currentHandle);
+    }
+
+    void CommandBuffer::executeCommands(std::span<const CommandBuffer> t_secondaryCommandBuffers) noexcept
+    {
+        flushBarriers();
+        std::vector<VkCommandBuffer> handles(t_secondaryCommandBuffers.size());
+
+        for (size_t i = handles.size(); i--; )
+        {
+            handles[i] = t_secondaryCommandBuffers[i];
+        }
+
+        if (auto capture = capturing())
+        {
+            std::vector<u64> ids(handles.size());
+            for (size_t i = ids.size(); i--; )
+            {
+                ids[i] = captureId(handles[i]);
+            }
+
+            capture->command(m_currentHandle, CaptureOp::eExecuteCommands, std::span<const u64>(ids));
+        }
+
+        if (!handles.empty())
+        {
+            m_context->getDeviceTable().vkCmdExecuteCommands(m_currentHandle, static_cast<u32>(handles.size()), handles.data());
+        }
+    }
+
+    void CommandBuffer::recordParallel(RenderingInfo const& t_renderingInfo, u32 t_chunkCount, std::function<void(CommandBuffer&, u32)> const& t_function) noexcept
+    {
+        // Secondaries inherit only the attachment formats, viewport, scissor and bindings must be set per chunk
+        RenderingInfo renderingInfo = t_renderingInfo;
+        renderingInfo.secondaryCommandBuffers = true;
+
+        u32 queueFamilyIndex = m_commandBuffers ? m_commandBuffers->queueFamilyIndex : m_context->getQueueFamilyIndex();
+        std::vector<CommandBuffer> secondaryCommandBuffers(t_chunkCount);
+
+        beginRendering(renderingInfo);
+
+        m_context->getWorkerPool().parallelFor(t_chunkCount, [&](u32 t_chunk)
+        {
+            auto& commandBuffer = secondaryCommandBuffers[t_chunk];
+            commandBuffer = m_context->getFrame().allocateSecondaryCommandBuffer(queueFamilyIndex);
+
+            commandBuffer.beginSecondary(renderingInfo);
+            t_function(commandBuffer, t_chunk);
+            commandBuffer.end();
+        });
+
+        executeCommands(secondaryCommandBuffers);
+        endRendering();
     }
 
     void CommandBuffer::bindGraphicsPipeline(Pipeline& t_pipeline) noexcept
     {
-        vkCmdBindPipeline(*m_currentHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, t_pipeline.getHandle());
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBindGraphicsPipeline, captureId(t_pipeline.getHandle()));
+        m_context->getDeviceTable().vkCmdBindPipeline(m_currentHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, t_pipeline.getHandle());
     }
 
     void CommandBuffer::bindComputePipeline(Pipeline& t_pipeline) noexcept
     {
-        vkCmdBindPipeline(*m_currentHandle, VK_PIPELINE_BIND_POINT_COMPUTE, t_pipeline.getHandle());
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBindComputePipeline, captureId(t_pipeline.getHandle()));
+        m_context->getDeviceTable().vkCmdBindPipeline(m_currentHandle, VK_PIPELINE_BIND_POINT_COMPUTE, t_pipeline.getHandle());
     }
 
     void CommandBuffer::dispatch(u32 t_x, u32 t_y, u32 t_z) noexcept
     {
-        vkCmdDispatch(*m_currentHandle, t_x, t_y, t_z);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDispatch, t_x, t_y, t_z);
+        m_context->getDeviceTable().vkCmdDispatch(m_currentHandle, t_x, t_y, t_z);
     }
 
     void CommandBuffer::draw(u32 t_vertexCount, u32 t_instanceCount, i32 t_firstVertex, u32 t_firstInstance) noexcept
     {
-        vkCmdDraw(*m_currentHandle, t_vertexCount, t_instanceCount, t_firstVertex, t_firstInstance);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDraw, t_vertexCount, t_instanceCount, t_firstVertex, t_firstInstance);
+        m_context->getDeviceTable().vkCmdDraw(m_currentHandle, t_vertexCount, t_instanceCount, t_firstVertex, t_firstInstance);
     }
 
     void CommandBuffer::drawIndexed(u32 t_indexCount, u32 t_instanceCount, u32 t_firstIndex, i32 t_vertexOffset, u32 t_firstInstance) noexcept
     {
-        vkCmdDrawIndexed(*m_currentHandle, t_indexCount, t_instanceCount, t_firstIndex, t_vertexOffset, t_firstInstance);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawIndexed, t_indexCount, t_instanceCount, t_firstIndex, t_vertexOffset, t_firstInstance);
+        m_context->getDeviceTable().vkCmdDrawIndexed(m_currentHandle, t_indexCount, t_instanceCount, t_firstIndex, t_vertexOffset, t_firstInstance);
     }
 
     void CommandBuffer::drawIndirect(Buffer& t_buffer, size_t t_offset, u32 t_drawCount, u32 t_stride) noexcept
     {
-        vkCmdDrawIndirect(*m_currentHandle, t_buffer.getHandle(), t_offset, t_drawCount, t_stride);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawIndirect, captureId(t_buffer.getHandle()), t_offset, t_drawCount, t_stride);
+        m_context->getDeviceTable().vkCmdDrawIndirect(m_currentHandle, t_buffer.getHandle(), t_offset, t_drawCount, t_stride);
     }
 
     void CommandBuffer::drawIndirectCount(Buffer& t_buffer, size_t t_offset, Buffer& t_countBuffer, size_t t_countBufferOffset, u32 t_maxDrawCount, u32 t_stride) noexcept
     {
-        vkCmdDrawIndirectCount(*m_currentHandle, t_buffer.getHandle(), t_offset, t_countBuffer.getHandle(), t_countBufferOffset, t_maxDrawCount, t_stride);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawIndirectCount, captureId(t_buffer.getHandle()), t_offset, captureId(t_countBuffer.getHandle()), t_countBufferOffset, t_maxDrawCount, t_stride);
+        m_context->getDeviceTable().vkCmdDrawIndirectCount(m_currentHandle, t_buffer.getHandle(), t_offset, t_countBuffer.getHandle(), t_countBufferOffset, t_maxDrawCount, t_stride);
     }
 
     void CommandBuffer::drawIndexedIndirect(Buffer& t_buffer, size_t t_offset, u32 t_drawCount, u32 t_stride) noexcept
     {
-        vkCmdDrawIndexedIndirect(*m_currentHandle, t_buffer.getHandle(), t_offset, t_drawCount, t_stride);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawIndexedIndirect, captureId(t_buffer.getHandle()), t_offset, t_drawCount, t_stride);
+        m_context->getDeviceTable().vkCmdDrawIndexedIndirect(m_currentHandle, t_buffer.getHandle(), t_offset, t_drawCount, t_stride);
     }
 
     void CommandBuffer::drawIndexedIndirectCount(Buffer& t_buffer, size_t t_offset, Buffer& t_countBuffer, size_t t_countBufferOffset, u32 t_maxDrawCount, u32 t_stride) noexcept
     {
-        vkCmdDrawIndexedIndirectCount(*m_currentHandle, t_buffer.getHandle(), t_offset, t_countBuffer.getHandle(), t_countBufferOffset, t_maxDrawCount, t_stride);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawIndexedIndirectCount, captureId(t_buffer.getHandle()), t_offset, captureId(t_countBuffer.getHandle()), t_countBufferOffset, t_maxDrawCount, t_stride);
+        m_context->getDeviceTable().vkCmdDrawIndexedIndirectCount(m_currentHandle, t_buffer.getHandle(), t_offset, t_countBuffer.getHandle(), t_countBufferOffset, t_maxDrawCount, t_stride);
     }
 
     void CommandBuffer::drawMeshTask(u32 t_x, u32 t_y, u32 t_z) noexcept
     {
-        vkCmdDrawMeshTasksEXT(*m_currentHandle, t_x, t_y, t_z);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawMeshTask, t_x, t_y, t_z);
+        m_context->getDeviceTable().vkCmdDrawMeshTasksEXT(m_currentHandle, t_x, t_y, t_z);
     }
 
     void CommandBuffer::drawMeshTaskIndirect(Buffer& t_buffer, size_t t_offset, u32 t_drawCount, u32 t_stride) noexcept
     {
-        vkCmdDrawMeshTasksIndirectEXT(*m_currentHandle, t_buffer.getHandle(), t_offset, t_drawCount, t_stride);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawMeshTaskIndirect, captureId(t_buffer.getHandle()), t_offset, t_drawCount, t_stride);
+        m_context->getDeviceTable().vkCmdDrawMeshTasksIndirectEXT(m_currentHandle, t_buffer.getHandle(), t_offset, t_drawCount, t_stride);
     }
 
     void CommandBuffer::drawMeshTaskIndirectCount(Buffer& t_buffer, size_t t_offset, Buffer& t_countBuffer, size_t t_countBufferOffset, u32 t_maxDrawCount, u32 t_stride) noexcept
     {
-        vkCmdDrawMeshTasksIndirectCountEXT(*m_currentHandle, t_buffer.getHandle(), t_offset, t_countBuffer.getHandle(), t_countBufferOffset, t_maxDrawCount, t_stride);
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eDrawMeshTaskIndirectCount, captureId(t_buffer.getHandle()), t_offset, captureId(t_countBuffer.getHandle()), t_countBufferOffset, t_maxDrawCount, t_stride);
+        m_context->getDeviceTable().vkCmdDrawMeshTasksIndirectCountEXT(m_currentHandle, t_buffer.getHandle(), t_offset, t_countBuffer.getHandle(), t_countBufferOffset, t_maxDrawCount, t_stride);
     }
 
     void CommandBuffer::setViewport(f32 t_x, f32 t_y, f32 t_width, f32 t_height) noexcept
@@ -167,7 +297,8 @@ namespace arln {
         viewport.width = t_width;
         viewport.height = t_height;
 
-        vkCmdSetViewport(*m_currentHandle, 0, 1, &viewport);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eSetViewport, t_x, t_y, t_width, t_height);
+        m_context->getDeviceTable().vkCmdSetViewport(m_currentHandle, 0, 1, &viewport);
     }
 
     void CommandBuffer::setScissor(i32 t_x, i32 t_y, u32 t_width, u32 t_height) noexcept
@@ -176,28 +307,53 @@ namespace arln {
         scissor.offset = { t_x, t_y };
         scissor.extent = { t_width, t_height };
 
-        vkCmdSetScissor(*m_currentHandle, 0, 1, &scissor);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eSetScissor, t_x, t_y, t_width, t_height);
+        m_context->getDeviceTable().vkCmdSetScissor(m_currentHandle, 0, 1, &scissor);
     }
 
     void CommandBuffer::bindVertexBuffer(Buffer& t_buffer, size_t t_offset, u32 t_firstBinding) noexcept
     {
-        vkCmdBindVertexBuffers(*m_currentHandle, t_firstBinding, 1, &t_buffer.getHandle(), &t_offset);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBindVertexBuffer, captureId(t_buffer.getHandle()), t_offset, t_firstBinding);
+        m_context->getDeviceTable().vkCmdBindVertexBuffers(m_currentHandle, t_firstBinding, 1, &t_buffer.getHandle(), &t_offset);
+    }
+
+    void CommandBuffer::bindVertexBuffer(BufferSlice const& t_slice, u32 t_firstBinding) noexcept
+    {
+        bindVertexBuffer(*t_slice.buffer, t_slice.offset, t_firstBinding);
     }
 
     void CommandBuffer::bindIndexBuffer16(Buffer& t_buffer, size_t t_offset) noexcept
     {
-        vkCmdBindIndexBuffer(*m_currentHandle, t_buffer.getHandle(), t_offset, VK_INDEX_TYPE_UINT16);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBindIndexBuffer16, captureId(t_buffer.getHandle()), t_offset);
+        m_context->getDeviceTable().vkCmdBindIndexBuffer(m_currentHandle, t_buffer.getHandle(), t_offset, VK_INDEX_TYPE_UINT16);
+    }
+
+    void CommandBuffer::bindIndexBuffer16(BufferSlice const& t_slice) noexcept
+    {
+        bindIndexBuffer16(*t_slice.buffer, t_slice.offset);
     }
 
     void CommandBuffer::bindIndexBuffer32(Buffer& t_buffer, size_t t_offset) noexcept
     {
-        vkCmdBindIndexBuffer(*m_currentHandle, t_buffer.getHandle(), t_offset, VK_INDEX_TYPE_UINT32);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBindIndexBuffer32, captureId(t_buffer.getHandle()), t_offset);
+        m_context->getDeviceTable().vkCmdBindIndexBuffer(m_currentHandle, t_buffer.getHandle(), t_offset, VK_INDEX_TYPE_UINT32);
+    }
+
+    void CommandBuffer::bindIndexBuffer32(BufferSlice const& t_slice) noexcept
+    {
+        bindIndexBuffer32(*t_slice.buffer, t_slice.offset);
     }
 
     void CommandBuffer::pushConstant(Pipeline& t_pipeline, ShaderStage t_stage, u32 t_size, void const* t_data) noexcept
     {
-        vkCmdPushConstants(
-            *m_currentHandle,
+        if (auto capture = capturing())
+        {
+            auto const bytes = static_cast<u8 const*>(t_data);
+            capture->command(m_currentHandle, CaptureOp::ePushConstant, captureId(t_pipeline.getHandle()), t_stage, std::span<const u8>(bytes, t_size));
+        }
+
+        m_context->getDeviceTable().vkCmdPushConstants(
+            m_currentHandle,
             t_pipeline.getLayout(),
             static_cast<VkShaderStageFlags>(t_stage),
             0,
@@ -206,21 +362,29 @@ namespace arln {
         );
     }
 
-    void CommandBuffer::bindDescriptorGraphics(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet) noexcept
+    void CommandBuffer::bindDescriptorGraphics(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet, std::span<const u32> t_dynamicOffsets) noexcept
     {
-        vkCmdBindDescriptorSets(
-            *m_currentHandle,
+        if (auto capture = capturing())
+        {
+            u64 const id = captureId(t_descriptor.getSet());
+            capture->command(m_currentHandle, CaptureOp::eBindDescriptorsGraphics, captureId(t_pipeline.getHandle()), t_firstSet, std::span<const u64>(&id, 1), t_dynamicOffsets);
+        }
+
+        m_context->getDefragmenter().useDescriptors({ &t_descriptor.getSet(), 1 });
+
+        m_context->getDeviceTable().vkCmdBindDescriptorSets(
+            m_currentHandle,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             t_pipeline.getLayout(),
             t_firstSet,
             1,
             &t_descriptor.getSet(),
-            0,
-            nullptr
+            static_cast<u32>(t_dynamicOffsets.size()),
+            t_dynamicOffsets.data()
         );
     }
 
-    void CommandBuffer::bindDescriptorGraphics(Pipeline& t_pipeline, const std::vector<std::reference_wrapper<Descriptor>>& t_descriptors, u32 t_firstSet) noexcept
+    void CommandBuffer::bindDescriptorGraphics(Pipeline& t_pipeline, const std::vector<std::reference_wrapper<Descriptor>>& t_descriptors, u32 t_firstSet, std::span<const u32> t_dynamicOffsets) noexcept
     {
         std::vector<VkDescriptorSet> sets(t_descriptors.size());
         for (size_t i = sets.size(); i--; )
@@ -228,33 +392,54 @@ namespace arln {
             sets[i] = t_descriptors[i].get().getSet();
         }
 
-        vkCmdBindDescriptorSets(
-            *m_currentHandle,
+        if (auto capture = capturing())
+        {
+            std::vector<u64> ids(sets.size());
+            for (size_t i = ids.size(); i--; )
+            {
+                ids[i] = captureId(sets[i]);
+            }
+
+            capture->command(m_currentHandle, CaptureOp::eBindDescriptorsGraphics, captureId(t_pipeline.getHandle()), t_firstSet, std::span<const u64>(ids), t_dynamicOffsets);
+        }
+
+        m_context->getDefragmenter().useDescriptors(sets);
+
+        m_context->getDeviceTable().vkCmdBindDescriptorSets(
+            m_currentHandle,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             t_pipeline.getLayout(),
             t_firstSet,
             static_cast<u32>(sets.size()),
             sets.data(),
-            0,
-            nullptr
+            static_cast<u32>(t_dynamicOffsets.size()),
+            t_dynamicOffsets.data()
         );
     }
 
-    void CommandBuffer::bindDescriptorCompute(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet) noexcept
+    void CommandBuffer::bindDescriptorCompute(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet, std::span<const u32> t_dynamicOffsets) noexcept
     {
-        vkCmdBindDescriptorSets(
-            *m_currentHandle,
+        if (auto capture = capturing())
+        {
+            u64 const id = captureId(t_descriptor.getSet());
+            capture->command(m_currentHandle, CaptureOp::eBindDescriptorsCompute, captureId(t_pipeline.getHandle()), t_firstSet, std::span<const u64>(&id, 1), t_dynamicOffsets);
+        }
+
+        m_context->getDefragmenter().useDescriptors({ &t_descriptor.getSet(), 1 });
+
+        m_context->getDeviceTable().vkCmdBindDescriptorSets(
+            m_currentHandle,
             VK_PIPELINE_BIND_POINT_COMPUTE,
             t_pipeline.getLayout(),
             t_firstSet,
             1,
             &t_descriptor.getSet(),
-            0,
-            nullptr
+            static_cast<u32>(t_dynamicOffsets.size()),
+            t_dynamicOffsets.data()
         );
     }
 
-    void CommandBuffer::bindDescriptorCompute(Pipeline& t_pipeline, const std::vector<std::reference_wrapper<Descriptor>>& t_descriptors, u32 t_firstSet) noexcept
+    void CommandBuffer::bindDescriptorCompute(Pipeline& t_pipeline, const std::vector<std::reference_wrapper<Descriptor>>& t_descriptors, u32 t_firstSet, std::span<const u32> t_dynamicOffsets) noexcept
     {
         std::vector<VkDescriptorSet> sets(t_descriptors.size());
         for (size_t i = sets.size(); i--; )
@@ -262,39 +447,205 @@ namespace arln {
             sets[i] = t_descriptors[i].get().getSet();
         }
 
-        vkCmdBindDescriptorSets(
-            *m_currentHandle,
+        if (auto capture = capturing())
+        {
+            std::vector<u64> ids(sets.size());
+            for (size_t i = ids.size(); i--; )
+            {
+                ids[i] = captureId(sets[i]);
+            }
+
+            capture->command(m_currentHandle, CaptureOp::eBindDescriptorsCompute, captureId(t_pipeline.getHandle()), t_firstSet, std::span<const u64>(ids), t_dynamicOffsets);
+        }
+
+        m_context->getDefragmenter().useDescriptors(sets);
+
+        m_context->getDeviceTable().vkCmdBindDescriptorSets(
+            m_currentHandle,
             VK_PIPELINE_BIND_POINT_COMPUTE,
             t_pipeline.getLayout(),
             t_firstSet,
             static_cast<u32>(sets.size()),
             sets.data(),
-            0,
-            nullptr
+            static_cast<u32>(t_dynamicOffsets.size()),
+            t_dynamicOffsets.data()
         );
     }
 
     void CommandBuffer::transitionImages(std::vector<ImageTransitionInfo> const& t_transitionInfos) noexcept
     {
-        std::vector<VkImageMemoryBarrier2> barriers(t_transitionInfos.size());
+        pipelineBarrier(t_transitionInfos, { });
+    }
+
+    void CommandBuffer::transitionImages(ImageTransitionInfo const& t_transitionInfo) noexcept
+    {
+        pipelineBarrier({ &t_transitionInfo, 1 }, { });
+    }
+
+    void CommandBuffer::pipelineBarrier(std::span<const ImageTransitionInfo> t_transitionInfos, std::span<const MemoryBarrierInfo> t_memoryBarriers) noexcept
+    {
+        flushBarriers();
+
+        // Explicit transitions keep the tracked state right for later require calls
+        for (auto& transitionInfo : t_transitionInfos)
+        {
+            if (auto states = transitionInfo.image->getStates())
+            {
+                for (u32 layer = transitionInfo.baseArrayLayer; layer < transitionInfo.baseArrayLayer + transitionInfo.layerCount; ++layer)
+                {
+                    for (u32 mip = transitionInfo.baseMipLevel; mip < transitionInfo.baseMipLevel + transitionInfo.levelCount; ++mip)
+                    {
+                        (*states)[layer * transitionInfo.image->getMipLevels() + mip].transitioned(
+                            transitionInfo.newLayout, transitionInfo.dstStageMask, transitionInfo.dstAccessMask);
+                    }
+                }
+            }
+        }
+
+        recordBarriers(t_transitionInfos, t_memoryBarriers);
+    }
+
+    void CommandBuffer::require(Image& t_image, ResourceUsage t_usage, bool t_discard) noexcept
+    {
+        auto const states = t_image.getStates();
+
+        // Images without tracked state are transitioned explicitly by their owner
+        if (!states)
+        {
+            return;
+        }
+
+        auto const usage = getUsageInfo(t_usage);
+
+        for (u32 layer = 0; layer < t_image.getArrayLayers(); ++layer)
+        {
+            for (u32 mip = 0; mip < t_image.getMipLevels(); ++mip)
+            {
+                auto& state = (*states)[layer * t_image.getMipLevels() + mip];
+
+                if (t_discard)
+                {
+                    state.layout = ImageLayout::eUndefined;
+                }
+
+                ImageLayout const oldLayout = state.layout;
+                MemoryBarrierInfo barrier;
+
+                if (!state.access(usage, true, barrier))
+                {
+                    continue;
+                }
+
+                auto pending = std::ranges::find_if(m_pendingTransitions, [&](ImageTransitionInfo const& t_transition)
+                {
+                    return t_transition.image->getHandle() == t_image.getHandle() && t_transition.baseMipLevel == mip && t_transition.baseArrayLayer == layer;
+                });
+
+                // Nothing ran since the pending barrier, so the intermediate state is never observed
+                if (pending != m_pendingTransitions.end())
+                {
+                    if (pending->newLayout != usage.layout)
+                    {
+                        pending->newLayout = usage.layout;
+                        pending->dstStageMask = barrier.dstStageMask;
+                        pending->dstAccessMask = barrier.dstAccessMask;
+                    }
+                    else
+                    {
+                        pending->dstStageMask |= barrier.dstStageMask;
+                        pending->dstAccessMask |= barrier.dstAccessMask;
+                    }
+                    continue;
+                }
+
+                m_pendingTransitions.push_back(ImageTransitionInfo{
+                    .image = t_image,
+                    .oldLayout = oldLayout,
+                    .newLayout = usage.layout,
+                    .srcStageMask = barrier.srcStageMask,
+                    .dstStageMask = barrier.dstStageMask,
+                    .srcAccessMask = barrier.srcAccessMask,
+                    .dstAccessMask = barrier.dstAccessMask,
+                    .baseMipLevel = mip,
+                    .levelCount = 1,
+                    .baseArrayLayer = layer,
+                    .layerCount = 1
+                });
+            }
+        }
+    }
+
+    void CommandBuffer::flushBarriers() noexcept
+    {
+        if (m_pendingTransitions.empty())
+        {
+            return;
+        }
+
+        recordBarriers(m_pendingTransitions, { });
+        m_pendingTransitions.clear();
+    }
+
+    void CommandBuffer::beginZone(std::string_view t_name, bool t_statistics) noexcept
+    {
+        u32 const depth = static_cast<u32>(m_zones.size());
+
+        // Pipeline statistics queries cannot overlap, and most of the counters need a graphics queue
+        bool const graphicsQueue = !m_commandBuffers || m_commandBuffers->queueFamilyIndex == m_context->getQueueFamilyIndex();
+        bool const statistics = t_statistics && graphicsQueue && m_statisticsDepth == ~0u;
+
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBeginZone, t_statistics, t_name);
+
+        u32 const zone = m_context->getProfiler().beginZone(m_currentHandle, t_name, depth, statistics);
+        m_zones.push_back(zone);
+
+        if (statistics && zone != ~0u)
+        {
+            m_statisticsDepth = depth;
+        }
+    }
+
+    void CommandBuffer::endZone() noexcept
+    {
+        if (m_zones.empty())
+        {
+            return;
+        }
 
-        for (size_t i = barriers.size(); i--; )
+        flushBarriers();
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eEndZone);
+
+        m_context->getProfiler().endZone(m_currentHandle, m_zones.back());
+        m_zones.pop_back();
+
+        if (m_statisticsDepth == m_zones.size())
         {
-            barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-            barriers[i].pNext = nullptr;
-            barriers[i].srcStageMask = t_transitionInfos[i].srcStageMask;
-            barriers[i].dstStageMask = t_transitionInfos[i].dstStageMask;
-            barriers[i].srcAccessMask = t_transitionInfos[i].srcAccessMask;
-            barriers[i].dstAccessMask = t_transitionInfos[i].dstAccessMask;
-            barriers[i].oldLayout = static_cast<VkImageLayout>(t_transitionInfos[i].oldLayout);
-            barriers[i].newLayout = static_cast<VkImageLayout>(t_transitionInfos[i].newLayout);
-            barriers[i].image = t_transitionInfos[i].image->getHandle();
-            barriers[i].srcQueueFamilyIndex = 0;
-            barriers[i].dstQueueFamilyIndex = 0;
-            barriers[i].subresourceRange.baseMipLevel = 0;
-            barriers[i].subresourceRange.levelCount = 1;
-            barriers[i].subresourceRange.baseArrayLayer = 0;
-            barriers[i].subresourceRange.layerCount = 1;
+            m_statisticsDepth = ~0u;
+        }
+    }
+
+    void CommandBuffer::recordBarriers(std::span<const ImageTransitionInfo> t_transitionInfos, std::span<const MemoryBarrierInfo> t_memoryBarriers) noexcept
+    {
+        std::vector<VkImageMemoryBarrier2> imageBarriers(t_transitionInfos.size());
+        std::vector<VkMemoryBarrier2> memoryBarriers(t_memoryBarriers.size());
+
+        for (size_t i = imageBarriers.size(); i--; )
+        {
+            imageBarriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            imageBarriers[i].pNext = nullptr;
+            imageBarriers[i].srcStageMask = t_transitionInfos[i].srcStageMask;
+            imageBarriers[i].dstStageMask = t_transitionInfos[i].dstStageMask;
+            imageBarriers[i].srcAccessMask = t_transitionInfos[i].srcAccessMask;
+            imageBarriers[i].dstAccessMask = t_transitionInfos[i].dstAccessMask;
+            imageBarriers[i].oldLayout = toVkLayout(*m_context, t_transitionInfos[i].oldLayout);
+            imageBarriers[i].newLayout = toVkLayout(*m_context, t_transitionInfos[i].newLayout);
+            imageBarriers[i].image = t_transitionInfos[i].image->getHandle();
+            imageBarriers[i].srcQueueFamilyIndex = 0;
+            imageBarriers[i].dstQueueFamilyIndex = 0;
+            imageBarriers[i].subresourceRange.baseMipLevel = t_transitionInfos[i].baseMipLevel;
+            imageBarriers[i].subresourceRange.levelCount = t_transitionInfos[i].levelCount;
+            imageBarriers[i].subresourceRange.baseArrayLayer = t_transitionInfos[i].baseArrayLayer;
+            imageBarriers[i].subresourceRange.layerCount = t_transitionInfos[i].layerCount;
 
             switch (t_transitionInfos[i].newLayout)
             {
@@ -304,72 +655,51 @@ namespace arln {
             case ImageLayout::eDepthReadOnly:
             case ImageLayout::eDepthStencilReadOnly:
             case ImageLayout::eDepthReadOnlyStencilAttachment:
-                barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+                imageBarriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
                 break;
             case ImageLayout::eStencilAttachment:
             case ImageLayout::eStencilReadOnly:
-                barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
+                imageBarriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
                 break;
             default:
-                barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                imageBarriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
                 break;
             }
         }
 
-        VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-        dependencyInfo.imageMemoryBarrierCount = static_cast<u32>(barriers.size());
-        dependencyInfo.pImageMemoryBarriers = barriers.data();
+        for (size_t i = memoryBarriers.size(); i--; )
+        {
+            memoryBarriers[i].sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+            memoryBarriers[i].pNext = nullptr;
+            memoryBarriers[i].srcStageMask = t_memoryBarriers[i].srcStageMask;
+            memoryBarriers[i].dstStageMask = t_memoryBarriers[i].dstStageMask;
+            memoryBarriers[i].srcAccessMask = t_memoryBarriers[i].srcAccessMask;
+            memoryBarriers[i].dstAccessMask = t_memoryBarriers[i].dstAccessMask;
+        }
 
-        vkCmdPipelineBarrier2(*m_currentHandle, &dependencyInfo);
-    }
+        if (imageBarriers.empty() && memoryBarriers.empty())
+        {
+            return;
+        }
 
-    void CommandBuffer::transitionImages(ImageTransitionInfo const& t_transitionInfo) noexcept
-    {
-        VkImageMemoryBarrier2 barrier;
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-        barrier.pNext = nullptr;
-        barrier.srcStageMask = t_transitionInfo.srcStageMask;
-        barrier.dstStageMask = t_transitionInfo.dstStageMask;
-        barrier.srcAccessMask = t_transitionInfo.srcAccessMask;
-        barrier.dstAccessMask = t_transitionInfo.dstAccessMask;
-        barrier.oldLayout = static_cast<VkImageLayout>(t_transitionInfo.oldLayout);
-        barrier.newLayout = static_cast<VkImageLayout>(t_transitionInfo.newLayout);
-        barrier.image = t_transitionInfo.image->getHandle();
-        barrier.srcQueueFamilyIndex = 0;
-        barrier.dstQueueFamilyIndex = 0;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        switch (t_transitionInfo.newLayout)
+        if (auto capture = capturing())
         {
-        case ImageLayout::eDepthStencilAttachment:
-        case ImageLayout::eDepthAttachment:
-        case ImageLayout::eDepthAttachmentStencilReadOnly:
-        case ImageLayout::eDepthReadOnly:
-        case ImageLayout::eDepthStencilReadOnly:
-        case ImageLayout::eDepthReadOnlyStencilAttachment:
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            break;
-        case ImageLayout::eStencilAttachment:
-        case ImageLayout::eStencilReadOnly:
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_STENCIL_BIT;
-            break;
-        default:
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            break;
+            auto const barriers = capture->barriers(t_transitionInfos);
+            capture->command(m_currentHandle, CaptureOp::eBarriers, std::span<const CaptureBarrier>(barriers), t_memoryBarriers);
         }
 
         VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
-        dependencyInfo.imageMemoryBarrierCount = 1;
-        dependencyInfo.pImageMemoryBarriers = &barrier;
+        dependencyInfo.memoryBarrierCount = static_cast<u32>(memoryBarriers.size());
+        dependencyInfo.pMemoryBarriers = memoryBarriers.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<u32>(imageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
 
-        vkCmdPipelineBarrier2(*m_currentHandle, &dependencyInfo);
+        m_context->getDeviceTable().vkCmdPipelineBarrier2(m_currentHandle, &dependencyInfo);
     }
 
     void CommandBuffer::blitImage(Image& t_src, Image& t_dst, ImageBlit const& t_blit) noexcept
     {
+        flushBarriers();
         VkImageBlit blit;
         blit.srcOffsets[0] = { t_blit.srcOffset.x, t_blit.srcOffset.y, t_blit.srcOffset.z };
         blit.dstOffsets[0] = { t_blit.dstOffset.x, t_blit.dstOffset.y, t_blit.dstOffset.z };
@@ -384,8 +714,10 @@ namespace arln {
         blit.dstSubresource.mipLevel = 0;
         blit.dstSubresource.baseArrayLayer = 0;
 
-        vkCmdBlitImage(
-            *m_currentHandle,
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eBlitImage, capture->image(t_src), capture->image(t_dst), t_blit);
+
+        m_context->getDeviceTable().vkCmdBlitImage(
+            m_currentHandle,
             t_src.getHandle(),
             static_cast<VkImageLayout>(t_blit.srcLayout),
             t_dst.getHandle(),
@@ -398,6 +730,7 @@ namespace arln {
 
     void CommandBuffer::copyImage(Image& t_src, Image& t_dst, ImageCopy const& t_copyInfo) noexcept
     {
+        flushBarriers();
         VkImageCopy copy;
         copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         copy.srcSubresource.layerCount = 1;
@@ -411,8 +744,10 @@ namespace arln {
         copy.srcOffset = { t_copyInfo.srcOffset.x, t_copyInfo.srcOffset.y, t_copyInfo.srcOffset.z };
         copy.extent    = { t_copyInfo.extent.x,    t_copyInfo.extent.y,    t_copyInfo.extent.z    };
 
-        vkCmdCopyImage(
-            *m_currentHandle,
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eCopyImage, capture->image(t_src), capture->image(t_dst), t_copyInfo);
+
+        m_context->getDeviceTable().vkCmdCopyImage(
+            m_currentHandle,
             t_src.getHandle(),
             static_cast<VkImageLayout>(t_copyInfo.srcLayout),
             t_dst.getHandle(),
@@ -424,16 +759,20 @@ namespace arln {
 
     void CommandBuffer::copyBuffer(Buffer& t_src, Buffer& t_dst, size_t t_size, size_t t_dstOffset, size_t t_srcOffset) noexcept
     {
+        flushBarriers();
         VkBufferCopy copy;
         copy.size = t_size;
         copy.dstOffset = t_dstOffset;
         copy.srcOffset = t_srcOffset;
 
-        vkCmdCopyBuffer(*m_currentHandle, t_src.getHandle(), t_dst.getHandle(), 1, &copy);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eCopyBuffer, captureId(t_src.getHandle()), captureId(t_dst.getHandle()), t_size, t_dstOffset, t_srcOffset);
+
+        m_context->getDeviceTable().vkCmdCopyBuffer(m_currentHandle, t_src.getHandle(), t_dst.getHandle(), 1, &copy);
     }
 
     void CommandBuffer::copyBufferToImage(Buffer& t_src, Image& t_dst, BufferImageCopy const& t_copyInfo) noexcept
     {
+        flushBarriers();
         VkBufferImageCopy copy;
         copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         copy.imageSubresource.layerCount = 1;
@@ -445,11 +784,14 @@ namespace arln {
         copy.imageOffset = { t_copyInfo.imageOffset.x, t_copyInfo.imageOffset.y, t_copyInfo.imageOffset.z };
         copy.imageExtent = { t_copyInfo.imageExtent.x, t_copyInfo.imageExtent.y, t_copyInfo.imageExtent.z };
 
-        vkCmdCopyBufferToImage(*m_currentHandle, t_src.getHandle(), t_dst.getHandle(), static_cast<VkImageLayout>(t_copyInfo.imageLayout), 1, &copy);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eCopyBufferToImage, captureId(t_src.getHandle()), capture->image(t_dst), t_copyInfo);
+
+        m_context->getDeviceTable().vkCmdCopyBufferToImage(m_currentHandle, t_src.getHandle(), t_dst.getHandle(), static_cast<VkImageLayout>(t_copyInfo.imageLayout), 1, &copy);
     }
 
     void CommandBuffer::copyImageToBuffer(Image& t_src, Buffer& t_dst, BufferImageCopy const& t_copyInfo) noexcept
     {
+        flushBarriers();
         VkBufferImageCopy copy;
         copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         copy.imageSubresource.layerCount = 1;
@@ -461,6 +803,14 @@ namespace arln {
         copy.imageOffset = { t_copyInfo.imageOffset.x, t_copyInfo.imageOffset.y, t_copyInfo.imageOffset.z };
         copy.imageExtent = { t_copyInfo.imageExtent.x, t_copyInfo.imageExtent.y, t_copyInfo.imageExtent.z };
 
-        vkCmdCopyImageToBuffer(*m_currentHandle, t_src.getHandle(), static_cast<VkImageLayout>(t_copyInfo.imageLayout), t_dst.getHandle(), 1, &copy);
+        if (auto capture = capturing()) capture->command(m_currentHandle, CaptureOp::eCopyImageToBuffer, capture->image(t_src), captureId(t_dst.getHandle()), t_copyInfo);
+
+        m_context->getDeviceTable().vkCmdCopyImageToBuffer(m_currentHandle, t_src.getHandle(), static_cast<VkImageLayout>(t_copyInfo.imageLayout), t_dst.getHandle(), 1, &copy);
+    }
+
+    auto CommandBuffer::capturing() const noexcept -> Capture*
+    {
+        auto& capture = m_context->getCapture();
+        return capture.isRecording() ? &capture : nullptr;
     }
 }
\ No newline at end of file
@@ -7,12 +7,13 @@ namespace arln {
     class CommandBuffer
     {
     private:
-        using CommandPoolArray   = std::array<VkCommandPool,   Frame::s_frameCount<u32>>;
-        using CommandBufferArray = std::array<VkCommandBuffer, Frame::s_frameCount<u32>>;
-        using HandlePointer      = VkCommandBuffer*;
+        using CommandBufferSetRef = std::shared_ptr<Frame::CommandBufferSet>;
         friend class Context;
         friend class Frame;
-        explicit CommandBuffer(CommandPoolArray const& t_commandPools) noexcept;
+        friend class RenderGraph;
+        friend class CaptureReplay;
+        CommandBuffer(Context& t_context, CommandBufferSetRef const& t_commandBuffers) noexcept;
+        CommandBuffer(Context& t_context, VkCommandBuffer t_secondaryCommandBuffer) noexcept;
 
     public:
         CommandBuffer() = default;
@@ -22,12 +23,15 @@ namespace arln {
         CommandBuffer& operator=(CommandBuffer&&) = default;
         ~CommandBuffer() = default;
 
-        inline operator auto() const noexcept { return *m_currentHandle; }
+        inline operator auto() const noexcept { return m_currentHandle; }
 
         void begin() noexcept;
+        void beginSecondary(RenderingInfo const& t_renderingInfo) noexcept;
         void end() noexcept;
         void beginRendering(RenderingInfo const& t_renderingInfo) noexcept;
         void endRendering() noexcept;
+        void executeCommands(std::span<const CommandBuffer> t_secondaryCommandBuffers) noexcept;
+        void recordParallel(RenderingInfo const& t_renderingInfo, u32 t_chunkCount, std::function<void(CommandBuffer&, u32)> const& t_function) noexcept;
         void bindGraphicsPipeline(Pipeline& t_pipeline) noexcept;
         void bindComputePipeline(Pipeline& t_pipeline) noexcept;
         void dispatch(u32 t_x, u32 t_y, u32 t_z) noexcept;
@@ -43,15 +47,28 @@ namespace arln {
         void setViewport(f32 t_x, f32 t_y, f32 t_width, f32 t_height) noexcept;
         void setScissor(i32 t_x, i32 t_y, u32 t_width, u32 t_height) noexcept;
         void bindVertexBuffer(Buffer& t_buffer, size_t t_offset = 0, u32 t_firstBinding = 0) noexcept;
+        void bindVertexBuffer(BufferSlice const& t_slice, u32 t_firstBinding = 0) noexcept;
         void bindIndexBuffer16(Buffer& t_buffer, size_t t_offset = 0) noexcept;
+        void bindIndexBuffer16(BufferSlice const& t_slice) noexcept;
         void bindIndexBuffer32(Buffer& t_buffer, size_t t_offset = 0) noexcept;
+        void bindIndexBuffer32(BufferSlice const& t_slice) noexcept;
         void pushConstant(Pipeline& t_pipeline, ShaderStage t_stage, u32 t_size, void const* t_data) noexcept;
-        void bindDescriptorGraphics(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet = 0) noexcept;
-        void bindDescriptorGraphics(Pipeline& t_pipeline, std::vector<std::reference_wrapper<Descriptor>> const& t_descriptors, u32 t_firstSet = 0) noexcept;
-        void bindDescriptorCompute(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet = 0) noexcept;
-        void bindDescriptorCompute(Pipeline& t_pipeline, std::vector<std::reference_wrapper<Descriptor>> const& t_descriptors, u32 t_firstSet = 0) noexcept;
+        void bindDescriptorGraphics(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet = 0, std::span<const u32> t_dynamicOffsets = { }) noexcept;
+        void bindDescriptorGraphics(Pipeline& t_pipeline, std::vector<std::reference_wrapper<Descriptor>> const& t_descriptors, u32 t_firstSet = 0, std::span<const u32> t_dynamicOffsets = { }) noexcept;
+        void bindDescriptorCompute(Pipeline& t_pipeline, Descriptor& t_descriptor, u32 t_firstSet = 0, std::span<const u32> t_dynamicOffsets = { }) noexcept;
+        void bindDescriptorCompute(Pipeline& t_pipeline, std::vector<std::reference_wrapper<Descriptor>> const& t_descriptors, u32 t_firstSet = 0, std::span<const u32> t_dynamicOffsets = { }) noexcept;
         void transitionImages(std::vector<ImageTransitionInfo> const& t_transitionInfos) noexcept;
         void transitionImages(ImageTransitionInfo const& t_transitionInfo) noexcept;
+        void pipelineBarrier(std::span<const ImageTransitionInfo> t_transitionInfos, std::span<const MemoryBarrierInfo> t_memoryBarriers) noexcept;
+
+        // Brings every subresource of the image into the state t_usage needs, using the tracked state of the image.
+        // Barriers are batched until the next command that records work, t_discard drops the current contents
+        void require(Image& t_image, ResourceUsage t_usage, bool t_discard = false) noexcept;
+        void flushBarriers() noexcept;
+
+        // t_statistics adds pipeline statistics on graphics queues, ignored while an outer zone collects them
+        void beginZone(std::string_view t_name, bool t_statistics = false) noexcept;
+        void endZone() noexcept;
         void blitImage(Image& t_src, Image& t_dst, ImageBlit const& t_blit) noexcept;
         void copyImage(Image& t_src, Image& t_dst, ImageCopy const& t_copyInfo) noexcept;
         void copyBuffer(Buffer& t_src, Buffer& t_dst, size_t t_size, size_t t_dstOffset = 0, size_t t_srcOffset = 0) noexcept;
@@ -59,8 +76,15 @@ namespace arln {
         void copyImageToBuffer(Image& t_src, Buffer& t_dst, BufferImageCopy const& t_copyInfo) noexcept;
 
     private:
-        CommandBufferArray m_commandBuffers;
-        HandlePointer      m_currentHandle;
+        void recordBarriers(std::span<const ImageTransitionInfo> t_transitionInfos, std::span<const MemoryBarrierInfo> t_memoryBarriers) noexcept;
+        auto capturing() const noexcept -> Capture*;
+
+        Context*                         m_context           { };
+        CommandBufferSetRef              m_commandBuffers    { };
+        VkCommandBuffer                  m_currentHandle     { };
+        std::vector<ImageTransitionInfo> m_pendingTransitions{ };
+        std::vector<u32>                 m_zones             { };
+        u32                              m_statisticsDepth   { ~0u };
     };
 
 }
\ No newline at end of file
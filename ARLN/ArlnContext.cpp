@@ -4,7 +4,12 @@
 #include "ArlnCommandBuffer.hpp"
 #include <algorithm>
 #include <cstring>
-#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cctype>
+#include <mutex>
+#include <future>
 
 static VkBool32 VKAPI_CALL debugReportCallback(
     VkDebugReportFlagsEXT flags,
@@ -23,16 +28,113 @@ static VkBool32 VKAPI_CALL debugReportCallback(
 
 namespace arln {
 
-    Context* Context::s_currentContext = nullptr;
+    struct PipelineCacheHeader
+    {
+        u32 magic;
+        u32 headerSize;
+        u32 vendorID;
+        u32 deviceID;
+        u32 driverVersion;
+        u8  pipelineCacheUUID[VK_UUID_SIZE];
+        u64 dataSize;
+        u64 dataHash;
+    };
+
+    static constexpr u32 s_pipelineCacheMagic = 0x4E4C5241;
+
+    struct MemoryCapture
+    {
+        Context* context;
+        u64      address;
+    };
+
+    static thread_local MemoryCapture s_memoryCapture{ };
+
+    static VkResult VKAPI_CALL allocateMemory(VkDevice t_device, VkMemoryAllocateInfo const* t_allocateInfo, VkAllocationCallbacks const* t_allocator, VkDeviceMemory* t_memory)
+    {
+        if (!s_memoryCapture.context)
+        {
+            return vkAllocateMemory(t_device, t_allocateInfo, t_allocator, t_memory);
+        }
+
+        // VMA chains its own flags for device address memory, they are extended in place
+        VkMemoryOpaqueCaptureAddressAllocateInfo addressInfo{ VK_STRUCTURE_TYPE_MEMORY_OPAQUE_CAPTURE_ADDRESS_ALLOCATE_INFO };
+        addressInfo.pNext = t_allocateInfo->pNext;
+        addressInfo.opaqueCaptureAddress = s_memoryCapture.address;
+
+        for (auto next = static_cast<VkBaseInStructure const*>(t_allocateInfo->pNext); next; next = next->pNext)
+        {
+            if (next->sType == VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO)
+            {
+                const_cast<VkMemoryAllocateFlagsInfo*>(reinterpret_cast<VkMemoryAllocateFlagsInfo const*>(next))->flags |= VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_CAPTURE_REPLAY_BIT;
+            }
+        }
+
+        VkMemoryAllocateInfo allocateInfo = *t_allocateInfo;
+        allocateInfo.pNext = &addressInfo;
+
+        return s_memoryCapture.context->getDeviceTable().vkAllocateMemory(t_device, &allocateInfo, t_allocator, t_memory);
+    }
+
+    static auto hashBytes(u8 const* t_data, size_t t_size) noexcept -> u64
+    {
+        u64 hash = 0xCBF29CE484222325ull;
+
+        for (size_t i = 0; i < t_size; ++i)
+        {
+            hash = (hash ^ t_data[i]) * 0x100000001B3ull;
+        }
+
+        return hash;
+    }
+
+    static auto readFileBytes(std::string const& t_path) noexcept -> std::vector<u8>
+    {
+        std::vector<u8> data;
+
+        if (t_path.empty())
+        {
+            return data;
+        }
+
+        std::ifstream file(t_path, std::ios::binary | std::ios::ate);
+
+        if (!file.is_open())
+        {
+            return data;
+        }
+
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        if (!file.good())
+        {
+            data.clear();
+        }
+
+        return data;
+    }
+
+    static std::mutex s_loaderMutex;
 
     void Context::beginFrame() noexcept
     {
         m_frame.beginFrame();
+        updateMemoryBudget();
+    }
+
+    auto Context::endFrame(std::vector<CommandBufferHandle> const& t_commandBuffers) noexcept -> GpuFuture
+    {
+        return m_frame.endFrame(t_commandBuffers, { }, PipelineStageBits::eNone);
     }
 
-    void Context::endFrame(std::vector<CommandBufferHandle> const& t_commandBuffers) noexcept
+    auto Context::endFrame(
+        std::vector<CommandBufferHandle> const& t_commandBuffers,
+        std::vector<CommandBufferHandle> const& t_computeCommandBuffers,
+        PipelineStage t_computeWaitStage) noexcept -> GpuFuture
     {
-        m_frame.endFrame(t_commandBuffers);
+        return m_frame.endFrame(t_commandBuffers, t_computeCommandBuffers, t_computeWaitStage);
     }
 
     auto Context::canRender() noexcept -> bool
@@ -50,10 +152,48 @@ namespace arln {
         m_resizeCallback = t_function;
     }
 
-    void Context::immediateSubmit(std::function<void(VkCommandBuffer)>&& t_function) noexcept
+    void Context::setMemoryPressureCallback(std::function<void(MemoryPressure const&)> const& t_function, f32 t_threshold) noexcept
+    {
+        std::scoped_lock lock(m_callbackMutex);
+        m_memoryPressureCallback = t_function;
+        m_memoryPressureThreshold = t_threshold;
+    }
+
+    void Context::relieveMemoryPressure(u32 t_memoryTypeIndex) noexcept
     {
-        vkResetFences(m_device, 1, &m_immediateFence);
-        vkResetCommandPool(m_device, m_immediateCommandPool, 0);
+        VkPhysicalDeviceMemoryProperties const* memoryProperties;
+        vmaGetMemoryProperties(m_allocator, &memoryProperties);
+
+        if (t_memoryTypeIndex < memoryProperties->memoryTypeCount)
+        {
+            u32 const heapIndex = memoryProperties->memoryTypes[t_memoryTypeIndex].heapIndex;
+
+            VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+            vmaGetHeapBudgets(m_allocator, budgets);
+
+            std::scoped_lock lock(m_callbackMutex);
+
+            if (m_memoryPressureCallback)
+            {
+                m_memoryPressureCallback(MemoryPressure{
+                    .heapIndex = heapIndex,
+                    .usage = budgets[heapIndex].usage,
+                    .budget = budgets[heapIndex].budget,
+                    .allocationFailed = true
+                });
+            }
+        }
+
+        // The present queue is left alone, it belongs to the thread that presents
+        m_graphicsTimeline.waitIdle();
+        m_computeTimeline.waitIdle();
+        m_uploadEngine.getTimeline().waitIdle();
+        m_deletionQueue.collect();
+    }
+
+    auto Context::immediateSubmit(std::function<void(VkCommandBuffer)>&& t_function) noexcept -> GpuFuture
+    {
+        m_deviceTable.vkResetCommandPool(m_device, m_immediateCommandPool, 0);
 
         VkCommandBufferBeginInfo beginInfo;
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -62,22 +202,71 @@ namespace arln {
         beginInfo.pNext = nullptr;
         beginInfo.flags = 0;
 
-        vkBeginCommandBuffer(m_immediateCommandBuffer, &beginInfo);
+        m_uploadEngine.flush();
+
+        m_deviceTable.vkBeginCommandBuffer(m_immediateCommandBuffer, &beginInfo);
         {
+            m_uploadEngine.recordAcquireBarriers(m_immediateCommandBuffer);
             t_function(m_immediateCommandBuffer);
         }
-        vkEndCommandBuffer(m_immediateCommandBuffer);
+        m_deviceTable.vkEndCommandBuffer(m_immediateCommandBuffer);
+
+        // Taken after recording, so it covers every batch whose acquires were recorded
+        auto uploadFuture = m_uploadEngine.getFuture();
+
+        VkCommandBufferSubmitInfo commandBufferInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+        commandBufferInfo.commandBuffer = m_immediateCommandBuffer;
 
-        VkSubmitInfo submitInfo { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &m_immediateCommandBuffer;
+        auto waitInfo = uploadFuture.getSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
 
-        vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_immediateFence);
-        vkWaitForFences(m_device, 1, &m_immediateFence, false, UINT64_MAX);
+        VkSubmitInfo2 submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+        submitInfo.waitSemaphoreInfoCount = uploadFuture.isReady() ? 0 : 1;
+        submitInfo.pWaitSemaphoreInfos = &waitInfo;
+        submitInfo.commandBufferInfoCount = 1;
+        submitInfo.pCommandBufferInfos = &commandBufferInfo;
+
+        auto future = m_graphicsTimeline.submit(m_graphicsQueue, submitInfo, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+        if (!future.isValid())
+        {
+            m_errorCallback("Failed to submit immediate command buffer");
+        }
+
+        future.wait();
+
+        return future;
+    }
+
+    void Context::waitIdle() noexcept
+    {
+        m_graphicsTimeline.waitIdle();
+        m_computeTimeline.waitIdle();
+        m_uploadEngine.getTimeline().waitIdle();
+
+        if (!m_headless && m_presentQueue)
+        {
+            std::scoped_lock lock(m_queueMutex);
+            m_deviceTable.vkQueueWaitIdle(m_presentQueue);
+        }
+    }
+
+    void Context::setFramesInFlight(u32 t_frameCount) noexcept
+    {
+        m_frame.resize(t_frameCount);
+    }
+
+    void Context::setLatencyMode(LatencyMode t_mode, f64 t_frameRateLimit) noexcept
+    {
+        m_frame.setLatencyMode(t_mode, t_frameRateLimit);
     }
 
     auto Context::isPresentModeSupported(PresentMode t_presentMode) noexcept -> bool
     {
+        if (m_headless)
+        {
+            return false;
+        }
+
         u32 modeCount;
         vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &modeCount, nullptr);
         std::vector<VkPresentModeKHR> presentModes(modeCount);
@@ -91,59 +280,160 @@ namespace arln {
 
     auto Context::allocateCommandBuffer() noexcept -> CommandBuffer
     {
-        return m_frame.allocateCommandBuffers();
+        return m_frame.allocateCommandBuffers(m_queueFamilyIndex);
+    }
+
+    auto Context::allocateComputeCommandBuffer() noexcept -> CommandBuffer
+    {
+        return m_frame.allocateCommandBuffers(m_computeFamilyIndex);
+    }
+
+    auto Context::allocateSecondaryCommandBuffer() noexcept -> CommandBuffer
+    {
+        return m_frame.allocateSecondaryCommandBuffer(m_queueFamilyIndex);
+    }
+
+    auto Context::readbackBuffer(Buffer& t_buffer, size_t t_size, size_t t_offset) noexcept -> Readback
+    {
+        return m_frame.readbackBuffer(t_buffer, t_size, t_offset);
+    }
+
+    auto Context::readbackImage(Image& t_image, BufferImageCopy const& t_copyInfo, size_t t_size) noexcept -> Readback
+    {
+        return m_frame.readbackImage(t_image, t_copyInfo, t_size);
     }
 
     auto Context::createGraphicsPipeline(GraphicsPipelineInfo const& t_pipelineInfo) noexcept -> Pipeline
     {
-        return Pipeline(t_pipelineInfo);
+        auto start = std::chrono::steady_clock::now();
+        auto pipeline = Pipeline(*this, t_pipelineInfo);
+        auto milliseconds = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        m_infoCallback("Created graphics pipeline in " + std::to_string(milliseconds) + "ms");
+
+        return pipeline;
     }
 
     auto Context::createComputePipeline(ComputePipelineInfo const& t_pipelineInfo) noexcept -> Pipeline
     {
-        return Pipeline(t_pipelineInfo);
+        auto start = std::chrono::steady_clock::now();
+        auto pipeline = Pipeline(*this, t_pipelineInfo);
+        auto milliseconds = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        m_infoCallback("Created compute pipeline in " + std::to_string(milliseconds) + "ms");
+
+        return pipeline;
+    }
+
+    void Context::setMemoryCaptureAddress(Context* t_context, u64 t_address) noexcept
+    {
+        s_memoryCapture = { t_context, t_address };
     }
 
     auto Context::allocateBuffer(BufferUsage t_bufferUsage, MemoryType t_memoryType, size_t t_sizeInBytes) noexcept -> Buffer
     {
-        return { t_bufferUsage, t_memoryType, t_sizeInBytes };
+        return { *this, t_bufferUsage, t_memoryType, t_sizeInBytes };
     }
 
     auto Context::allocateImage(u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept -> Image
     {
-        return { t_width, t_height, t_format, t_usage, t_memoryType };
+        return { *this, t_width, t_height, t_format, t_usage, t_memoryType };
     }
 
     auto Context::createDescriptorPool() noexcept -> DescriptorPool
     {
-        return { {} };
+        return DescriptorPool{ *this };
     }
 
     auto Context::createSampler(SamplerOptions const& t_options) noexcept -> Sampler
     {
-        return Sampler{ t_options };
+        return Sampler{ *this, t_options };
+    }
+
+    auto Context::createRenderGraph() noexcept -> RenderGraph
+    {
+        return RenderGraph{ *this };
+    }
+
+    auto Context::createTransientAllocator() noexcept -> TransientAllocator
+    {
+        return TransientAllocator{ *this };
+    }
+
+    auto Context::createBufferAllocator(BufferUsage t_usage, MemoryType t_memoryType, size_t t_blockSize) noexcept -> BufferAllocator
+    {
+        return BufferAllocator{ *this, t_usage, t_memoryType, t_blockSize };
     }
 
     Context::Context(ContextCreateInfo const& t_createInfo) noexcept
         : m_surfacePresentMode{ t_createInfo.presentMode }
         , m_deviceExtensions{ t_createInfo.deviceExtensions }
+        , m_pipelineCachePath{ t_createInfo.pipelineCachePath }
         , m_getWidthFunc{ t_createInfo.getWindowWidthFunc }
         , m_getHeightFunc{ t_createInfo.getWindowHeightFunc }
         , m_resizeCallback{ [](i32, i32){} }
-        , m_infoCallback{ t_createInfo.infoCallback }
-        , m_errorCallback{ t_createInfo.errorCallback }
+        , m_infoCallback{ [this, callback = t_createInfo.infoCallback](std::string_view t_info) {
+            std::scoped_lock lock(m_callbackMutex);
+            callback(t_info);
+        } }
+        , m_errorCallback{ [this, callback = t_createInfo.errorCallback](std::string_view t_error) {
+            std::scoped_lock lock(m_callbackMutex);
+            callback(t_error);
+        } }
+        , m_headlessImageCount{ std::max(t_createInfo.headlessImageCount, 1u) }
+        , m_headlessExtent{ t_createInfo.headlessExtent }
+        , m_headless{ t_createInfo.headless || !t_createInfo.surfaceCreation }
     {
-        SetCurrentContext(*this);
+        if (!m_getWidthFunc)  m_getWidthFunc  = [this]{ return m_headlessExtent.x; };
+        if (!m_getHeightFunc) m_getHeightFunc = [this]{ return m_headlessExtent.y; };
+
+        m_deletionQueue.create(*this);
+        m_workerPool.create(t_createInfo.workerThreadCount);
 
-        if (volkInitialize() != VK_SUCCESS)
+        // Steps that do not depend on each other run on worker threads, window and surface
+        // creation stay on the calling thread since windowing systems usually require it.
+        auto const startupBegin = std::chrono::steady_clock::now();
+        auto const callerThread = std::this_thread::get_id();
+        auto const launchPolicy = t_createInfo.parallelStartup ? std::launch::async : std::launch::deferred;
+        std::mutex reportMutex;
+
+        auto measure = [&](std::string_view t_name, auto&& t_function)
         {
-            m_errorCallback("Vulkan functions loading failed");
-        }
+            auto start = std::chrono::steady_clock::now();
+            t_function();
+            auto end = std::chrono::steady_clock::now();
+
+            std::scoped_lock lock(reportMutex);
+            m_startupReport.phases.push_back({
+                std::string(t_name),
+                std::chrono::duration<f64, std::milli>(start - startupBegin).count(),
+                std::chrono::duration<f64, std::milli>(end - start).count(),
+                std::this_thread::get_id() != callerThread
+            });
+        };
 
-        if (volkGetInstanceVersion() < VK_API_VERSION_1_3)
+        auto pipelineCacheFile = std::async(launchPolicy, [&]
         {
-            m_errorCallback("Vulkan 1.3 not supported");
-        }
+            std::vector<u8> data;
+            measure("Pipeline cache read", [&]{ data = readFileBytes(m_pipelineCachePath); });
+
+            return data;
+        });
+
+        std::unique_lock loaderLock(s_loaderMutex);
+
+        measure("Vulkan loader", [&]
+        {
+            if (volkInitialize() != VK_SUCCESS)
+            {
+                m_errorCallback("Vulkan functions loading failed");
+            }
+
+            if (volkGetInstanceVersion() < VK_API_VERSION_1_3)
+            {
+                m_errorCallback("Vulkan 1.3 not supported");
+            }
+        });
 
         std::vector<const char*> layers     = t_createInfo.layers;
         std::vector<const char*> extensions = t_createInfo.extensions;
@@ -193,14 +483,22 @@ namespace arln {
             instanceCreateInfo.pNext = &validationFeatures;
         }
 
-        checkLayersSupport(layers);
-        checkExtensionsSupport(extensions);
+        auto layersCheck = std::async(launchPolicy, [&]
+        {
+            measure("Instance layers check", [&]{ checkLayersSupport(layers); });
+        });
+        measure("Instance extensions check", [&]{ checkExtensionsSupport(extensions); });
+        layersCheck.get();
 
-        if (vkCreateInstance(&instanceCreateInfo, nullptr, &m_instance) != VK_SUCCESS)
+        measure("Instance creation", [&]
         {
-            m_errorCallback("Failed to create vulkan instance");
-        }
-        volkLoadInstance(m_instance);
+            if (vkCreateInstance(&instanceCreateInfo, nullptr, &m_instance) != VK_SUCCESS)
+            {
+                m_errorCallback("Failed to create vulkan instance");
+            }
+            volkLoadInstance(m_instance);
+        });
+        loaderLock.unlock();
 
         if (useValidation)
         {
@@ -218,18 +516,33 @@ namespace arln {
 
         m_infoCallback("Created vulkan instance");
 
-        m_surface = t_createInfo.surfaceCreation(m_instance);
-
-        if (!m_surface)
+        if (m_headless)
         {
-            m_errorCallback("Failed to create vulkan surface");
+            m_infoCallback("Running in headless mode, surface creation skipped");
         }
+        else
+        {
+            measure("Surface creation", [&]{ m_surface = t_createInfo.surfaceCreation(m_instance); });
 
-        this->selectPhysicalDevice();
+            if (!m_surface)
+            {
+                m_errorCallback("Failed to create vulkan surface");
+            }
+        }
 
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &m_surfaceCapabilities);
+        measure("Physical device selection", [&]
+        {
+            this->selectPhysicalDevice(t_createInfo);
+            this->selectQueues();
+        });
 
         m_infoCallback(std::string("Selected queue family index: " + std::to_string(m_queueFamilyIndex)));
+        m_infoCallback(std::string("Selected compute queue family index: " + std::to_string(m_computeFamilyIndex))
+            + std::string(", queue index: ") + std::to_string(m_computeQueueIndex)
+        );
+        m_infoCallback(std::string("Selected transfer queue family index: " + std::to_string(m_transferFamilyIndex))
+            + std::string(", queue index: ") + std::to_string(m_transferQueueIndex)
+        );
         m_infoCallback(std::string("Selected physical device: ") + m_physicalDeviceProperties.properties.deviceName);
         m_infoCallback(std::string("API Version: ")
             + std::to_string(m_physicalDeviceProperties.properties.apiVersion >> 22u) + std::string(".")
@@ -242,100 +555,79 @@ namespace arln {
             + std::to_string(m_physicalDeviceProperties.properties.driverVersion & 0xFFFU)
         );
 
-        this->createLogicalDevice();
-        this->createAllocator();
+        // Surface queries may call into the windowing system, the device is created on the worker instead
+        auto deviceCreation = std::async(launchPolicy, [&]
+        {
+            measure("Logical device creation", [&]{ this->createLogicalDevice(); });
+            measure("Memory allocator creation", [&]{ this->createAllocator(); });
+        });
 
-        vkGetDeviceQueue(m_device, m_queueFamilyIndex, 0, &m_graphicsQueue);
-        vkGetDeviceQueue(m_device, m_queueFamilyIndex, 0, &m_presentQueue);
+        measure("Surface queries", [&]{ this->querySurfaceSupport(); });
+        deviceCreation.get();
 
-        VkCommandPoolCreateInfo commandPoolCreateInfo;
-        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        commandPoolCreateInfo.pNext = nullptr;
-        commandPoolCreateInfo.flags = 0;
-        commandPoolCreateInfo.queueFamilyIndex = m_queueFamilyIndex;
+        auto pipelineCacheData = pipelineCacheFile.get();
+        measure("Pipeline cache creation", [&]{ this->createPipelineCache(pipelineCacheData); });
 
-        if (vkCreateCommandPool(m_device, &commandPoolCreateInfo, nullptr, &m_immediateCommandPool) != VK_SUCCESS)
-        {
-            m_errorCallback("Failed to create vulkan command pool");
-        }
-
-        VkCommandBufferAllocateInfo commandBufferAllocateInfo;
-        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        commandBufferAllocateInfo.pNext = nullptr;
-        commandBufferAllocateInfo.commandBufferCount = 1;
-        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        commandBufferAllocateInfo.commandPool = m_immediateCommandPool;
+        m_deviceTable.vkGetDeviceQueue(m_device, m_queueFamilyIndex, 0, &m_graphicsQueue);
+        m_deviceTable.vkGetDeviceQueue(m_device, m_queueFamilyIndex, 0, &m_presentQueue);
+        m_deviceTable.vkGetDeviceQueue(m_device, m_computeFamilyIndex, m_computeQueueIndex, &m_computeQueue);
+        m_deviceTable.vkGetDeviceQueue(m_device, m_transferFamilyIndex, m_transferQueueIndex, &m_transferQueue);
 
-        if (vkAllocateCommandBuffers(m_device, &commandBufferAllocateInfo, &m_immediateCommandBuffer) != VK_SUCCESS)
+        auto submissionResources = std::async(launchPolicy, [&]
         {
-            m_errorCallback("Failed to create vulkan command buffer");
-        }
+            measure("Submission resources creation", [&]
+            {
+                this->createImmediateCommandBuffer();
+                m_graphicsTimeline.create(*this);
+                m_computeTimeline.create(*this);
+                m_uploadEngine.create(*this);
+            });
+        });
 
-        VkFenceCreateInfo fenceCreateInfo;
-        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceCreateInfo.pNext = nullptr;
-        fenceCreateInfo.flags = 0;
+        measure("Swapchain creation", [&]{ m_swapchain.create(*this); });
+        measure("Frame resources creation", [&]{ m_frame.create(*this, t_createInfo.framesInFlight, t_createInfo.frameUploadArenaSize, t_createInfo.frameUniformRingSize, t_createInfo.frameReadbackArenaSize, t_createInfo.gpuZoneCapacity); });
+        m_frame.setLatencyMode(t_createInfo.latencyMode, t_createInfo.frameRateLimit);
+        submissionResources.get();
 
-        if (vkCreateFence(m_device, &fenceCreateInfo, nullptr, &m_immediateFence) != VK_SUCCESS)
+        // Created last so the internal staging and arena buffers are not part of the capture
+        if (!t_createInfo.capturePath.empty())
         {
-            m_errorCallback("Failed to create vulkan fence");
+            m_capture.create(*this, t_createInfo.capturePath, t_createInfo.captureFirstFrame, t_createInfo.captureFrameCount);
         }
 
-        auto surfaceFormat = [&]()
+        // Moves change buffer handles under the capture, the two are not combined
+        if (t_createInfo.defragmentationBytesPerFrame && !m_capture.isEnabled())
         {
-            uint32_t count;
-            vkGetPhysicalDeviceSurfaceFormatsKHR(CurrentContext()->getPhysicalDevice(), CurrentContext()->getSurface(), &count, nullptr);
-            std::vector<VkSurfaceFormatKHR> availableFormats(count);
-            vkGetPhysicalDeviceSurfaceFormatsKHR(CurrentContext()->getPhysicalDevice(), CurrentContext()->getSurface(), &count, availableFormats.data());
-
-            if (availableFormats.size() == 1 && availableFormats[0].format == VK_FORMAT_UNDEFINED)
-            {
-                m_colorFormat = Format::eR8G8B8A8Unorm;
-                return VkSurfaceFormatKHR{ VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
-            }
-            for (const auto& currentFormat : availableFormats)
-            {
-                if (currentFormat.format == VK_FORMAT_R8G8B8A8_UNORM && currentFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
-                {
-                    m_colorFormat = Format::eR8G8B8A8Unorm;
-                    return currentFormat;
-                }
-            }
-            for (const auto& currentFormat : availableFormats)
-            {
-                if (currentFormat.format == VK_FORMAT_B8G8R8A8_UNORM && currentFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
-                {
-                    m_colorFormat = Format::eB8G8R8A8Unorm;
-                    return currentFormat;
-                }
-            }
-            return availableFormats[0];
-        }();
+            m_defragmenter.create(*this, t_createInfo.defragmentationBytesPerFrame);
+        }
 
-        m_colorFormat = static_cast<Format>(surfaceFormat.format);
-        m_depthFormat = findSupportedFormat({
-            Format::eD16Unorm, Format::eD32Sfloat, Format::eD32SfloatS8Uint, Format::eD24UnormS8Uint
-            },
-            ImageTiling::eOptimal,
-            FormatFeaturesBits::eDepthStencilAttachment
-        );
-        m_swapchain.create();
-        m_frame.create();
+        m_startupReport.totalMilliseconds = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+        this->reportStartup();
 
         m_infoCallback("Created vulkan context");
     }
 
     Context::~Context() noexcept
     {
-        vkDeviceWaitIdle(m_device);
+        waitIdle();
+
+        m_capture.teardown();
+        m_defragmenter.teardown();
+        m_workerPool.teardown();
 
+        m_uploadEngine.teardown();
         m_swapchain.teardown();
         m_frame.teardown();
+        m_deletionQueue.teardown();
+        m_computeTimeline.teardown();
+        m_graphicsTimeline.teardown();
+
+        savePipelineCache();
 
         if (m_allocator)               vmaDestroyAllocator(m_allocator);
-        if (m_immediateFence)          vkDestroyFence(m_device, m_immediateFence, nullptr);
-        if (m_immediateCommandPool)    vkDestroyCommandPool(m_device, m_immediateCommandPool, nullptr);
-        if (m_device)                  vkDestroyDevice(m_device, nullptr);
+        if (m_pipelineCache)           m_deviceTable.vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        if (m_immediateCommandPool)    m_deviceTable.vkDestroyCommandPool(m_device, m_immediateCommandPool, nullptr);
+        if (m_device)                  m_deviceTable.vkDestroyDevice(m_device, nullptr);
         if (m_surface)                 vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
         if (m_debugCallback)           vkDestroyDebugReportCallbackEXT(m_instance, m_debugCallback, nullptr);
         if (m_instance)                vkDestroyInstance(m_instance, nullptr);
@@ -343,6 +635,63 @@ namespace arln {
         m_infoCallback("Destroyed vulkan context");
     }
 
+    void Context::savePipelineCache() noexcept
+    {
+        if (!m_pipelineCache || m_pipelineCachePath.empty())
+        {
+            return;
+        }
+
+        size_t dataSize;
+        m_deviceTable.vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr);
+        std::vector<u8> data(dataSize);
+        m_deviceTable.vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data());
+
+        auto& properties = m_physicalDeviceProperties.properties;
+
+        PipelineCacheHeader header;
+        header.magic = s_pipelineCacheMagic;
+        header.headerSize = sizeof(PipelineCacheHeader);
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        header.driverVersion = properties.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        header.dataSize = dataSize;
+        header.dataHash = hashBytes(data.data(), dataSize);
+
+        std::string temporaryPath = m_pipelineCachePath + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+
+            if (!file.is_open())
+            {
+                m_infoCallback("Failed to open pipeline cache for writing: " + temporaryPath);
+                return;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(dataSize));
+
+            if (!file.good())
+            {
+                m_infoCallback("Failed to write pipeline cache: " + temporaryPath);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, m_pipelineCachePath, error);
+
+        if (error)
+        {
+            m_infoCallback("Failed to replace pipeline cache: " + error.message());
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+
+        m_infoCallback("Saved pipeline cache: " + m_pipelineCachePath + " (" + std::to_string(dataSize) + " bytes)");
+    }
+
     void Context::checkLayersSupport(std::span<const char*> t_layerNames) noexcept
     {
         m_infoCallback("Enumerating instance layers:");
@@ -406,8 +755,11 @@ namespace arln {
 
         for (u32 i = 0; i < propertyCount; ++i)
         {
-            VkBool32 supported;
-            vkGetPhysicalDeviceSurfaceSupportKHR(t_physicalDevice, i, m_surface, &supported);
+            VkBool32 supported = true;
+            if (m_surface)
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(t_physicalDevice, i, m_surface, &supported);
+            }
 
             if (properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT &&
                 properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT &&
@@ -420,7 +772,63 @@ namespace arln {
         return ~0u;
     }
 
-    void Context::selectPhysicalDevice() noexcept
+    void Context::selectQueues() noexcept
+    {
+        u32 propertyCount;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &propertyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> properties(propertyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &propertyCount, properties.data());
+
+        u32 graphicsQueueCount = 1;
+
+        m_computeFamilyIndex = m_queueFamilyIndex;
+        m_computeQueueIndex = 0;
+
+        for (u32 i = 0; i < propertyCount; ++i)
+        {
+            if (properties[i].queueFlags & VK_QUEUE_COMPUTE_BIT &&
+                !(properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                m_computeFamilyIndex = i;
+                break;
+            }
+        }
+
+        if (m_computeFamilyIndex == m_queueFamilyIndex && properties[m_queueFamilyIndex].queueCount > graphicsQueueCount)
+        {
+            m_computeQueueIndex = graphicsQueueCount++;
+        }
+
+        m_transferFamilyIndex = m_queueFamilyIndex;
+        m_transferQueueIndex = 0;
+
+        for (u32 i = 0; i < propertyCount; ++i)
+        {
+            if (properties[i].queueFlags & VK_QUEUE_TRANSFER_BIT &&
+                !(properties[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+            {
+                m_transferFamilyIndex = i;
+                break;
+            }
+        }
+
+        if (m_transferFamilyIndex == m_queueFamilyIndex && properties[m_queueFamilyIndex].queueCount > graphicsQueueCount)
+        {
+            m_transferQueueIndex = graphicsQueueCount++;
+        }
+
+        m_queueFamilyIndices = { m_queueFamilyIndex };
+
+        for (u32 familyIndex : { m_computeFamilyIndex, m_transferFamilyIndex })
+        {
+            if (std::ranges::find(m_queueFamilyIndices, familyIndex) == m_queueFamilyIndices.end())
+            {
+                m_queueFamilyIndices.emplace_back(familyIndex);
+            }
+        }
+    }
+
+    void Context::selectPhysicalDevice(ContextCreateInfo const& t_createInfo) noexcept
     {
         u32 physicalDeviceCount;
         vkEnumeratePhysicalDevices(m_instance, &physicalDeviceCount, nullptr);
@@ -432,38 +840,209 @@ namespace arln {
             m_errorCallback("No suitable physical devices");
         }
 
-        for (auto const& gpu : physicalDevices)
+        auto toHex = [](u8 const* t_bytes, size_t t_size)
+        {
+            constexpr char digits[] = "0123456789abcdef";
+            std::string hex;
+
+            for (size_t i = 0; i < t_size; ++i)
+            {
+                hex += digits[t_bytes[i] >> 4];
+                hex += digits[t_bytes[i] & 0xF];
+            }
+
+            return hex;
+        };
+
+        auto toLower = [](std::string t_string)
+        {
+            std::ranges::transform(t_string, t_string.begin(), [](unsigned char t_c){ return static_cast<char>(std::tolower(t_c)); });
+            std::erase(t_string, '-');
+
+            return t_string;
+        };
+
+        bool hasOverride = !t_createInfo.physicalDeviceName.empty() || !t_createInfo.physicalDeviceUUID.empty() || t_createInfo.physicalDeviceIndex >= 0;
+        i64  bestScore   = -1;
+        bool bestForced  = false;
+
+        for (u32 index = 0; index < physicalDeviceCount; ++index)
         {
+            auto gpu = physicalDevices[index];
+
+            VkPhysicalDeviceVulkan11Properties gpuIdProperties{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES };
             VkPhysicalDeviceProperties2 gpuProperties{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+            gpuProperties.pNext = &gpuIdProperties;
+            VkPhysicalDeviceVulkan11Features gpuFeatures11{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
+            VkPhysicalDeviceVulkan12Features gpuFeatures12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+            gpuFeatures12.pNext = &gpuFeatures11;
+            VkPhysicalDeviceVulkan13Features gpuFeatures13{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+            gpuFeatures13.pNext = &gpuFeatures12;
             VkPhysicalDeviceFeatures2 gpuFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
-            u32 queueFamilyIndex;
+            gpuFeatures.pNext = &gpuFeatures13;
+            VkPhysicalDeviceMemoryProperties memoryProperties;
 
             vkGetPhysicalDeviceProperties2(gpu, &gpuProperties);
             vkGetPhysicalDeviceFeatures2(gpu, &gpuFeatures);
+            vkGetPhysicalDeviceMemoryProperties(gpu, &memoryProperties);
+            gpuProperties.pNext = nullptr;
+            gpuFeatures.pNext = nullptr;
+
+            std::string deviceName = gpuProperties.properties.deviceName;
+            std::string deviceUUID = toHex(gpuIdProperties.deviceUUID, VK_UUID_SIZE);
+            std::string prefix     = "[" + std::to_string(index) + "] " + deviceName + " (" + deviceUUID + ")";
 
             if (gpuProperties.properties.apiVersion < VK_API_VERSION_1_3)
             {
-                m_infoCallback(gpuProperties.properties.deviceName + std::string(": does not support Vulkan 1.3. Searching for another device"));
+                m_infoCallback(prefix + ": rejected, does not support Vulkan 1.3");
                 continue;
             }
 
-            if (gpuFeatures.features.geometryShader == false)
+            u32 queueFamilyIndex = findQueueFamily(gpu);
+            if (~0u == queueFamilyIndex)
             {
-                m_infoCallback(gpuProperties.properties.deviceName + std::string(": does not support geometry shader. Searching for another device"));
+                m_infoCallback(prefix + ": rejected, can not find sufficient queue family index");
                 continue;
             }
 
-            queueFamilyIndex = findQueueFamily(gpu);
-            if (~0u == queueFamilyIndex)
+            auto& features = gpuFeatures.features;
+
+            // Everything createLogicalDevice enables unconditionally
+            std::pair<VkBool32, char const*> const requiredFeatures[] = {
+                { features.fillModeNonSolid,                                        "fillModeNonSolid"                                   },
+                { features.wideLines,                                               "wideLines"                                          },
+                { features.depthClamp,                                              "depthClamp"                                         },
+                { features.multiDrawIndirect,                                       "multiDrawIndirect"                                  },
+                { features.shaderInt16,                                             "shaderInt16"                                        },
+                { features.shaderInt64,                                             "shaderInt64"                                        },
+                { features.pipelineStatisticsQuery,                                 "pipelineStatisticsQuery"                            },
+                { features.samplerAnisotropy,                                       "samplerAnisotropy"                                  },
+                { features.sampleRateShading,                                       "sampleRateShading"                                  },
+                { gpuFeatures11.shaderDrawParameters,                               "shaderDrawParameters"                               },
+                { gpuFeatures11.multiview,                                          "multiview"                                          },
+                { gpuFeatures11.storageBuffer16BitAccess,                           "storageBuffer16BitAccess"                           },
+                { gpuFeatures12.runtimeDescriptorArray,                             "runtimeDescriptorArray"                             },
+                { gpuFeatures12.descriptorBindingVariableDescriptorCount,           "descriptorBindingVariableDescriptorCount"           },
+                { gpuFeatures12.descriptorBindingPartiallyBound,                    "descriptorBindingPartiallyBound"                    },
+                { gpuFeatures12.shaderUniformTexelBufferArrayDynamicIndexing,       "shaderUniformTexelBufferArrayDynamicIndexing"       },
+                { gpuFeatures12.shaderStorageTexelBufferArrayDynamicIndexing,       "shaderStorageTexelBufferArrayDynamicIndexing"       },
+                { gpuFeatures12.shaderUniformBufferArrayNonUniformIndexing,         "shaderUniformBufferArrayNonUniformIndexing"         },
+                { gpuFeatures12.shaderSampledImageArrayNonUniformIndexing,          "shaderSampledImageArrayNonUniformIndexing"          },
+                { gpuFeatures12.shaderStorageBufferArrayNonUniformIndexing,         "shaderStorageBufferArrayNonUniformIndexing"         },
+                { gpuFeatures12.shaderStorageImageArrayNonUniformIndexing,          "shaderStorageImageArrayNonUniformIndexing"          },
+                { gpuFeatures12.shaderUniformTexelBufferArrayNonUniformIndexing,    "shaderUniformTexelBufferArrayNonUniformIndexing"    },
+                { gpuFeatures12.shaderStorageTexelBufferArrayNonUniformIndexing,    "shaderStorageTexelBufferArrayNonUniformIndexing"    },
+                { gpuFeatures12.descriptorBindingSampledImageUpdateAfterBind,       "descriptorBindingSampledImageUpdateAfterBind"       },
+                { gpuFeatures12.descriptorBindingStorageImageUpdateAfterBind,       "descriptorBindingStorageImageUpdateAfterBind"       },
+                { gpuFeatures12.descriptorBindingStorageBufferUpdateAfterBind,      "descriptorBindingStorageBufferUpdateAfterBind"      },
+                { gpuFeatures12.descriptorBindingUniformTexelBufferUpdateAfterBind, "descriptorBindingUniformTexelBufferUpdateAfterBind" },
+                { gpuFeatures12.descriptorBindingStorageTexelBufferUpdateAfterBind, "descriptorBindingStorageTexelBufferUpdateAfterBind" },
+                { gpuFeatures12.drawIndirectCount,                                  "drawIndirectCount"                                  },
+                { gpuFeatures12.storageBuffer8BitAccess,                            "storageBuffer8BitAccess"                            },
+                { gpuFeatures12.uniformAndStorageBuffer8BitAccess,                  "uniformAndStorageBuffer8BitAccess"                  },
+                { gpuFeatures12.shaderInt8,                                         "shaderInt8"                                         },
+                { gpuFeatures12.samplerFilterMinmax,                                "samplerFilterMinmax"                                },
+                { gpuFeatures12.scalarBlockLayout,                                  "scalarBlockLayout"                                  },
+                { gpuFeatures12.bufferDeviceAddress,                                "bufferDeviceAddress"                                },
+                { gpuFeatures12.timelineSemaphore,                                  "timelineSemaphore"                                  },
+                { gpuFeatures12.hostQueryReset,                                     "hostQueryReset"                                     },
+                { gpuFeatures13.synchronization2,                                   "synchronization2"                                   },
+                { gpuFeatures13.dynamicRendering,                                   "dynamicRendering"                                   },
+                { gpuFeatures13.maintenance4,                                       "maintenance4"                                       }
+            };
+
+            auto missingFeature = std::ranges::find_if(requiredFeatures, [](auto const& t_feature){ return !t_feature.first; });
+            if (missingFeature != std::end(requiredFeatures))
             {
-                m_infoCallback(gpuProperties.properties.deviceName + std::string(": can not find sufficient queue family index. Searching for another device"));
+                m_infoCallback(prefix + ": rejected, does not support " + missingFeature->second);
                 continue;
             }
 
-            m_physicalDevice = gpu;
-            m_physicalDeviceProperties = gpuProperties;
-            m_physicalDeviceFeatures = gpuFeatures;
-            m_queueFamilyIndex = queueFamilyIndex;
+            i64 typeScore = 0;
+            switch (gpuProperties.properties.deviceType)
+            {
+                case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   typeScore = 100000; break;
+                case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: typeScore = 50000;  break;
+                case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    typeScore = 20000;  break;
+                case VK_PHYSICAL_DEVICE_TYPE_CPU:            typeScore = 1000;   break;
+                default:                                     typeScore = 5000;   break;
+            }
+
+            u64 deviceLocalBytes = 0;
+            for (u32 i = 0; i < memoryProperties.memoryHeapCount; ++i)
+            {
+                if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+                {
+                    deviceLocalBytes += memoryProperties.memoryHeaps[i].size;
+                }
+            }
+            i64 memoryScore = static_cast<i64>(std::min<u64>(deviceLocalBytes >> 20, 32768) / 16);
+
+            u32 propertyCount;
+            vkGetPhysicalDeviceQueueFamilyProperties(gpu, &propertyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> queueProperties(propertyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(gpu, &propertyCount, queueProperties.data());
+
+            i64 queueScore = 0;
+            for (auto const& family : queueProperties)
+            {
+                if (family.queueFlags & VK_QUEUE_COMPUTE_BIT && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                {
+                    queueScore += 1000;
+                }
+                else if (family.queueFlags & VK_QUEUE_TRANSFER_BIT && !(family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+                {
+                    queueScore += 1000;
+                }
+            }
+            queueScore = std::min<i64>(queueScore, 2000);
+
+            i64 featureScore = 0;
+            featureScore += features.geometryShader ? 500 : 0;
+
+            u32 extensionCount;
+            vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, nullptr);
+            std::vector<VkExtensionProperties> extensionProperties(extensionCount);
+            vkEnumerateDeviceExtensionProperties(gpu, nullptr, &extensionCount, extensionProperties.data());
+
+            if (std::ranges::any_of(extensionProperties, [](auto const& t_e){ return std::strcmp(t_e.extensionName, VK_EXT_MESH_SHADER_EXTENSION_NAME) == 0; }))
+            {
+                featureScore += 1000;
+            }
+
+            bool forced = (t_createInfo.physicalDeviceIndex >= 0 && static_cast<u32>(t_createInfo.physicalDeviceIndex) == index) ||
+                          (!t_createInfo.physicalDeviceUUID.empty() && toLower(t_createInfo.physicalDeviceUUID) == deviceUUID) ||
+                          (!t_createInfo.physicalDeviceName.empty() && deviceName.find(t_createInfo.physicalDeviceName) != std::string::npos);
+
+            i64 score = typeScore + memoryScore + queueScore + featureScore;
+
+            m_infoCallback(prefix + ": score " + std::to_string(score)
+                + " [ type{" + std::to_string(typeScore)
+                + "}, memory{" + std::to_string(memoryScore) + ", " + std::to_string(deviceLocalBytes >> 20) + "MB"
+                + "}, queues{" + std::to_string(queueScore)
+                + "}, features{" + std::to_string(featureScore) + "} ]"
+                + (forced ? " matches device override" : "")
+            );
+
+            if ((forced && !bestForced) || (forced == bestForced && score > bestScore))
+            {
+                m_physicalDevice = gpu;
+                m_physicalDeviceProperties = gpuProperties;
+                m_physicalDeviceFeatures = gpuFeatures;
+                m_queueFamilyIndex = queueFamilyIndex;
+                bestScore = score;
+                bestForced = forced;
+            }
+        }
+
+        if (!m_physicalDevice)
+        {
+            m_errorCallback("No suitable physical devices");
+        }
+
+        if (hasOverride && !bestForced)
+        {
+            m_infoCallback("No physical device matches the requested override, falling back to the highest score");
         }
     }
 
@@ -474,6 +1053,11 @@ namespace arln {
         std::vector<VkExtensionProperties> extensionProperties(extensionCount);
         vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, extensionProperties.data());
 
+        auto hasExtension = [&](char const* t_name)
+        {
+            return std::ranges::any_of(extensionProperties, [&](auto const& t_e){ return std::strcmp(t_e.extensionName, t_name) == 0; });
+        };
+
         for (auto& extension : extensionProperties)
         {
             if (std::strcmp(VK_EXT_MESH_SHADER_EXTENSION_NAME, extension.extensionName) == 0)
@@ -482,21 +1066,119 @@ namespace arln {
                 m_meshShaderSupported = true;
             }
         }
-        m_deviceExtensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        if (std::ranges::any_of(extensionProperties, [](auto const& t_e){ return std::strcmp(t_e.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0; }))
+        {
+            u32 timeDomainCount;
+            vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(m_physicalDevice, &timeDomainCount, nullptr);
+            std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+            vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(m_physicalDevice, &timeDomainCount, timeDomains.data());
+
+            // GPU zones are mapped onto steady_clock, which only CLOCK_MONOTONIC matches
+            m_calibratedTimestampsSupported =
+                std::ranges::find(timeDomains, VK_TIME_DOMAIN_DEVICE_EXT) != timeDomains.end() &&
+                std::ranges::find(timeDomains, VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT) != timeDomains.end();
+
+            if (m_calibratedTimestampsSupported)
+            {
+                m_deviceExtensions.emplace_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+            }
+        }
+
+        if (!m_headless)
+        {
+            m_deviceExtensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+            presentIdFeatures.pNext = &presentWaitFeatures;
+
+            if (hasExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME) && hasExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+            {
+                VkPhysicalDeviceFeatures2 features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+                features.pNext = &presentIdFeatures;
+                vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+                m_presentWaitSupported = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+            }
+
+            if (m_presentWaitSupported)
+            {
+                m_deviceExtensions.emplace_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                m_deviceExtensions.emplace_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            }
+        }
+
+        // Budgets reflect what other processes use too, without the extension VMA can only estimate from heap sizes
+        if (hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+        {
+            m_deviceExtensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            m_memoryBudgetSupported = true;
+        }
+
+        VkPhysicalDeviceMemoryPriorityFeaturesEXT memoryPriorityFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT };
+
+        if (hasExtension(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME))
+        {
+            VkPhysicalDeviceFeatures2 features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &memoryPriorityFeatures;
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+            m_memoryPrioritySupported = memoryPriorityFeatures.memoryPriority;
+        }
+
+        if (m_memoryPrioritySupported)
+        {
+            m_deviceExtensions.emplace_back(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
+        }
 
-        const f32 priority = 0.f;
+        VkPhysicalDeviceVulkan12Features supportedVulkan12Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+        VkPhysicalDeviceFeatures2 supportedFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        supportedFeatures.pNext = &supportedVulkan12Features;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures);
 
-        VkDeviceQueueCreateInfo queueCreateInfo;
-        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfo.pNext = nullptr;
-        queueCreateInfo.flags = 0;
-        queueCreateInfo.queueCount = 1;
-        queueCreateInfo.queueFamilyIndex = m_queueFamilyIndex;
-        queueCreateInfo.pQueuePriorities = &priority;
+        m_addressCaptureSupported = supportedVulkan12Features.bufferDeviceAddressCaptureReplay;
+
+        const f32 priorities[] = { 0.f, 0.f, 0.f };
+
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos(m_queueFamilyIndices.size());
+
+        for (size_t i = queueCreateInfos.size(); i--; )
+        {
+            queueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCreateInfos[i].pNext = nullptr;
+            queueCreateInfos[i].flags = 0;
+            queueCreateInfos[i].queueCount = 1;
+            queueCreateInfos[i].queueFamilyIndex = m_queueFamilyIndices[i];
+            queueCreateInfos[i].pQueuePriorities = priorities;
+        }
+
+        if (m_computeFamilyIndex == m_queueFamilyIndex)
+        {
+            queueCreateInfos.front().queueCount = std::max(queueCreateInfos.front().queueCount, m_computeQueueIndex + 1);
+        }
+
+        if (m_transferFamilyIndex == m_queueFamilyIndex)
+        {
+            queueCreateInfos.front().queueCount = std::max(queueCreateInfos.front().queueCount, m_transferQueueIndex + 1);
+        }
 
         VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+
+        if (m_meshShaderSupported)
+        {
+            VkPhysicalDeviceFeatures2 features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &meshShaderFeatures;
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+
+            m_meshShaderQueriesSupported = meshShaderFeatures.meshShaderQueries;
+        }
+
+        meshShaderFeatures.pNext = nullptr;
         meshShaderFeatures.taskShader = true;
         meshShaderFeatures.meshShader = true;
+        meshShaderFeatures.multiviewMeshShader = false;
+        meshShaderFeatures.primitiveFragmentShadingRateMeshShader = false;
+        meshShaderFeatures.meshShaderQueries = m_meshShaderQueriesSupported;
 
         VkPhysicalDeviceVulkan11Features vulkan11Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
         vulkan11Features.shaderDrawParameters     = true;
@@ -532,6 +1214,9 @@ namespace arln {
         vulkan12Features.samplerFilterMinmax                                = true;
         vulkan12Features.scalarBlockLayout                                  = true;
         vulkan12Features.bufferDeviceAddress                                = true;
+        vulkan12Features.bufferDeviceAddressCaptureReplay                   = m_addressCaptureSupported;
+        vulkan12Features.timelineSemaphore                                  = true;
+        vulkan12Features.hostQueryReset                                     = true;
 
         VkPhysicalDeviceVulkan13Features vulkan13Features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
         vulkan13Features.pNext = &vulkan12Features;
@@ -539,8 +1224,24 @@ namespace arln {
         vulkan13Features.dynamicRendering = true;
         vulkan13Features.maintenance4     = true;
 
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+        presentWaitFeatures.pNext = &vulkan13Features;
+        presentWaitFeatures.presentWait = true;
+
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        presentIdFeatures.presentId = true;
+
+        memoryPriorityFeatures.pNext = m_presentWaitSupported ? static_cast<void*>(&presentIdFeatures) : &vulkan13Features;
+        memoryPriorityFeatures.memoryPriority = true;
+
         VkPhysicalDeviceFeatures2 enabledFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
-        enabledFeatures.pNext = &vulkan13Features;
+        enabledFeatures.pNext = m_presentWaitSupported ? static_cast<void*>(&presentIdFeatures) : &vulkan13Features;
+
+        if (m_memoryPrioritySupported)
+        {
+            enabledFeatures.pNext = &memoryPriorityFeatures;
+        }
         enabledFeatures.features.fillModeNonSolid        = true;
         enabledFeatures.features.wideLines               = true;
         enabledFeatures.features.depthClamp              = true;
@@ -548,6 +1249,7 @@ namespace arln {
         enabledFeatures.features.shaderInt16             = true;
         enabledFeatures.features.shaderInt64             = true;
         enabledFeatures.features.pipelineStatisticsQuery = true;
+        enabledFeatures.features.inheritedQueries        = m_physicalDeviceFeatures.features.inheritedQueries;
         enabledFeatures.features.samplerAnisotropy       = true;
         enabledFeatures.features.sampleRateShading       = true;
 
@@ -559,19 +1261,82 @@ namespace arln {
         deviceCreateInfo.ppEnabledExtensionNames = m_deviceExtensions.data();
         deviceCreateInfo.enabledLayerCount = 0;
         deviceCreateInfo.ppEnabledLayerNames = nullptr;
-        deviceCreateInfo.queueCreateInfoCount = 1;
-        deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+        deviceCreateInfo.queueCreateInfoCount = static_cast<u32>(queueCreateInfos.size());
+        deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
         deviceCreateInfo.pEnabledFeatures = nullptr;
 
         if (vkCreateDevice(m_physicalDevice, &deviceCreateInfo, nullptr, &m_device) != VK_SUCCESS)
         {
             m_errorCallback("Failed to create vulkan device");
         }
-        volkLoadDevice(m_device);
+
+        // Per device pointers skip the loader trampolines and keep several contexts apart
+        volkLoadDeviceTable(&m_deviceTable, m_device);
 
         m_infoCallback("Created vulkan device");
     }
 
+    void Context::createPipelineCache(std::vector<u8> const& t_fileData) noexcept
+    {
+        std::vector<u8> data;
+
+        if (!t_fileData.empty())
+        {
+            auto& properties = m_physicalDeviceProperties.properties;
+
+            PipelineCacheHeader header{};
+
+            if (t_fileData.size() >= sizeof(header))
+            {
+                std::memcpy(&header, t_fileData.data(), sizeof(header));
+            }
+
+            if (t_fileData.size() < sizeof(header) ||
+                header.magic != s_pipelineCacheMagic ||
+                header.headerSize != sizeof(PipelineCacheHeader) ||
+                header.dataSize != t_fileData.size() - sizeof(header))
+            {
+                m_infoCallback("Pipeline cache is malformed, starting with an empty cache");
+            }
+            else if (header.vendorID != properties.vendorID ||
+                     header.deviceID != properties.deviceID ||
+                     header.driverVersion != properties.driverVersion ||
+                     std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+            {
+                m_infoCallback("Pipeline cache was created by another device or driver, starting with an empty cache");
+            }
+            else if (hashBytes(t_fileData.data() + sizeof(header), header.dataSize) != header.dataHash)
+            {
+                m_infoCallback("Pipeline cache is corrupted, starting with an empty cache");
+            }
+            else
+            {
+                data.assign(t_fileData.begin() + sizeof(header), t_fileData.end());
+            }
+        }
+
+        VkPipelineCacheCreateInfo pipelineCacheCreateInfo;
+        pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        pipelineCacheCreateInfo.pNext = nullptr;
+        pipelineCacheCreateInfo.flags = 0;
+        pipelineCacheCreateInfo.initialDataSize = data.size();
+        pipelineCacheCreateInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+        if (m_deviceTable.vkCreatePipelineCache(m_device, &pipelineCacheCreateInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+        {
+            m_errorCallback("Failed to create pipeline cache");
+        }
+
+        if (data.empty())
+        {
+            m_infoCallback("Created empty pipeline cache");
+        }
+        else
+        {
+            m_infoCallback("Loaded pipeline cache: " + m_pipelineCachePath + " (" + std::to_string(data.size()) + " bytes)");
+        }
+    }
+
     void Context::createAllocator() noexcept
     {
         VmaVulkanFunctions functions;
@@ -579,28 +1344,33 @@ namespace arln {
         functions.vkGetDeviceProcAddr                     = vkGetDeviceProcAddr;
         functions.vkGetPhysicalDeviceProperties           = vkGetPhysicalDeviceProperties;
         functions.vkGetPhysicalDeviceMemoryProperties     = vkGetPhysicalDeviceMemoryProperties;
-        functions.vkAllocateMemory                        = vkAllocateMemory;
-        functions.vkFreeMemory                            = vkFreeMemory;
-        functions.vkMapMemory                             = vkMapMemory;
-        functions.vkUnmapMemory                           = vkUnmapMemory;
-        functions.vkFlushMappedMemoryRanges               = vkFlushMappedMemoryRanges;
-        functions.vkInvalidateMappedMemoryRanges          = vkInvalidateMappedMemoryRanges;
-        functions.vkBindBufferMemory                      = vkBindBufferMemory;
-        functions.vkBindImageMemory                       = vkBindImageMemory;
-        functions.vkGetBufferMemoryRequirements           = vkGetBufferMemoryRequirements;
-        functions.vkGetImageMemoryRequirements            = vkGetImageMemoryRequirements;
-        functions.vkCreateBuffer                          = vkCreateBuffer;
-        functions.vkDestroyBuffer                         = vkDestroyBuffer;
-        functions.vkCreateImage                           = vkCreateImage;
-        functions.vkDestroyImage                          = vkDestroyImage;
-        functions.vkCmdCopyBuffer                         = vkCmdCopyBuffer;
-        functions.vkGetBufferMemoryRequirements2KHR       = vkGetBufferMemoryRequirements2;
-        functions.vkGetImageMemoryRequirements2KHR        = vkGetImageMemoryRequirements2;
-        functions.vkBindBufferMemory2KHR                  = vkBindBufferMemory2;
-        functions.vkBindImageMemory2KHR                   = vkBindImageMemory2;
+        functions.vkAllocateMemory                        = m_deviceTable.vkAllocateMemory;
+        functions.vkFreeMemory                            = m_deviceTable.vkFreeMemory;
+        functions.vkMapMemory                             = m_deviceTable.vkMapMemory;
+        functions.vkUnmapMemory                           = m_deviceTable.vkUnmapMemory;
+        functions.vkFlushMappedMemoryRanges               = m_deviceTable.vkFlushMappedMemoryRanges;
+        functions.vkInvalidateMappedMemoryRanges          = m_deviceTable.vkInvalidateMappedMemoryRanges;
+        functions.vkBindBufferMemory                      = m_deviceTable.vkBindBufferMemory;
+        functions.vkBindImageMemory                       = m_deviceTable.vkBindImageMemory;
+        functions.vkGetBufferMemoryRequirements           = m_deviceTable.vkGetBufferMemoryRequirements;
+        functions.vkGetImageMemoryRequirements            = m_deviceTable.vkGetImageMemoryRequirements;
+        functions.vkCreateBuffer                          = m_deviceTable.vkCreateBuffer;
+        functions.vkDestroyBuffer                         = m_deviceTable.vkDestroyBuffer;
+        functions.vkCreateImage                           = m_deviceTable.vkCreateImage;
+        functions.vkDestroyImage                          = m_deviceTable.vkDestroyImage;
+        functions.vkCmdCopyBuffer                         = m_deviceTable.vkCmdCopyBuffer;
+        functions.vkGetBufferMemoryRequirements2KHR       = m_deviceTable.vkGetBufferMemoryRequirements2;
+        functions.vkGetImageMemoryRequirements2KHR        = m_deviceTable.vkGetImageMemoryRequirements2;
+        functions.vkBindBufferMemory2KHR                  = m_deviceTable.vkBindBufferMemory2;
+        functions.vkBindImageMemory2KHR                   = m_deviceTable.vkBindImageMemory2;
         functions.vkGetPhysicalDeviceMemoryProperties2KHR = vkGetPhysicalDeviceMemoryProperties2;
-        functions.vkGetDeviceBufferMemoryRequirements     = vkGetDeviceBufferMemoryRequirements;
-        functions.vkGetDeviceImageMemoryRequirements      = vkGetDeviceImageMemoryRequirements;
+        functions.vkGetDeviceBufferMemoryRequirements     = m_deviceTable.vkGetDeviceBufferMemoryRequirements;
+        functions.vkGetDeviceImageMemoryRequirements      = m_deviceTable.vkGetDeviceImageMemoryRequirements;
+
+        if (m_addressCaptureSupported)
+        {
+            functions.vkAllocateMemory = allocateMemory;
+        }
 
         VmaAllocatorCreateInfo allocatorCreateInfo{};
         allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
@@ -610,6 +1380,16 @@ namespace arln {
         allocatorCreateInfo.instance = m_instance;
         allocatorCreateInfo.pVulkanFunctions = &functions;
 
+        if (m_memoryBudgetSupported)
+        {
+            allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        }
+
+        if (m_memoryPrioritySupported)
+        {
+            allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_PRIORITY_BIT;
+        }
+
         if (vmaCreateAllocator(&allocatorCreateInfo, &m_allocator) != VK_SUCCESS)
         {
             m_errorCallback("Failed to create vulkan memory allocator");
@@ -617,6 +1397,142 @@ namespace arln {
         m_infoCallback("Created vulkan memory allocator");
     }
 
+    void Context::createImmediateCommandBuffer() noexcept
+    {
+        VkCommandPoolCreateInfo commandPoolCreateInfo;
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.pNext = nullptr;
+        commandPoolCreateInfo.flags = 0;
+        commandPoolCreateInfo.queueFamilyIndex = m_queueFamilyIndex;
+
+        if (m_deviceTable.vkCreateCommandPool(m_device, &commandPoolCreateInfo, nullptr, &m_immediateCommandPool) != VK_SUCCESS)
+        {
+            m_errorCallback("Failed to create vulkan command pool");
+        }
+
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo;
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.pNext = nullptr;
+        commandBufferAllocateInfo.commandBufferCount = 1;
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferAllocateInfo.commandPool = m_immediateCommandPool;
+
+        if (m_deviceTable.vkAllocateCommandBuffers(m_device, &commandBufferAllocateInfo, &m_immediateCommandBuffer) != VK_SUCCESS)
+        {
+            m_errorCallback("Failed to create vulkan command buffer");
+        }
+    }
+
+    void Context::querySurfaceSupport() noexcept
+    {
+        if (!m_headless)
+        {
+            vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &m_surfaceCapabilities);
+        }
+
+        auto surfaceFormat = [&]()
+        {
+            if (m_headless)
+            {
+                return VkSurfaceFormatKHR{ VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+            }
+
+            uint32_t count;
+            vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &count, nullptr);
+            std::vector<VkSurfaceFormatKHR> availableFormats(count);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &count, availableFormats.data());
+
+            if (availableFormats.size() == 1 && availableFormats[0].format == VK_FORMAT_UNDEFINED)
+            {
+                return VkSurfaceFormatKHR{ VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+            }
+            for (const auto& currentFormat : availableFormats)
+            {
+                if (currentFormat.format == VK_FORMAT_R8G8B8A8_UNORM && currentFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+                {
+                    return currentFormat;
+                }
+            }
+            for (const auto& currentFormat : availableFormats)
+            {
+                if (currentFormat.format == VK_FORMAT_B8G8R8A8_UNORM && currentFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+                {
+                    return currentFormat;
+                }
+            }
+            return availableFormats[0];
+        }();
+
+        m_colorFormat = static_cast<Format>(surfaceFormat.format);
+        m_depthFormat = findSupportedFormat({
+            Format::eD16Unorm, Format::eD32Sfloat, Format::eD32SfloatS8Uint, Format::eD24UnormS8Uint
+            },
+            ImageTiling::eOptimal,
+            FormatFeaturesBits::eDepthStencilAttachment
+        );
+    }
+
+    void Context::reportStartup() noexcept
+    {
+        std::ranges::sort(m_startupReport.phases, {}, &StartupPhase::startMilliseconds);
+
+        f64 serialMilliseconds = 0.0;
+        for (auto const& phase : m_startupReport.phases)
+        {
+            serialMilliseconds += phase.durationMilliseconds;
+        }
+
+        m_infoCallback("Startup took " + std::to_string(m_startupReport.totalMilliseconds)
+            + "ms (" + std::to_string(serialMilliseconds) + "ms of work):"
+        );
+
+        for (auto const& phase : m_startupReport.phases)
+        {
+            m_infoCallback("\t- " + phase.name
+                + " [ start{" + std::to_string(phase.startMilliseconds)
+                + "ms}, duration{" + std::to_string(phase.durationMilliseconds) + "ms} ]"
+                + (phase.asynchronous ? " on worker thread" : "")
+            );
+        }
+    }
+
+    void Context::updateMemoryBudget() noexcept
+    {
+        // VMA only fetches new budgets from the driver when the frame index changes
+        vmaSetCurrentFrameIndex(m_allocator, ++m_allocatorFrameIndex);
+
+        VkPhysicalDeviceMemoryProperties const* memoryProperties;
+        vmaGetMemoryProperties(m_allocator, &memoryProperties);
+
+        VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(m_allocator, budgets);
+
+        m_heapBudgets.resize(memoryProperties->memoryHeapCount);
+
+        std::scoped_lock lock(m_callbackMutex);
+
+        for (u32 i = 0; i < memoryProperties->memoryHeapCount; ++i)
+        {
+            auto& heapBudget = m_heapBudgets[i];
+            heapBudget.usage = budgets[i].usage;
+            heapBudget.budget = budgets[i].budget;
+            heapBudget.blockBytes = budgets[i].statistics.blockBytes;
+            heapBudget.allocationBytes = budgets[i].statistics.allocationBytes;
+            heapBudget.deviceLocal = memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+
+            if (m_memoryPressureCallback && heapBudget.deviceLocal &&
+                static_cast<f64>(heapBudget.usage) > static_cast<f64>(heapBudget.budget) * m_memoryPressureThreshold)
+            {
+                m_memoryPressureCallback(MemoryPressure{
+                    .heapIndex = i,
+                    .usage = heapBudget.usage,
+                    .budget = heapBudget.budget,
+                    .allocationFailed = false
+                });
+            }
+        }
+    }
+
     auto Context::findSupportedFormat(const std::vector<Format>& t_formats, ImageTiling t_tiling, FormatFeatures t_features) noexcept -> Format
     {
         for (auto& format : t_formats)
@@ -6,6 +6,15 @@
 #include "ArlnBuffer.hpp"
 #include "ArlnImage.hpp"
 #include "ArlnDescriptor.hpp"
+#include "ArlnUploadEngine.hpp"
+#include "ArlnSync.hpp"
+#include "ArlnDeletionQueue.hpp"
+#include "ArlnWorkerPool.hpp"
+#include "ArlnRenderGraph.hpp"
+#include "ArlnCapture.hpp"
+#include "ArlnBufferAllocator.hpp"
+#include "ArlnDefragmenter.hpp"
+#include <mutex>
 
 namespace arln {
 
@@ -19,28 +28,71 @@ namespace arln {
         Context& operator=(Context const&) = delete;
         Context& operator=(Context&&) = delete;
         ~Context() noexcept;
-        static Context* s_currentContext;
 
         void beginFrame() noexcept;
-        void endFrame(std::vector<CommandBufferHandle> const& t_commandBuffers) noexcept;
+        auto endFrame(std::vector<CommandBufferHandle> const& t_commandBuffers) noexcept -> GpuFuture;
+
+        // t_computeWaitStage lists the graphics stages that consume compute results, the rest overlaps with compute.
+        // Barriers that carry over compute queue state use compute stages as their source and need them listed as well
+        auto endFrame(
+            std::vector<CommandBufferHandle> const& t_commandBuffers,
+            std::vector<CommandBufferHandle> const& t_computeCommandBuffers,
+            PipelineStage t_computeWaitStage
+        ) noexcept -> GpuFuture;
         auto canRender() noexcept -> bool;
         void setResizeCallback(std::function<void(u32, u32)> const& t_function) noexcept;
-        void immediateSubmit(std::function<void(VkCommandBuffer)>&& t_function) noexcept;
+
+        // Called every frame for each device local heap whose usage is above t_threshold of its budget, and right
+        // away when an allocation runs out of device memory, so streaming systems can evict before anything fails
+        void setMemoryPressureCallback(std::function<void(MemoryPressure const&)> const& t_function, f32 t_threshold = 0.9f) noexcept;
+
+        // Lets the callback free memory in the heap of t_memoryTypeIndex and releases what the GPU is done with.
+        // Called from any thread by allocations that ran out of device memory before they retry once
+        void relieveMemoryPressure(u32 t_memoryTypeIndex) noexcept;
+        auto immediateSubmit(std::function<void(VkCommandBuffer)>&& t_function) noexcept -> GpuFuture;
+        void waitIdle() noexcept;
+        void setFramesInFlight(u32 t_frameCount) noexcept;
+
+        // Low latency keeps at most one frame queued and waits for its present, or for its rendering when
+        // VK_KHR_present_wait is missing. A frame rate limit above zero paces beginFrame in either mode
+        void setLatencyMode(LatencyMode t_mode, f64 t_frameRateLimit = 0.0) noexcept;
+        void savePipelineCache() noexcept;
         auto isPresentModeSupported(PresentMode t_presentMode) noexcept -> bool;
         auto allocateCommandBuffer() noexcept -> CommandBuffer;
+        auto allocateComputeCommandBuffer() noexcept -> CommandBuffer;
+        auto allocateSecondaryCommandBuffer() noexcept -> CommandBuffer;
+
+        // Copies into host cached memory at the end of the current frame, the result is readable a frame or two later
+        auto readbackBuffer(Buffer& t_buffer, size_t t_size, size_t t_offset = 0) noexcept -> Readback;
+        auto readbackImage(Image& t_image, BufferImageCopy const& t_copyInfo, size_t t_size) noexcept -> Readback;
         auto createGraphicsPipeline(GraphicsPipelineInfo const& t_pipelineInfo) noexcept -> Pipeline;
         auto createComputePipeline(ComputePipelineInfo const& t_pipelineInfo) noexcept -> Pipeline;
         auto allocateBuffer(BufferUsage t_bufferUsage, MemoryType t_memoryType, size_t t_sizeInBytes) noexcept -> Buffer;
         auto allocateImage(u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept -> Image;
         auto createDescriptorPool() noexcept -> DescriptorPool;
         auto createSampler(SamplerOptions const& t_options = {}) noexcept -> Sampler;
+        auto createRenderGraph() noexcept -> RenderGraph;
+        auto createTransientAllocator() noexcept -> TransientAllocator;
+        auto createBufferAllocator(BufferUsage t_usage, MemoryType t_memoryType, size_t t_blockSize = 4 * 1024 * 1024) noexcept -> BufferAllocator;
         auto findSupportedFormat(const std::vector<Format>& t_formats, ImageTiling t_tiling, FormatFeatures t_features) noexcept -> Format;
 
 
         inline auto& getPresentImage()                  noexcept { return m_swapchain.getImage(); }
         inline auto& getSwapchain()                     noexcept { return m_swapchain;            }
         inline auto& getFrame()                         noexcept { return m_frame;                }
+        inline auto& getUploadEngine()                  noexcept { return m_uploadEngine;         }
+        inline auto& getDeletionQueue()                 noexcept { return m_deletionQueue;        }
+        inline auto& getWorkerPool()                    noexcept { return m_workerPool;           }
+        inline auto& getProfiler()                      noexcept { return m_frame.getProfiler();  }
+        inline auto& getCapture()                       noexcept { return m_capture;              }
+        inline auto& getDefragmenter()                  noexcept { return m_defragmenter;         }
+        inline auto& getGraphicsTimeline()              noexcept { return m_graphicsTimeline;     }
+        inline auto& getComputeTimeline()               noexcept { return m_computeTimeline;      }
+        inline auto& getQueueMutex()                    noexcept { return m_queueMutex;           }
         inline auto& getSurfaceCapabilities()     const noexcept { return m_surfaceCapabilities;  }
+        inline auto& getStartupReport()           const noexcept { return m_startupReport;        }
+        inline auto& getPhysicalDeviceProperties() const noexcept { return m_physicalDeviceProperties; }
+        inline auto& getPhysicalDeviceFeatures()   const noexcept { return m_physicalDeviceFeatures;   }
         inline auto& getResizeCallback()          const noexcept { return m_resizeCallback;       }
         inline auto& getInfoCallback()            const noexcept { return m_infoCallback;         }
         inline auto& getErrorCallback()           const noexcept { return m_errorCallback;        }
@@ -50,66 +102,117 @@ namespace arln {
         inline auto  getDebugCallback()           const noexcept { return m_debugCallback;        }
         inline auto  getPhysicalDevice()          const noexcept { return m_physicalDevice;       }
         inline auto  getDevice()                  const noexcept { return m_device;               }
+        inline auto& getDeviceTable()             const noexcept { return m_deviceTable;          }
+        inline auto  getPipelineCache()           const noexcept { return m_pipelineCache;        }
         inline auto  getGraphicsQueue()           const noexcept { return m_graphicsQueue;        }
         inline auto  getPresentQueue()            const noexcept { return m_presentQueue;         }
+        inline auto  getComputeQueue()            const noexcept { return m_computeQueue;         }
+        inline auto  getTransferQueue()           const noexcept { return m_transferQueue;        }
         inline auto  getSurfacePresentMode()      const noexcept { return m_surfacePresentMode;   }
-        inline auto  getQueueIndex()              const noexcept { return m_queueFamilyIndex;     }
+        inline auto  getQueueFamilyIndex()        const noexcept { return m_queueFamilyIndex;     }
+        inline auto  getComputeFamilyIndex()      const noexcept { return m_computeFamilyIndex;   }
+        inline auto  getTransferFamilyIndex()     const noexcept { return m_transferFamilyIndex;  }
+        inline auto& getQueueFamilyIndices()      const noexcept { return m_queueFamilyIndices;   }
+        inline auto  isAsyncComputeSupported()    const noexcept { return m_computeQueue != m_graphicsQueue; }
+        inline auto  isAsyncTransferSupported()   const noexcept { return m_transferQueue != m_graphicsQueue; }
         inline auto  getDefaultColorFormat()      const noexcept { return m_colorFormat;          }
         inline auto  getDefaultDepthFormat()      const noexcept { return m_depthFormat;          }
         inline auto  getWindowHeight()            const noexcept { return m_getHeightFunc();      }
         inline auto  getWindowWidth()             const noexcept { return m_getWidthFunc();       }
         inline auto  isMeshShaderSupported()      const noexcept { return m_meshShaderSupported;  }
+        inline auto  isMeshShaderQueriesSupported() const noexcept { return m_meshShaderQueriesSupported; }
+        inline auto  isPresentWaitSupported()     const noexcept { return m_presentWaitSupported; }
+        inline auto  isCalibratedTimestampsSupported() const noexcept { return m_calibratedTimestampsSupported; }
+        inline auto  isHeadless()                 const noexcept { return m_headless;             }
+        inline auto  getHeadlessImageCount()      const noexcept { return m_headlessImageCount;   }
+        inline auto  getFramesInFlight()          const noexcept { return m_frame.getFrameCount(); }
+        inline auto& getLatencyStats()            const noexcept { return m_frame.getLatencyStats(); }
+        inline auto& getHeapBudgets()             const noexcept { return m_heapBudgets;          }
+        inline auto  isMemoryBudgetSupported()    const noexcept { return m_memoryBudgetSupported; }
+        inline auto  isMemoryPrioritySupported()  const noexcept { return m_memoryPrioritySupported; }
+        inline auto  isAddressCaptureSupported()  const noexcept { return m_addressCaptureSupported; }
         inline auto  getCurrentExtent()           const noexcept {
             return arln::uvec2{ m_swapchain.getExtent().width, m_swapchain.getExtent().height };
         }
 
     private:
+        friend class Buffer;
+
+        // Memory allocated by this thread until it is reset gets a replayable device address
+        static void setMemoryCaptureAddress(Context* t_context, u64 t_address) noexcept;
+
         void checkLayersSupport(std::span<const char*> t_layerNames) noexcept;
         void checkExtensionsSupport(std::span<const char*> t_extensionNames) noexcept;
         auto findQueueFamily(VkPhysicalDevice t_physicalDevice) noexcept -> u32;
-        void selectPhysicalDevice() noexcept;
+        void selectQueues() noexcept;
+        void selectPhysicalDevice(ContextCreateInfo const& t_createInfo) noexcept;
         void createLogicalDevice() noexcept;
         void createAllocator() noexcept;
+        void createPipelineCache(std::vector<u8> const& t_fileData) noexcept;
+        void createImmediateCommandBuffer() noexcept;
+        void querySurfaceSupport() noexcept;
+        void reportStartup() noexcept;
+        void updateMemoryBudget() noexcept;
 
     private:
-        arln::Swapchain                       m_swapchain               { };
-        arln::Frame                           m_frame                   { };
-        VmaAllocator                          m_allocator               { };
-        VkInstance                            m_instance                { };
-        VkSurfaceKHR                          m_surface                 { };
-        VkDebugReportCallbackEXT              m_debugCallback           { };
-        VkPhysicalDevice                      m_physicalDevice          { };
-        VkDevice                              m_device                  { };
-        VkQueue                               m_graphicsQueue           { };
-        VkQueue                               m_presentQueue            { };
-        VkQueue                               m_computeQueue            { }; // TODO
-        VkQueue                               m_transferQueue           { }; // TODO
-        VkCommandPool                         m_immediateCommandPool    { };
-        VkCommandBuffer                       m_immediateCommandBuffer  { };
-        VkFence                               m_immediateFence          { };
-        VkSurfaceCapabilitiesKHR              m_surfaceCapabilities     { };
-        PresentMode                           m_surfacePresentMode      { };
-        Format                                m_colorFormat             { };
-        Format                                m_depthFormat             { };
-        VkPhysicalDeviceProperties2           m_physicalDeviceProperties{ };
-        VkPhysicalDeviceFeatures2             m_physicalDeviceFeatures  { };
-        u32                                   m_queueFamilyIndex        { };
-        std::vector<const char*>              m_deviceExtensions        { };
-        std::function<u32()>                  m_getWidthFunc            { };
-        std::function<u32()>                  m_getHeightFunc           { };
-        std::function<void(u32, u32)>         m_resizeCallback          { };
-        std::function<void(std::string_view)> m_infoCallback            { };
-        std::function<void(std::string_view)> m_errorCallback           { };
-        bool                                  m_meshShaderSupported     { };
+        arln::Swapchain                       m_swapchain                    { };
+        arln::Frame                           m_frame                        { };
+        arln::UploadEngine                    m_uploadEngine                 { };
+        arln::DeletionQueue                   m_deletionQueue                { };
+        arln::WorkerPool                      m_workerPool                   { };
+        arln::TimelineSemaphore               m_graphicsTimeline             { };
+        arln::TimelineSemaphore               m_computeTimeline              { };
+        arln::Capture                         m_capture                      { };
+        arln::Defragmenter                    m_defragmenter                 { };
+        VmaAllocator                          m_allocator                    { };
+        VkInstance                            m_instance                     { };
+        VkSurfaceKHR                          m_surface                      { };
+        VkDebugReportCallbackEXT              m_debugCallback                { };
+        VkPhysicalDevice                      m_physicalDevice               { };
+        VkDevice                              m_device                       { };
+        VolkDeviceTable                       m_deviceTable                  { };
+        VkPipelineCache                       m_pipelineCache                { };
+        VkQueue                               m_graphicsQueue                { };
+        VkQueue                               m_presentQueue                 { };
+        VkQueue                               m_computeQueue                 { };
+        VkQueue                               m_transferQueue                { };
+        VkCommandPool                         m_immediateCommandPool         { };
+        VkCommandBuffer                       m_immediateCommandBuffer       { };
+        VkSurfaceCapabilitiesKHR              m_surfaceCapabilities          { };
+        PresentMode                           m_surfacePresentMode           { };
+        Format                                m_colorFormat                  { };
+        Format                                m_depthFormat                  { };
+        VkPhysicalDeviceProperties2           m_physicalDeviceProperties     { };
+        VkPhysicalDeviceFeatures2             m_physicalDeviceFeatures       { };
+        u32                                   m_queueFamilyIndex             { };
+        u32                                   m_computeFamilyIndex           { };
+        u32                                   m_computeQueueIndex            { };
+        u32                                   m_transferFamilyIndex          { };
+        u32                                   m_transferQueueIndex           { };
+        std::vector<u32>                      m_queueFamilyIndices           { };
+        std::vector<const char*>              m_deviceExtensions             { };
+        std::string                           m_pipelineCachePath            { };
+        std::function<u32()>                  m_getWidthFunc                 { };
+        std::function<u32()>                  m_getHeightFunc                { };
+        std::function<void(u32, u32)>         m_resizeCallback               { };
+        std::function<void(MemoryPressure const&)> m_memoryPressureCallback { };
+        std::function<void(std::string_view)> m_infoCallback                 { };
+        std::function<void(std::string_view)> m_errorCallback                { };
+        std::recursive_mutex                  m_callbackMutex                { };
+        std::mutex                            m_queueMutex                   { };
+        StartupReport                         m_startupReport                { };
+        u32                                   m_headlessImageCount           { };
+        uvec2                                 m_headlessExtent               { };
+        std::vector<HeapBudget>               m_heapBudgets                  { };
+        f32                                   m_memoryPressureThreshold      { };
+        u32                                   m_allocatorFrameIndex          { };
+        bool                                  m_meshShaderSupported          { };
+        bool                                  m_meshShaderQueriesSupported   { };
+        bool                                  m_presentWaitSupported         { };
+        bool                                  m_calibratedTimestampsSupported{ };
+        bool                                  m_memoryBudgetSupported        { };
+        bool                                  m_memoryPrioritySupported      { };
+        bool                                  m_addressCaptureSupported      { };
+        bool                                  m_headless                     { };
     };
-
-    inline void SetCurrentContext(Context& t_context) noexcept
-    {
-        Context::s_currentContext = std::addressof(t_context);
-    }
-
-    inline auto CurrentContext() noexcept -> Context*
-    {
-        return Context::s_currentContext;
-    }
 }
\ No newline at end of file
@@ -0,0 +1,485 @@
+#include "ArlnDefragmenter.hpp"
+#include "ArlnContext.hpp"
+
+namespace arln {
+
+    static auto isDynamicBuffer(VkDescriptorType t_type) noexcept -> bool
+    {
+        return t_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || t_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    }
+
+    void Defragmenter::create(Context& t_context, size_t t_bytesPerFrame) noexcept
+    {
+        m_context = &t_context;
+        m_bytesPerFrame = t_bytesPerFrame;
+        m_frame = 0;
+        m_restartFrame = s_restartInterval;
+        m_enabled = true;
+
+        m_context->getInfoCallback()("Defragmenting up to " + std::to_string(t_bytesPerFrame) + " bytes per frame");
+    }
+
+    void Defragmenter::teardown() noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_passActive)
+        {
+            endPass();
+        }
+
+        if (m_defragmentation)
+        {
+            finish();
+        }
+
+        m_buffers.clear();
+        m_sets.clear();
+        m_setFrames.clear();
+        m_frameValues.clear();
+        m_descriptors.clear();
+        m_pinned.clear();
+
+        for (auto& [handle, current] : m_forwarded)
+        {
+            m_context->getDeletionQueue().push(handle);
+        }
+        m_forwarded.clear();
+
+        m_enabled = false;
+    }
+
+    void Defragmenter::collect() noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        if (!m_passActive)
+        {
+            return;
+        }
+
+        // The old allocations are released once both queues are past the frames that may still use them
+        if (!m_endValue)
+        {
+            m_endValue = m_context->getGraphicsTimeline().getSubmittedValue();
+            m_computeEndValue = m_context->getComputeTimeline().getSubmittedValue();
+        }
+
+        if (m_context->getGraphicsTimeline().isComplete(m_endValue) && m_context->getComputeTimeline().isComplete(m_computeEndValue))
+        {
+            endPass();
+        }
+    }
+
+    void Defragmenter::beginFrame() noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        auto& graphicsTimeline = m_context->getGraphicsTimeline();
+        auto& computeTimeline = m_context->getComputeTimeline();
+
+        m_frameValues.push_back(FrameValues{ m_frame++, graphicsTimeline.getSubmittedValue(), computeTimeline.getSubmittedValue() });
+
+        while (!m_frameValues.empty() &&
+               graphicsTimeline.isComplete(m_frameValues.front().graphicsValue) &&
+               computeTimeline.isComplete(m_frameValues.front().computeValue))
+        {
+            m_completedFrame = m_frameValues.front().frame + 1;
+            m_frameValues.erase(m_frameValues.begin());
+        }
+
+        if (m_passActive || (!m_defragmentation && m_frame < m_restartFrame))
+        {
+            return;
+        }
+
+        if (!m_defragmentation)
+        {
+            VmaDefragmentationInfo defragmentationInfo{ };
+            defragmentationInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+            defragmentationInfo.maxBytesPerPass = m_bytesPerFrame;
+
+            if (vmaBeginDefragmentation(m_context->getAllocator(), &defragmentationInfo, &m_defragmentation) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to begin defragmentation");
+                m_restartFrame = m_frame + s_restartInterval;
+                return;
+            }
+        }
+
+        if (vmaBeginDefragmentationPass(m_context->getAllocator(), m_defragmentation, &m_pass) == VK_SUCCESS)
+        {
+            finish();
+            return;
+        }
+
+        VkCommandBuffer commandBuffer = nullptr;
+
+        for (u32 i = 0; i < m_pass.moveCount; ++i)
+        {
+            auto& move = m_pass.pMoves[i];
+            auto it = m_buffers.find(move.srcAllocation);
+
+            if (it == m_buffers.end())
+            {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+
+            if (!commandBuffer)
+            {
+                commandBuffer = m_context->getFrame().getUploadCommandBuffer();
+
+                // Frames in flight may still write the moved buffers
+                VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+                barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+                barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+                barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+
+                VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+                dependencyInfo.memoryBarrierCount = 1;
+                dependencyInfo.pMemoryBarriers = &barrier;
+
+                m_context->getDeviceTable().vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+            }
+
+            if (moveBuffer(*it->second, move.dstTmpAllocation, commandBuffer))
+            {
+                m_moved.push_back(move.srcAllocation);
+            }
+            else
+            {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            }
+        }
+
+        m_passActive = true;
+        m_endValue = 0;
+        m_computeEndValue = 0;
+    }
+
+    void Defragmenter::request() noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+        m_restartFrame = m_frame;
+    }
+
+    void Defragmenter::track(Buffer& t_buffer) noexcept
+    {
+        if (!m_enabled || !t_buffer.getAllocation())
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        m_buffers[t_buffer.getAllocation()] = &t_buffer;
+        t_buffer.m_tracked = true;
+    }
+
+    void Defragmenter::untrack(Buffer const& t_buffer) noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (auto it = m_buffers.find(t_buffer.getAllocation()); it != m_buffers.end() && it->second == &t_buffer)
+        {
+            m_buffers.erase(it);
+        }
+    }
+
+    void Defragmenter::retrack(Buffer const& t_from, Buffer& t_to) noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (auto it = m_buffers.find(t_from.getAllocation()); it != m_buffers.end() && it->second == &t_from)
+        {
+            it->second = &t_to;
+        }
+    }
+
+    void Defragmenter::pin(VkBuffer t_buffer) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        m_pinned.insert(t_buffer);
+    }
+
+    void Defragmenter::release(Buffer& t_buffer) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        if (auto it = m_forwarded.find(t_buffer.m_handle); it != m_forwarded.end())
+        {
+            t_buffer.m_handle = it->second;
+        }
+
+        m_buffers.erase(t_buffer.getAllocation());
+        m_pinned.erase(t_buffer.getHandle());
+
+        // Retired handles outlive the buffer so no new buffer reuses one
+        std::erase_if(m_forwarded, [&](auto const& t_forward)
+        {
+            if (t_forward.second != t_buffer.getHandle())
+            {
+                return false;
+            }
+
+            m_context->getDeletionQueue().push(t_forward.first);
+            return true;
+        });
+
+        std::erase_if(m_descriptors, [&](auto const& t_descriptor) { return t_descriptor.second.buffer == t_buffer.getHandle(); });
+    }
+
+    void Defragmenter::createDescriptor(VkDescriptorPool t_pool, VkDescriptorSet t_set) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        m_sets[t_set] = t_pool;
+    }
+
+    void Defragmenter::useDescriptors(std::span<const VkDescriptorSet> t_sets) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        for (auto set : t_sets)
+        {
+            if (m_sets.contains(set))
+            {
+                m_setFrames[set] = m_frame;
+            }
+        }
+    }
+
+    void Defragmenter::writeDescriptors(std::span<const VkWriteDescriptorSet> t_writes) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        for (auto& write : t_writes)
+        {
+            if (!write.pBufferInfo)
+            {
+                continue;
+            }
+
+            for (u32 i = 0; i < write.descriptorCount; ++i)
+            {
+                auto& bufferInfo = write.pBufferInfo[i];
+
+                if (isDynamicBuffer(write.descriptorType) || !m_sets.contains(write.dstSet))
+                {
+                    m_pinned.insert(bufferInfo.buffer);
+                    continue;
+                }
+
+                m_descriptors[{ write.dstSet, write.dstBinding, write.dstArrayElement + i }] = BufferDescriptor{
+                    .buffer = bufferInfo.buffer,
+                    .type = write.descriptorType,
+                    .offset = bufferInfo.offset,
+                    .range = bufferInfo.range
+                };
+            }
+        }
+    }
+
+    void Defragmenter::releaseDescriptorPool(VkDescriptorPool t_pool) noexcept
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_mutex);
+
+        std::erase_if(m_descriptors, [&](auto const& t_descriptor)
+        {
+            auto it = m_sets.find(std::get<0>(t_descriptor.first));
+            return it != m_sets.end() && it->second == t_pool;
+        });
+
+        std::erase_if(m_setFrames, [&](auto const& t_set)
+        {
+            auto it = m_sets.find(t_set.first);
+            return it != m_sets.end() && it->second == t_pool;
+        });
+
+        std::erase_if(m_sets, [&](auto const& t_set) { return t_set.second == t_pool; });
+    }
+
+    auto Defragmenter::moveBuffer(Buffer& t_buffer, VmaAllocation t_allocation, VkCommandBuffer t_commandBuffer) noexcept -> bool
+    {
+        if (t_buffer.getAllocationInfo().pMappedData || m_pinned.contains(t_buffer.getHandle()))
+        {
+            return false;
+        }
+
+        // Sets bound by a frame in flight can not be rewritten yet
+        for (auto& [key, descriptor] : m_descriptors)
+        {
+            auto it = m_setFrames.find(std::get<0>(key));
+
+            if (descriptor.buffer == t_buffer.getHandle() && it != m_setFrames.end() && it->second >= m_completedFrame)
+            {
+                return false;
+            }
+        }
+
+        VkBufferCreateInfo bufferCreateInfo;
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.pNext = nullptr;
+        bufferCreateInfo.flags = 0;
+        bufferCreateInfo.usage = t_buffer.m_usage;
+        bufferCreateInfo.size = t_buffer.getSize();
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        bufferCreateInfo.queueFamilyIndexCount = 0;
+        bufferCreateInfo.pQueueFamilyIndices = nullptr;
+
+        if (auto& queueFamilyIndices = m_context->getQueueFamilyIndices(); queueFamilyIndices.size() > 1)
+        {
+            bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferCreateInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilyIndices.size());
+            bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+        }
+
+        VkBuffer handle;
+        if (m_context->getDeviceTable().vkCreateBuffer(m_context->getDevice(), &bufferCreateInfo, nullptr, &handle) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        if (vmaBindBufferMemory(m_context->getAllocator(), t_allocation, handle) != VK_SUCCESS)
+        {
+            m_context->getDeviceTable().vkDestroyBuffer(m_context->getDevice(), handle, nullptr);
+            return false;
+        }
+
+        VkBufferCopy bufferCopy = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = t_buffer.getSize()
+        };
+
+        m_context->getDeviceTable().vkCmdCopyBuffer(t_commandBuffer, t_buffer.getHandle(), handle, 1, &bufferCopy);
+
+        std::vector<VkDescriptorBufferInfo> bufferInfos;
+        std::vector<VkWriteDescriptorSet> writes;
+
+        for (auto& [key, descriptor] : m_descriptors)
+        {
+            if (descriptor.buffer == t_buffer.getHandle())
+            {
+                descriptor.buffer = handle;
+                bufferInfos.push_back(VkDescriptorBufferInfo{ handle, descriptor.offset, descriptor.range });
+
+                VkWriteDescriptorSet descriptorWrite{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+                descriptorWrite.dstSet = std::get<0>(key);
+                descriptorWrite.dstBinding = std::get<1>(key);
+                descriptorWrite.dstArrayElement = std::get<2>(key);
+                descriptorWrite.descriptorCount = 1;
+                descriptorWrite.descriptorType = descriptor.type;
+                writes.push_back(descriptorWrite);
+            }
+        }
+
+        for (size_t i = writes.size(); i--; )
+        {
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        if (!writes.empty())
+        {
+            m_context->getDeviceTable().vkUpdateDescriptorSets(m_context->getDevice(), static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+        }
+
+        VkBufferDeviceAddressInfo bufferDeviceAddressInfo;
+        bufferDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+        bufferDeviceAddressInfo.buffer = handle;
+        bufferDeviceAddressInfo.pNext = nullptr;
+
+        for (auto& [retired, current] : m_forwarded)
+        {
+            if (current == t_buffer.m_handle)
+            {
+                current = handle;
+            }
+        }
+
+        m_forwarded[t_buffer.m_handle] = handle;
+        t_buffer.m_handle = handle;
+        t_buffer.m_deviceAddress = m_context->getDeviceTable().vkGetBufferDeviceAddress(m_context->getDevice(), &bufferDeviceAddressInfo);
+
+        return true;
+    }
+
+    void Defragmenter::endPass() noexcept
+    {
+        bool const complete = vmaEndDefragmentationPass(m_context->getAllocator(), m_defragmentation, &m_pass) == VK_SUCCESS;
+
+        for (auto allocation : m_moved)
+        {
+            if (auto it = m_buffers.find(allocation); it != m_buffers.end())
+            {
+                vmaGetAllocationInfo(m_context->getAllocator(), allocation, &it->second->m_allocationInfo);
+                vmaGetAllocationMemoryProperties(m_context->getAllocator(), allocation, &it->second->m_allocationInfo.memoryType);
+            }
+        }
+        m_moved.clear();
+
+        m_pass = { };
+        m_passActive = false;
+
+        if (complete)
+        {
+            finish();
+        }
+    }
+
+    void Defragmenter::finish() noexcept
+    {
+        VmaDefragmentationStats stats{ };
+        vmaEndDefragmentation(m_context->getAllocator(), m_defragmentation, &stats);
+
+        m_defragmentation = nullptr;
+        m_restartFrame = m_frame + s_restartInterval;
+        m_movedBytes += stats.bytesMoved;
+        m_freedBytes += stats.bytesFreed;
+
+        if (stats.allocationsMoved)
+        {
+            m_context->getInfoCallback()("Defragmentation moved " + std::to_string(stats.bytesMoved) + " bytes, freed " + std::to_string(stats.bytesFreed) + " bytes");
+        }
+    }
+}
\ No newline at end of file
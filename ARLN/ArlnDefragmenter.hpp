@@ -0,0 +1,90 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace arln {
+
+    // Only buffers registered with track() are moved, copies of a moved Buffer keep the old handle.
+    // The registration follows the Buffer when it is moved and ends when it is freed or destroyed
+    class Defragmenter
+    {
+    public:
+        Defragmenter() = default;
+        Defragmenter(Defragmenter const&) = delete;
+        Defragmenter(Defragmenter&&) = delete;
+        Defragmenter& operator=(Defragmenter const&) = delete;
+        Defragmenter& operator=(Defragmenter&&) = delete;
+        ~Defragmenter() = default;
+
+        void create(Context& t_context, size_t t_bytesPerFrame) noexcept;
+        void teardown() noexcept;
+
+        void collect() noexcept;
+        void beginFrame() noexcept;
+        void request() noexcept;
+        void track(Buffer& t_buffer) noexcept;
+        void untrack(Buffer const& t_buffer) noexcept;
+        void retrack(Buffer const& t_from, Buffer& t_to) noexcept;
+        void pin(VkBuffer t_buffer) noexcept;
+        void release(Buffer& t_buffer) noexcept;
+        void createDescriptor(VkDescriptorPool t_pool, VkDescriptorSet t_set) noexcept;
+        void useDescriptors(std::span<const VkDescriptorSet> t_sets) noexcept;
+        void writeDescriptors(std::span<const VkWriteDescriptorSet> t_writes) noexcept;
+        void releaseDescriptorPool(VkDescriptorPool t_pool) noexcept;
+
+        inline auto isEnabled()     const noexcept { return m_enabled;    }
+        inline auto getMovedBytes() const noexcept { return m_movedBytes; }
+        inline auto getFreedBytes() const noexcept { return m_freedBytes; }
+
+    private:
+        struct BufferDescriptor
+        {
+            VkBuffer         buffer;
+            VkDescriptorType type;
+            VkDeviceSize     offset;
+            VkDeviceSize     range;
+        };
+
+        struct FrameValues
+        {
+            u64 frame;
+            u64 graphicsValue;
+            u64 computeValue;
+        };
+
+        using DescriptorKey = std::tuple<VkDescriptorSet, u32, u32>;
+
+        static constexpr u64 s_restartInterval = 1024;
+
+        auto moveBuffer(Buffer& t_buffer, VmaAllocation t_allocation, VkCommandBuffer t_commandBuffer) noexcept -> bool;
+        void endPass() noexcept;
+        void finish() noexcept;
+
+        Context*                                              m_context        { };
+        std::mutex                                            m_mutex          { };
+        VmaDefragmentationContext                             m_defragmentation{ };
+        VmaDefragmentationPassMoveInfo                        m_pass           { };
+        std::unordered_map<VmaAllocation, Buffer*>            m_buffers        { };
+        std::unordered_map<VkDescriptorSet, VkDescriptorPool> m_sets           { };
+        std::unordered_map<VkDescriptorSet, u64>              m_setFrames      { };
+        std::vector<FrameValues>                              m_frameValues    { };
+        std::map<DescriptorKey, BufferDescriptor>             m_descriptors    { };
+        std::unordered_set<VkBuffer>                          m_pinned         { };
+        std::unordered_map<VkBuffer, VkBuffer>                m_forwarded      { };
+        std::vector<VmaAllocation>                            m_moved          { };
+        size_t                                                m_bytesPerFrame  { };
+        size_t                                                m_movedBytes     { };
+        size_t                                                m_freedBytes     { };
+        u64                                                   m_frame          { };
+        u64                                                   m_completedFrame { };
+        u64                                                   m_restartFrame   { };
+        u64                                                   m_endValue       { };
+        u64                                                   m_computeEndValue{ };
+        bool                                                  m_enabled        { };
+        bool                                                  m_passActive     { };
+    };
+}
\ No newline at end of file
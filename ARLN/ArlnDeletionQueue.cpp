@@ -0,0 +1,177 @@
+#include "ArlnDeletionQueue.hpp"
+#include "ArlnContext.hpp"
+
+namespace arln {
+
+    void DeletionQueue::create(Context& t_context) noexcept
+    {
+        m_context = &t_context;
+    }
+
+    void DeletionQueue::teardown() noexcept
+    {
+        collect(true);
+    }
+
+    void DeletionQueue::push(Buffer const& t_buffer) noexcept
+    {
+        auto node = new Node{ };
+        node->type = Type::eBuffer;
+        node->buffer = t_buffer.getHandle();
+        node->allocation = t_buffer.getAllocation();
+        node->bytes = t_buffer.getAllocationInfo().size;
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::push(Image const& t_image) noexcept
+    {
+        auto node = new Node{ };
+        node->type = Type::eImage;
+        node->image = t_image.getHandle();
+        node->view = t_image.getView();
+        node->allocation = t_image.getAllocation();
+
+        if (node->allocation)
+        {
+            VmaAllocationInfo allocationInfo;
+            vmaGetAllocationInfo(m_context->getAllocator(), node->allocation, &allocationInfo);
+            node->bytes = allocationInfo.size;
+        }
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::push(Pipeline const& t_pipeline) noexcept
+    {
+        auto node = new Node{ };
+        node->type = Type::ePipeline;
+        node->pipeline = t_pipeline.getHandle();
+        node->layout = t_pipeline.getLayout();
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::push(VkDescriptorPool t_pool) noexcept
+    {
+        auto node = new Node{ };
+        node->type = Type::eDescriptorPool;
+        node->descriptorPool = t_pool;
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::push(VkImage t_image, VkImageView t_view) noexcept
+    {
+        auto node = new Node{ };
+        node->type = Type::eImageHandle;
+        node->image = t_image;
+        node->view = t_view;
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::push(VkBuffer t_buffer) noexcept
+    {
+        auto node = new Node{ };
+        node->type = Type::eBufferHandle;
+        node->buffer = t_buffer;
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::push(VmaAllocation t_memory) noexcept
+    {
+        VmaAllocationInfo allocationInfo;
+        vmaGetAllocationInfo(m_context->getAllocator(), t_memory, &allocationInfo);
+
+        auto node = new Node{ };
+        node->type = Type::eMemory;
+        node->allocation = t_memory;
+        node->bytes = allocationInfo.size;
+
+        enqueue(node);
+    }
+
+    void DeletionQueue::collect(bool t_force) noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        for (Node* node = m_head.exchange(nullptr, std::memory_order_acquire); node; )
+        {
+            Node* next = node->next;
+            m_retiring.emplace_back(node);
+            node = next;
+        }
+
+        if (m_retiring.empty())
+        {
+            return;
+        }
+
+        u64 graphicsValue = t_force ? ~0ull : m_context->getGraphicsTimeline().getCompletedValue();
+        u64 computeValue  = t_force ? ~0ull : m_context->getComputeTimeline().getCompletedValue();
+
+        for (size_t i = m_retiring.size(); i--; )
+        {
+            Node* node = m_retiring[i];
+
+            if (node->graphicsValue <= graphicsValue && node->computeValue <= computeValue)
+            {
+                destroy(node);
+                m_retiring[i] = m_retiring.back();
+                m_retiring.pop_back();
+            }
+        }
+    }
+
+    void DeletionQueue::enqueue(Node* t_node) noexcept
+    {
+        // Work recorded into the frame being built signals the next graphics value,
+        // compute and upload submissions of that frame are waited on by it
+        t_node->graphicsValue = m_context->getGraphicsTimeline().getSubmittedValue() + 1;
+        t_node->computeValue = m_context->getComputeTimeline().getSubmittedValue();
+
+        m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+        m_pendingBytes.fetch_add(t_node->bytes, std::memory_order_relaxed);
+
+        t_node->next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(t_node->next, t_node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void DeletionQueue::destroy(Node* t_node) noexcept
+    {
+        switch (t_node->type)
+        {
+            case Type::eBuffer:
+                vmaDestroyBuffer(m_context->getAllocator(), t_node->buffer, t_node->allocation);
+                break;
+            case Type::eImage:
+                if (t_node->view) m_context->getDeviceTable().vkDestroyImageView(m_context->getDevice(), t_node->view, nullptr);
+                if (t_node->allocation) vmaDestroyImage(m_context->getAllocator(), t_node->image, t_node->allocation);
+                break;
+            case Type::ePipeline:
+                if (t_node->pipeline) m_context->getDeviceTable().vkDestroyPipeline(m_context->getDevice(), t_node->pipeline, nullptr);
+                if (t_node->layout) m_context->getDeviceTable().vkDestroyPipelineLayout(m_context->getDevice(), t_node->layout, nullptr);
+                break;
+            case Type::eDescriptorPool:
+                if (t_node->descriptorPool) m_context->getDeviceTable().vkDestroyDescriptorPool(m_context->getDevice(), t_node->descriptorPool, nullptr);
+                break;
+            case Type::eImageHandle:
+                if (t_node->view) m_context->getDeviceTable().vkDestroyImageView(m_context->getDevice(), t_node->view, nullptr);
+                if (t_node->image) m_context->getDeviceTable().vkDestroyImage(m_context->getDevice(), t_node->image, nullptr);
+                break;
+            case Type::eBufferHandle:
+                if (t_node->buffer) m_context->getDeviceTable().vkDestroyBuffer(m_context->getDevice(), t_node->buffer, nullptr);
+                break;
+            case Type::eMemory:
+                if (t_node->allocation) vmaFreeMemory(m_context->getAllocator(), t_node->allocation);
+                break;
+        }
+
+        m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+        m_pendingBytes.fetch_sub(t_node->bytes, std::memory_order_relaxed);
+
+        delete t_node;
+    }
+}
\ No newline at end of file
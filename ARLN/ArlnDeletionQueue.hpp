@@ -0,0 +1,72 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include <atomic>
+#include <mutex>
+
+namespace arln {
+
+    class DeletionQueue
+    {
+    public:
+        DeletionQueue() = default;
+        DeletionQueue(DeletionQueue const&) = delete;
+        DeletionQueue(DeletionQueue&&) = delete;
+        DeletionQueue& operator=(DeletionQueue const&) = delete;
+        DeletionQueue& operator=(DeletionQueue&&) = delete;
+        ~DeletionQueue() = default;
+
+        void create(Context& t_context) noexcept;
+        void teardown() noexcept;
+
+        // Safe to call from any thread
+        void push(Buffer const& t_buffer) noexcept;
+        void push(Image const& t_image) noexcept;
+        void push(Pipeline const& t_pipeline) noexcept;
+        void push(VkDescriptorPool t_pool) noexcept;
+        void push(VkImage t_image, VkImageView t_view) noexcept;
+        void push(VkBuffer t_buffer) noexcept;
+        void push(VmaAllocation t_memory) noexcept;
+        void collect(bool t_force = false) noexcept;
+
+        inline auto getPendingCount() const noexcept { return m_pendingCount.load(std::memory_order_relaxed); }
+        inline auto getPendingBytes() const noexcept { return m_pendingBytes.load(std::memory_order_relaxed); }
+
+    private:
+        enum class Type : u8
+        {
+            eBuffer,
+            eImage,
+            ePipeline,
+            eDescriptorPool,
+            eImageHandle,
+            eBufferHandle,
+            eMemory
+        };
+
+        struct Node
+        {
+            Node*            next;
+            Type             type;
+            u64              graphicsValue;
+            u64              computeValue;
+            size_t           bytes;
+            VkBuffer         buffer;
+            VkImage          image;
+            VkImageView      view;
+            VkPipeline       pipeline;
+            VkPipelineLayout layout;
+            VkDescriptorPool descriptorPool;
+            VmaAllocation    allocation;
+        };
+
+        void enqueue(Node* t_node) noexcept;
+        void destroy(Node* t_node) noexcept;
+
+        Context*            m_context     { };
+        std::atomic<Node*>  m_head        { };
+        std::mutex          m_mutex       { };
+        std::vector<Node*>  m_retiring    { };
+        std::atomic<size_t> m_pendingCount{ };
+        std::atomic<size_t> m_pendingBytes{ };
+    };
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "ArlnDescriptor.hpp"
 #include "ArlnContext.hpp"
+#include <algorithm>
 
 namespace arln {
 
@@ -15,6 +16,8 @@ namespace arln {
             VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_SAMPLER,                descriptorCount },
             VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,   descriptorCount },
             VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         descriptorCount },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, descriptorCount },
+            VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, descriptorCount },
             VkDescriptorPoolSize { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, descriptorCount }
         };
 
@@ -27,16 +30,16 @@ namespace arln {
         descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
 
         VkDescriptorPool descriptorPool;
-        if (vkCreateDescriptorPool(CurrentContext()->getDevice(), &descriptorPoolCreateInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreateDescriptorPool(m_context->getDevice(), &descriptorPoolCreateInfo, nullptr, &descriptorPool) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create descriptor pool");
+            m_context->getErrorCallback()("Failed to create descriptor pool");
         }
 
         m_pools.emplace_back(descriptorPool);
     }
 
-    DescriptorPool::DescriptorPool(std::nullptr_t) noexcept
-        : m_firstSet{ }, m_maxBindingCount{ 0 }
+    DescriptorPool::DescriptorPool(Context& t_context) noexcept
+        : m_context{ &t_context }, m_firstSet{ }, m_maxBindingCount{ 0 }
     {
         create();
     }
@@ -53,9 +56,16 @@ namespace arln {
     {
         if (t_setLayout + 1 > m_setLayouts.size())
         {
+            // Dynamic buffers can not be updated after bind, a set holding one is written before it is bound
+            bool const dynamic = std::any_of(m_bindings.begin(), m_bindings.end(), [](VkDescriptorSetLayoutBinding const& t_binding)
+            {
+                return t_binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                       t_binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+            });
+
             std::vector<VkDescriptorBindingFlags> descriptorBindingFlags(
                 m_bindings.size(),
-                VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+                dynamic ? VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT : VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
             );
 
             VkDescriptorSetLayoutBindingFlagsCreateInfo setLayoutBindingFlags;
@@ -67,14 +77,14 @@ namespace arln {
             VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
             descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
             descriptorSetLayoutCreateInfo.pNext = &setLayoutBindingFlags;
-            descriptorSetLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            descriptorSetLayoutCreateInfo.flags = dynamic ? 0 : VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
             descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(m_bindings.size());
             descriptorSetLayoutCreateInfo.pBindings = m_bindings.data();
 
             VkDescriptorSetLayout layout;
-            if (vkCreateDescriptorSetLayout(CurrentContext()->getDevice(), &descriptorSetLayoutCreateInfo, nullptr, &layout) != VK_SUCCESS)
+            if (m_context->getDeviceTable().vkCreateDescriptorSetLayout(m_context->getDevice(), &descriptorSetLayoutCreateInfo, nullptr, &layout) != VK_SUCCESS)
             {
-                CurrentContext()->getErrorCallback()("Failed to create descriptor set layout");
+                m_context->getErrorCallback()("Failed to create descriptor set layout");
             }
 
             m_setLayouts.emplace_back(layout);
@@ -90,7 +100,7 @@ namespace arln {
         descriptorSetAllocateInfo.pSetLayouts = &m_setLayouts[t_setLayout];
 
         VkDescriptorSet descriptorSet;
-        switch (vkAllocateDescriptorSets(CurrentContext()->getDevice(), &descriptorSetAllocateInfo, &descriptorSet))
+        switch (m_context->getDeviceTable().vkAllocateDescriptorSets(m_context->getDevice(), &descriptorSetAllocateInfo, &descriptorSet))
         {
         case VK_SUCCESS:
             break;
@@ -99,12 +109,15 @@ namespace arln {
             create();
             goto createDescriptorSet;
         default:
-            CurrentContext()->getErrorCallback()("Failed to allocate descriptor set");
+            m_context->getErrorCallback()("Failed to allocate descriptor set");
             break;
         }
 
+        m_context->getCapture().createDescriptor(m_pools.front(), descriptorSet, m_setLayouts[t_setLayout], t_setLayout, m_bindings);
+        m_context->getDefragmenter().createDescriptor(m_pools.front(), descriptorSet);
+
         m_bindings.clear();
-        Descriptor result = { descriptorSet, m_setLayouts[t_setLayout]};
+        Descriptor result = { m_context, descriptorSet, m_setLayouts[t_setLayout]};
         if (!m_firstSet.m_layout)
         {
             m_firstSet = result;
@@ -114,31 +127,42 @@ namespace arln {
 
     void DescriptorPool::destroy() noexcept
     {
+        m_context->getDefragmenter().releaseDescriptorPool(m_pools.front());
+
         for (auto layout : m_setLayouts)
         {
-            if (layout) vkDestroyDescriptorSetLayout(CurrentContext()->getDevice(), layout, nullptr);
+            if (layout) m_context->getDeviceTable().vkDestroyDescriptorSetLayout(m_context->getDevice(), layout, nullptr);
         }
 
         for (auto pool : m_pools)
         {
-            CurrentContext()->getFrame().addDescriptorPoolToDestroy(pool);
+            m_context->getDeletionQueue().push(pool);
         }
     }
 
     void DescriptorPool::reset() noexcept
     {
+        m_context->getCapture().resetDescriptorPool(m_pools.front());
+        m_context->getDefragmenter().releaseDescriptorPool(m_pools.front());
+
         for (auto pool : m_pools)
         {
-            vkResetDescriptorPool(CurrentContext()->getDevice(), pool, 0);
+            m_context->getDeviceTable().vkResetDescriptorPool(m_context->getDevice(), pool, 0);
         }
     }
 
     auto DescriptorWriter::addBuffer(Descriptor& t_descriptor, Buffer& t_buffer, u32 t_binding, DescriptorType t_type, u32 t_element) noexcept -> DescriptorWriter&
     {
+        return addBuffer(t_descriptor, BufferSlice{ .buffer = &t_buffer, .size = t_buffer.getAllocationInfo().size }, t_binding, t_type, t_element);
+    }
+
+    auto DescriptorWriter::addBuffer(Descriptor& t_descriptor, BufferSlice const& t_slice, u32 t_binding, DescriptorType t_type, u32 t_element) noexcept -> DescriptorWriter&
+    {
+        m_context = t_descriptor.getContext();
         m_bufferInfos.push_back(VkDescriptorBufferInfo{
-            .buffer = t_buffer.getHandle(),
-            .offset = 0,
-            .range = t_buffer.getAllocationInfo().size
+            .buffer = t_slice.buffer->getHandle(),
+            .offset = t_slice.offset,
+            .range = t_slice.size
         });
 
         VkWriteDescriptorSet descriptorWrite;
@@ -160,6 +184,7 @@ namespace arln {
 
     auto DescriptorWriter::addImage(Descriptor& t_descriptor, Image* t_image, Sampler* t_sampler, u32 t_binding, DescriptorType t_type, u32 t_element) noexcept -> DescriptorWriter&
     {
+        m_context = t_descriptor.getContext();
         m_imageInfos.emplace_back(VkDescriptorImageInfo{
             .sampler = (t_sampler) ? t_sampler->getHandle() : nullptr,
             .imageView = (t_image) ? t_image->getView() : nullptr,
@@ -185,7 +210,14 @@ namespace arln {
 
     void DescriptorWriter::write() noexcept
     {
-        vkUpdateDescriptorSets(CurrentContext()->getDevice(), static_cast<uint32_t>(m_writes.size()), m_writes.data(), 0, nullptr);
+        if (m_writes.empty())
+        {
+            return;
+        }
+
+        m_context->getCapture().writeDescriptors(m_writes);
+        m_context->getDefragmenter().writeDescriptors(m_writes);
+        m_context->getDeviceTable().vkUpdateDescriptorSets(m_context->getDevice(), static_cast<uint32_t>(m_writes.size()), m_writes.data(), 0, nullptr);
     }
 
     void DescriptorWriter::clear() noexcept
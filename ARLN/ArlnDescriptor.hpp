@@ -8,8 +8,8 @@ namespace arln {
     {
     private:
         friend class DescriptorPool;
-        Descriptor(VkDescriptorSet t_set, VkDescriptorSetLayout t_layout) noexcept
-            : m_set{ t_set }, m_layout{ t_layout } {}
+        Descriptor(Context* t_context, VkDescriptorSet t_set, VkDescriptorSetLayout t_layout) noexcept
+            : m_context{ t_context }, m_set{ t_set }, m_layout{ t_layout } {}
 
     public:
         Descriptor() = default;
@@ -19,19 +19,21 @@ namespace arln {
         Descriptor& operator=(Descriptor&&) = default;
         ~Descriptor() = default;
 
-        inline auto& getSet()    const noexcept { return m_set; }
-        inline auto& getLayout() const noexcept { return m_layout; }
+        inline auto  getContext() const noexcept { return m_context; }
+        inline auto& getSet()     const noexcept { return m_set;     }
+        inline auto& getLayout()  const noexcept { return m_layout;  }
 
     private:
-        VkDescriptorSet       m_set;
-        VkDescriptorSetLayout m_layout;
+        Context*              m_context{ };
+        VkDescriptorSet       m_set    { };
+        VkDescriptorSetLayout m_layout { };
     };
 
     class DescriptorPool
     {
     private:
         friend class Context;
-        DescriptorPool(std::nullptr_t) noexcept;
+        explicit DescriptorPool(Context& t_context) noexcept;
 
         void create() noexcept;
 
@@ -51,6 +53,7 @@ namespace arln {
         inline auto& getFirstDescriptor() noexcept { return m_firstSet; }
 
     private:
+        Context*                                  m_context{ };
         std::vector<VkDescriptorPool>             m_pools;
         std::vector<VkDescriptorSetLayout>        m_setLayouts;
         std::vector<VkDescriptorSetLayoutBinding> m_bindings;
@@ -69,11 +72,13 @@ namespace arln {
         ~DescriptorWriter() = default;
 
         auto addBuffer(Descriptor& t_descriptor, Buffer& t_buffer, u32 t_binding, DescriptorType t_type, u32 t_element = 0) noexcept -> DescriptorWriter&;
+        auto addBuffer(Descriptor& t_descriptor, BufferSlice const& t_slice, u32 t_binding, DescriptorType t_type, u32 t_element = 0) noexcept -> DescriptorWriter&;
         auto addImage(Descriptor& t_descriptor, Image* t_image, Sampler* t_sampler, u32 t_binding, DescriptorType t_type, u32 t_element = 0) noexcept -> DescriptorWriter&;
         void write() noexcept;
         void clear() noexcept;
 
     private:
+        Context*                           m_context{ };
         std::deque<VkDescriptorBufferInfo> m_bufferInfos;
         std::deque<VkDescriptorImageInfo> m_imageInfos;
         std::vector<VkWriteDescriptorSet> m_writes;
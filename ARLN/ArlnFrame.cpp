@@ -2,226 +2,949 @@
 #include "ArlnContext.hpp"
 #include "ArlnPipeline.hpp"
 #include "ArlnCommandBuffer.hpp"
+#include <cstring>
+#include <algorithm>
+#include <thread>
 
 namespace arln {
 
-    void Frame::beginFrame() noexcept
+    static auto millisecondsSince(std::chrono::steady_clock::time_point t_begin) noexcept -> f64
     {
-        m_currentFrame = m_frameContexts[m_frameIndex];
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - t_begin).count();
+    }
 
-        vkWaitForFences(CurrentContext()->getDevice(), 1, &m_currentFrame.get().renderFence, false, UINT64_MAX);
-        vkResetFences(CurrentContext()->getDevice(), 1, &m_currentFrame.get().renderFence);
+    static void sleepUntil(std::chrono::steady_clock::time_point t_deadline) noexcept
+    {
+        // Sleeps can overshoot by a scheduler tick, the last stretch is spun instead
+        auto const coarseDeadline = t_deadline - std::chrono::milliseconds(2);
 
-        for (auto& image : m_currentFrame.get().imagesToFree)
+        if (std::chrono::steady_clock::now() < coarseDeadline)
         {
-            if (image.getView()) vkDestroyImageView(CurrentContext()->getDevice(), image.getView(), nullptr);
-            if (image.getAllocation()) vmaDestroyImage(CurrentContext()->getAllocator(), image.getHandle(), image.getAllocation());
+            std::this_thread::sleep_until(coarseDeadline);
         }
 
-        for (auto& buffer : m_currentFrame.get().buffersToFree)
+        while (std::chrono::steady_clock::now() < t_deadline)
         {
-            vmaDestroyBuffer(CurrentContext()->getAllocator(), buffer.getHandle(), buffer.getAllocation());
+            std::this_thread::yield();
         }
+    }
+
+    void Frame::beginFrame() noexcept
+    {
+        m_currentFrame = &m_frameContexts[m_frameIndex];
+
+        auto const waitBegin = std::chrono::steady_clock::now();
 
-        for (auto& pipeline : m_currentFrame.get().pipelinesToFree)
+        if (m_latencyMode == LatencyMode::eLowLatency)
         {
-            if (pipeline.getHandle()) vkDestroyPipeline(CurrentContext()->getDevice(), pipeline.getHandle(), nullptr);
-            if (pipeline.getLayout()) vkDestroyPipelineLayout(CurrentContext()->getDevice(), pipeline.getLayout(), nullptr);
+            waitForPreviousFrame();
         }
 
-        for (auto pool : m_currentFrame.get().descriptorPoolsToFree)
+        m_currentFrame->renderFuture.wait();
+
+        if (m_latencyMode == LatencyMode::eThroughput && m_currentFrame->inputTime != TimePoint{ })
         {
-            if (pool) vkDestroyDescriptorPool(CurrentContext()->getDevice(), pool, nullptr);
+            // Upper bound, the frame may have finished well before this point
+            m_latencyStats.inputToPresentMilliseconds = millisecondsSince(m_currentFrame->inputTime);
+            m_latencyStats.presentWait = false;
         }
 
-        m_currentFrame.get().imagesToFree.clear();
-        m_currentFrame.get().buffersToFree.clear();
-        m_currentFrame.get().pipelinesToFree.clear();
-        m_currentFrame.get().descriptorPoolsToFree.clear();
+        limitFrameRate();
+        m_latencyStats.frameWaitMilliseconds = millisecondsSince(waitBegin);
+
+        m_profiler.beginFrame(m_frameIndex);
 
-        static auto previousWidth = CurrentContext()->getWindowWidth();
-        static auto previousHeight = CurrentContext()->getWindowHeight();
+        m_context->getDefragmenter().collect();
+        m_context->getDeletionQueue().collect();
 
-        if (previousHeight != CurrentContext()->getWindowHeight() ||
-            previousWidth != CurrentContext()->getWindowWidth())
+        if (m_previousHeight != m_context->getWindowHeight() ||
+            m_previousWidth != m_context->getWindowWidth())
         {
-            CurrentContext()->getSwapchain().recreate();
-            previousWidth = CurrentContext()->getWindowWidth();
-            previousHeight = CurrentContext()->getWindowHeight();
+            m_context->getSwapchain().recreate();
+            m_previousWidth = m_context->getWindowWidth();
+            m_previousHeight = m_context->getWindowHeight();
         }
 
-        CurrentContext()->getSwapchain().acquireNextImage(
-            m_currentFrame.get().imageAvailableSemaphore
+        m_context->getSwapchain().acquireNextImage(
+            m_currentFrame->imageAvailableSemaphore
         );
 
-        for (auto commandPool : m_currentFrame.get().commandPools)
+        m_context->getDeviceTable().vkResetCommandPool(m_context->getDevice(), m_currentFrame->uploadCommandPool, 0);
+        m_currentFrame->uploadRecording = false;
+        m_currentFrame->uploadArenaHead = 0;
+        m_currentFrame->readbackArenaHead = 0;
+        m_currentFrame->readbackRecording = false;
+        m_currentFrame->readbackFuture = nullptr;
+        m_uniformRingHead = 0;
+
+        for (auto& buffer : m_currentFrame->readbackOverflow)
+        {
+            buffer.free();
+        }
+        m_currentFrame->readbackOverflow.clear();
+
+        for (auto& set : m_commandBufferSets)
+        {
+            m_context->getDeviceTable().vkResetCommandPool(m_context->getDevice(), set->commandPools[m_frameIndex], 0);
+        }
+
+        for (auto& pool : m_threadPools)
         {
-            vkResetCommandPool(CurrentContext()->getDevice(), commandPool, 0);
+            m_context->getDeviceTable().vkResetCommandPool(m_context->getDevice(), pool->frames[m_frameIndex].commandPool, 0);
+            pool->frames[m_frameIndex].usedCount = 0;
         }
+
+        // The application samples its input once this returns
+        m_currentFrame->inputTime = std::chrono::steady_clock::now();
+        m_recording = true;
+        ++m_frameNumber;
+        m_context->getDefragmenter().beginFrame();
+        m_context->getCapture().beginFrame();
     }
 
-    void Frame::endFrame(std::span<const CommandBufferHandle> t_commandBuffers) noexcept
+    auto Frame::endFrame(
+        std::span<const CommandBufferHandle> t_commandBuffers,
+        std::span<const CommandBufferHandle> t_computeCommandBuffers,
+        PipelineStage t_computeWaitStage) noexcept -> GpuFuture
     {
+        m_profiler.endFrame();
+        flushUniformRing();
+        flushUploadArena();
+        m_context->getCapture().endFrame(t_commandBuffers, t_computeCommandBuffers, t_computeWaitStage);
+
+        auto toSubmitInfos = [](std::span<const CommandBufferHandle> t_handles)
+        {
+            std::vector<VkCommandBufferSubmitInfo> submitInfos(t_handles.size());
+
+            for (size_t i = submitInfos.size(); i--; )
+            {
+                submitInfos[i].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+                submitInfos[i].pNext = nullptr;
+                submitInfos[i].commandBuffer = t_handles[i];
+                submitInfos[i].deviceMask = 0;
+            }
+
+            return submitInfos;
+        };
+
+        auto toSemaphoreInfo = [](VkSemaphore t_semaphore, PipelineStage t_stage)
+        {
+            VkSemaphoreSubmitInfo semaphoreInfo;
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+            semaphoreInfo.pNext = nullptr;
+            semaphoreInfo.semaphore = t_semaphore;
+            semaphoreInfo.value = 0;
+            semaphoreInfo.stageMask = t_stage;
+            semaphoreInfo.deviceIndex = 0;
+
+            return semaphoreInfo;
+        };
+
+        std::vector<VkSemaphoreSubmitInfo> waitSemaphores;
+        std::vector<VkSemaphoreSubmitInfo> signalSemaphores;
+        std::vector<CommandBufferHandle>   commandBuffers;
+        GpuFuture                          uploadCommandsFuture;
+
+        auto& uploadEngine = m_context->getUploadEngine();
+
+        uploadEngine.flush();
+
+        if (uploadEngine.hasPendingAcquires())
+        {
+            beginUploadCommands();
+            uploadEngine.recordAcquireBarriers(m_currentFrame->uploadCommandBuffer);
+        }
+
+        // Taken after recording, so it covers every batch whose acquires were recorded
+        if (auto uploadFuture = uploadEngine.getFuture(); !uploadFuture.isReady())
+        {
+            waitSemaphores.emplace_back(uploadFuture.getSubmitInfo(PipelineStageBits::eAllCommands));
+        }
+
+        if (m_currentFrame->uploadRecording)
+        {
+            VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+            VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+            dependencyInfo.memoryBarrierCount = 1;
+            dependencyInfo.pMemoryBarriers = &barrier;
+
+            m_context->getDeviceTable().vkCmdPipelineBarrier2(m_currentFrame->uploadCommandBuffer, &dependencyInfo);
+            m_context->getDeviceTable().vkEndCommandBuffer(m_currentFrame->uploadCommandBuffer);
+            m_currentFrame->uploadRecording = false;
+
+            // Submitted on its own so the compute batch below can wait on the copies as well
+            auto uploadWaitSemaphores = waitSemaphores;
+            auto commandBufferInfos = toSubmitInfos({ &m_currentFrame->uploadCommandBuffer, 1 });
+
+            // Earlier compute work may still read what the copies overwrite
+            if (auto computeFuture = m_context->getComputeTimeline().getFuture(); m_context->isAsyncComputeSupported() && !computeFuture.isReady())
+            {
+                uploadWaitSemaphores.emplace_back(computeFuture.getSubmitInfo(VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT));
+            }
+
+            VkSubmitInfo2 submitInfo;
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+            submitInfo.pNext = nullptr;
+            submitInfo.flags = 0;
+            submitInfo.waitSemaphoreInfoCount = static_cast<u32>(uploadWaitSemaphores.size());
+            submitInfo.pWaitSemaphoreInfos = uploadWaitSemaphores.data();
+            submitInfo.commandBufferInfoCount = static_cast<u32>(commandBufferInfos.size());
+            submitInfo.pCommandBufferInfos = commandBufferInfos.data();
+            submitInfo.signalSemaphoreInfoCount = 0;
+            submitInfo.pSignalSemaphoreInfos = nullptr;
+
+            uploadCommandsFuture = m_context->getGraphicsTimeline().submit(m_context->getGraphicsQueue(), submitInfo, PipelineStageBits::eAllCommands);
+
+            if (!uploadCommandsFuture.isValid())
+            {
+                m_context->getErrorCallback()("Failed to submit upload command buffer");
+            }
+        }
+
+        commandBuffers.insert(commandBuffers.end(), t_commandBuffers.begin(), t_commandBuffers.end());
+
+        bool const readback = m_currentFrame->readbackRecording;
+
+        if (readback)
+        {
+            VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+            VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+            dependencyInfo.memoryBarrierCount = 1;
+            dependencyInfo.pMemoryBarriers = &barrier;
+
+            m_context->getDeviceTable().vkCmdPipelineBarrier2(m_currentFrame->readbackCommandBuffer, &dependencyInfo);
+            m_context->getDeviceTable().vkEndCommandBuffer(m_currentFrame->readbackCommandBuffer);
+            m_currentFrame->readbackRecording = false;
+
+            commandBuffers.emplace_back(m_currentFrame->readbackCommandBuffer);
+        }
+
+        if (!t_computeCommandBuffers.empty())
         {
-            VkPipelineStageFlags constexpr pipelineStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            auto computeWaitSemaphores = waitSemaphores;
+            auto commandBufferInfos = toSubmitInfos(t_computeCommandBuffers);
+
+            if (uploadCommandsFuture.isValid())
+            {
+                computeWaitSemaphores.emplace_back(uploadCommandsFuture.getSubmitInfo(PipelineStageBits::eAllCommands));
+            }
 
-            VkSubmitInfo submitInfo;
-            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            VkSubmitInfo2 submitInfo;
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
             submitInfo.pNext = nullptr;
-            submitInfo.commandBufferCount = static_cast<u32>(t_commandBuffers.size());
-            submitInfo.pCommandBuffers = t_commandBuffers.data();
-            submitInfo.pWaitDstStageMask = &pipelineStage;
-            submitInfo.waitSemaphoreCount = 1;
-            submitInfo.pWaitSemaphores = &m_currentFrame.get().imageAvailableSemaphore;
-            submitInfo.signalSemaphoreCount = 1;
-            submitInfo.pSignalSemaphores = &m_currentFrame.get().renderFinishedSemaphore;
+            submitInfo.flags = 0;
+            submitInfo.waitSemaphoreInfoCount = static_cast<u32>(computeWaitSemaphores.size());
+            submitInfo.pWaitSemaphoreInfos = computeWaitSemaphores.data();
+            submitInfo.commandBufferInfoCount = static_cast<u32>(commandBufferInfos.size());
+            submitInfo.pCommandBufferInfos = commandBufferInfos.data();
+            submitInfo.signalSemaphoreInfoCount = 0;
+            submitInfo.pSignalSemaphoreInfos = nullptr;
+
+            if (auto computeFuture = m_context->getComputeTimeline().submit(m_context->getComputeQueue(), submitInfo, PipelineStageBits::eAllCommands); computeFuture.isValid())
+            {
+                // Readback copies may read what the compute queue wrote, whatever stage the frame itself waits at
+                waitSemaphores.emplace_back(computeFuture.getSubmitInfo(readback ? t_computeWaitStage | PipelineStageBits::eTransfer : t_computeWaitStage));
+            }
+            else
+            {
+                m_context->getErrorCallback()("Failed to submit compute command buffers");
+            }
+        }
 
-            vkQueueSubmit(CurrentContext()->getGraphicsQueue(), 1, &submitInfo, m_currentFrame.get().renderFence);
+        GpuFuture renderFuture;
+
+        if (!m_context->isHeadless())
+        {
+            waitSemaphores.emplace_back(toSemaphoreInfo(m_currentFrame->imageAvailableSemaphore, PipelineStageBits::eColorAttachmentOutput));
+            signalSemaphores.emplace_back(toSemaphoreInfo(m_currentFrame->renderFinishedSemaphore, PipelineStageBits::eAllCommands));
         }
+
         {
-            VkSwapchainKHR swapchain = CurrentContext()->getSwapchain().getHandle();
-            u32 imageIndex = CurrentContext()->getSwapchain().getImageIndex();
+            auto commandBufferInfos = toSubmitInfos(commandBuffers);
+
+            VkSubmitInfo2 submitInfo;
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+            submitInfo.pNext = nullptr;
+            submitInfo.flags = 0;
+            submitInfo.waitSemaphoreInfoCount = static_cast<u32>(waitSemaphores.size());
+            submitInfo.pWaitSemaphoreInfos = waitSemaphores.data();
+            submitInfo.commandBufferInfoCount = static_cast<u32>(commandBufferInfos.size());
+            submitInfo.pCommandBufferInfos = commandBufferInfos.data();
+            submitInfo.signalSemaphoreInfoCount = static_cast<u32>(signalSemaphores.size());
+            submitInfo.pSignalSemaphoreInfos = signalSemaphores.data();
+
+            renderFuture = m_context->getGraphicsTimeline().submit(m_context->getGraphicsQueue(), submitInfo, PipelineStageBits::eAllCommands);
+
+            if (!renderFuture.isValid())
+            {
+                m_context->getErrorCallback()("Failed to submit command buffers");
+            }
+        }
+        if (!m_context->isHeadless())
+        {
+            VkSwapchainKHR swapchain = m_context->getSwapchain().getHandle();
+            u32 imageIndex = m_context->getSwapchain().getImageIndex();
+            uint64_t presentId = ++m_presentId;
+
+            VkPresentIdKHR presentIdInfo;
+            presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+            presentIdInfo.pNext = nullptr;
+            presentIdInfo.swapchainCount = 1;
+            presentIdInfo.pPresentIds = &presentId;
 
             VkPresentInfoKHR presentInfo;
             presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-            presentInfo.pNext = nullptr;
+            presentInfo.pNext = m_context->isPresentWaitSupported() ? &presentIdInfo : nullptr;
             presentInfo.waitSemaphoreCount = 1;
-            presentInfo.pWaitSemaphores = &m_currentFrame.get().renderFinishedSemaphore;
+            presentInfo.pWaitSemaphores = &m_currentFrame->renderFinishedSemaphore;
             presentInfo.swapchainCount = 1;
             presentInfo.pSwapchains = &swapchain;
             presentInfo.pImageIndices = &imageIndex;
             presentInfo.pResults = nullptr;
 
-            switch (vkQueuePresentKHR(CurrentContext()->getPresentQueue(), &presentInfo))
+            m_currentFrame->presentSwapchain = m_context->isPresentWaitSupported() ? swapchain : nullptr;
+            m_currentFrame->presentId = presentId;
+
+            VkResult result;
+            {
+                std::scoped_lock lock(m_context->getQueueMutex());
+                result = m_context->getDeviceTable().vkQueuePresentKHR(m_context->getPresentQueue(), &presentInfo);
+            }
+
+            switch (result)
             {
             case VK_SUCCESS:
                 break;
             case VK_SUBOPTIMAL_KHR:
             case VK_ERROR_OUT_OF_DATE_KHR:
-                CurrentContext()->getSwapchain().recreate();
+                m_context->getSwapchain().recreate();
                 break;
             default:
-                CurrentContext()->getErrorCallback()("Failed to present image");
+                m_context->getErrorCallback()("Failed to present image");
                 break;
             }
         }
 
-        m_frameIndex = (m_frameIndex + 1) % s_frameCount<u32>;
+        m_currentFrame->renderFuture = renderFuture;
+
+        if (m_currentFrame->readbackFuture)
+        {
+            *m_currentFrame->readbackFuture = renderFuture;
+        }
+        m_recording = false;
+        m_frameIndex = (m_frameIndex + 1) % getFrameCount();
+
+        return renderFuture;
     }
 
-    void Frame::create() noexcept
+    void Frame::create(Context& t_context, u32 t_frameCount, size_t t_uploadArenaSize, size_t t_uniformRingSize, size_t t_readbackArenaSize, u32 t_zoneCapacity) noexcept
     {
+        m_context = &t_context;
+        m_uploadArenaSize = t_uploadArenaSize;
+        m_readbackArenaSize = t_readbackArenaSize;
+        m_uniformRingSize = t_uniformRingSize;
+        m_previousWidth = m_context->getWindowWidth();
+        m_previousHeight = m_context->getWindowHeight();
+
+        m_frameContexts.resize(std::max(t_frameCount, 1u));
+
         for (auto& frame : m_frameContexts)
         {
-            VkFenceCreateInfo fenceCreateInfo;
-            fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fenceCreateInfo.pNext = nullptr;
-            fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+            createFrameContext(frame);
+        }
 
-            if (vkCreateFence(CurrentContext()->getDevice(), &fenceCreateInfo, nullptr, &frame.renderFence) != VK_SUCCESS)
-            {
-                CurrentContext()->getErrorCallback()("Failed to create vulkan fence");
-            }
+        createUniformRing();
+        m_profiler.create(t_context, getFrameCount(), t_zoneCapacity);
 
-            VkSemaphoreCreateInfo semaphoreCreateInfo;
-            semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-            semaphoreCreateInfo.pNext = nullptr;
-            semaphoreCreateInfo.flags = 0;
+        m_frameIndex = 0;
+        m_currentFrame = &m_frameContexts.back();
+    }
 
-            if (vkCreateSemaphore(CurrentContext()->getDevice(), &semaphoreCreateInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS ||
-                vkCreateSemaphore(CurrentContext()->getDevice(), &semaphoreCreateInfo, nullptr, &frame.renderFinishedSemaphore) != VK_SUCCESS)
-            {
-                CurrentContext()->getErrorCallback()("Failed to create vulkan semaphore");
-            }
+    void Frame::teardown() noexcept
+    {
+        for (auto& frame : m_frameContexts)
+        {
+            destroyFrameContext(frame);
+        }
+        m_frameContexts.clear();
+        m_uniformRing.free();
 
-            frame.stagingBuffer.recreate(0, MemoryType::eCpu, 64 * 1024 * 1024);
+        for (auto& set : m_commandBufferSets)
+        {
+            resizeCommandBufferSet(*set, 0);
         }
+        m_commandBufferSets.clear();
+
+        for (auto& pool : m_threadPools)
+        {
+            resizeThreadCommandPool(*pool, 0);
+        }
+        m_threadPools.clear();
+
+        m_profiler.teardown();
+        m_currentFrame = nullptr;
     }
 
-    void Frame::teardown() noexcept
+    void Frame::resize(u32 t_frameCount) noexcept
     {
-        for (auto& fc : m_frameContexts)
+        t_frameCount = std::max(t_frameCount, 1u);
+
+        if (t_frameCount == getFrameCount())
         {
-            fc.stagingBuffer.free();
+            return;
         }
 
-        for (auto& fc : m_frameContexts)
+        m_context->waitIdle();
+        m_context->getDeletionQueue().collect();
+
+        for (size_t i = m_frameContexts.size(); i-- > t_frameCount; )
         {
-            if (fc.renderFence) vkDestroyFence(CurrentContext()->getDevice(), fc.renderFence, nullptr);
-            if (fc.renderFinishedSemaphore) vkDestroySemaphore(CurrentContext()->getDevice(), fc.renderFinishedSemaphore, nullptr);
-            if (fc.imageAvailableSemaphore) vkDestroySemaphore(CurrentContext()->getDevice(), fc.imageAvailableSemaphore, nullptr);
+            destroyFrameContext(m_frameContexts[i]);
+        }
 
-            for (auto& image : fc.imagesToFree)
-            {
-                if (image.getView()) vkDestroyImageView(CurrentContext()->getDevice(), image.getView(), nullptr);
-                if (image.getAllocation()) vmaDestroyImage(CurrentContext()->getAllocator(), image.getHandle(), image.getAllocation());
-            }
+        size_t previousFrameCount = m_frameContexts.size();
+        m_frameContexts.resize(t_frameCount);
 
-            for (auto& buffer : fc.buffersToFree)
-            {
-                vmaDestroyBuffer(CurrentContext()->getAllocator(), buffer.getHandle(), buffer.getAllocation());
-            }
+        for (size_t i = previousFrameCount; i < m_frameContexts.size(); ++i)
+        {
+            createFrameContext(m_frameContexts[i]);
+        }
+
+        m_uniformRing.free();
+        createUniformRing();
+
+        for (auto& set : m_commandBufferSets)
+        {
+            resizeCommandBufferSet(*set, t_frameCount);
+        }
+
+        for (auto& pool : m_threadPools)
+        {
+            resizeThreadCommandPool(*pool, t_frameCount);
+        }
+
+        m_profiler.resize(t_frameCount);
+
+        m_frameIndex = 0;
+        m_currentFrame = &m_frameContexts.back();
+
+        m_context->getInfoCallback()("Frames in flight: " + std::to_string(t_frameCount));
+    }
+
+    auto Frame::allocateCommandBuffers(u32 t_queueFamilyIndex) noexcept -> CommandBuffer
+    {
+        auto set = std::make_shared<CommandBufferSet>();
+        set->queueFamilyIndex = t_queueFamilyIndex;
+
+        resizeCommandBufferSet(*set, getFrameCount());
+        m_commandBufferSets.emplace_back(set);
+
+        return CommandBuffer(*m_context, set);
+    }
+
+    auto Frame::allocateSecondaryCommandBuffer(u32 t_queueFamilyIndex) noexcept -> CommandBuffer
+    {
+        ThreadCommandPool* threadPool = nullptr;
+        {
+            std::scoped_lock lock(m_threadPoolsMutex);
+
+            auto threadId = std::this_thread::get_id();
+            auto it = std::ranges::find_if(m_threadPools, [&](auto const& t_pool) {
+                return t_pool->threadId == threadId && t_pool->queueFamilyIndex == t_queueFamilyIndex;
+            });
 
-            for (auto& pipeline : fc.pipelinesToFree)
+            if (it == m_threadPools.end())
             {
-                if (pipeline.getHandle()) vkDestroyPipeline(CurrentContext()->getDevice(), pipeline.getHandle(), nullptr);
-                if (pipeline.getLayout()) vkDestroyPipelineLayout(CurrentContext()->getDevice(), pipeline.getLayout(), nullptr);
+                auto pool = std::make_unique<ThreadCommandPool>();
+                pool->threadId = threadId;
+                pool->queueFamilyIndex = t_queueFamilyIndex;
+                resizeThreadCommandPool(*pool, getFrameCount());
+
+                it = m_threadPools.insert(m_threadPools.end(), std::move(pool));
             }
 
-            for (auto pool : fc.descriptorPoolsToFree)
+            threadPool = it->get();
+        }
+
+        // Only the owning thread touches its pool, the registry lock is not needed past this point
+        auto& frame = threadPool->frames[m_frameIndex];
+
+        if (frame.usedCount == frame.commandBuffers.size())
+        {
+            VkCommandBufferAllocateInfo allocateInfo;
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.pNext = nullptr;
+            allocateInfo.commandPool = frame.commandPool;
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocateInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer;
+            if (m_context->getDeviceTable().vkAllocateCommandBuffers(m_context->getDevice(), &allocateInfo, &commandBuffer) != VK_SUCCESS)
             {
-                if (pool) vkDestroyDescriptorPool(CurrentContext()->getDevice(), pool, nullptr);
+                m_context->getErrorCallback()("Failed to allocate secondary command buffer");
             }
+            frame.commandBuffers.emplace_back(commandBuffer);
+        }
+
+        return CommandBuffer(*m_context, frame.commandBuffers[frame.usedCount++]);
+    }
+
+    void Frame::uploadBuffer(VkBuffer t_buffer, void const* t_data, size_t t_size, size_t t_offset) noexcept
+    {
+        size_t constexpr alignment = 16;
+
+        if (!m_recording || !m_currentFrame->uploadArena.getHandle())
+        {
+            m_context->getUploadEngine().uploadBuffer(t_buffer, t_data, t_size, t_offset);
+            return;
+        }
+
+        std::scoped_lock lock(m_uploadMutex);
+
+        size_t const offset = (m_currentFrame->uploadArenaHead + alignment - 1) & ~(alignment - 1);
+
+        if (offset + t_size > m_uploadArenaSize)
+        {
+            m_context->getUploadEngine().uploadBuffer(t_buffer, t_data, t_size, t_offset);
+            return;
+        }
+
+        auto& arena = m_currentFrame->uploadArena;
+        std::memcpy(static_cast<u8*>(arena.getAllocationInfo().pMappedData) + offset, t_data, t_size);
+        m_currentFrame->uploadArenaHead = offset + t_size;
+
+        beginUploadCommands();
+
+        VkBufferCopy bufferCopy = {
+            .srcOffset = offset,
+            .dstOffset = t_offset,
+            .size = t_size
+        };
+
+        m_context->getDeviceTable().vkCmdCopyBuffer(m_currentFrame->uploadCommandBuffer, arena.getHandle(), t_buffer, 1, &bufferCopy);
+    }
+
+    auto Frame::getUploadCommandBuffer() noexcept -> VkCommandBuffer
+    {
+        std::scoped_lock lock(m_uploadMutex);
+        beginUploadCommands();
+        return m_currentFrame->uploadCommandBuffer;
+    }
+
+    void Frame::beginUploadCommands() noexcept
+    {
+        if (m_currentFrame->uploadRecording)
+        {
+            return;
+        }
+
+        VkCommandBufferBeginInfo beginInfo;
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+
+        m_context->getDeviceTable().vkBeginCommandBuffer(m_currentFrame->uploadCommandBuffer, &beginInfo);
+        m_currentFrame->uploadRecording = true;
+
+        // Earlier submissions may still read or write the destinations
+        VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+        VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        m_context->getDeviceTable().vkCmdPipelineBarrier2(m_currentFrame->uploadCommandBuffer, &dependencyInfo);
+    }
+
+    auto Frame::readbackBuffer(Buffer& t_buffer, size_t t_size, size_t t_offset) noexcept -> Readback
+    {
+        size_t offset;
+        Buffer* staging = beginReadback(t_size, offset);
+
+        if (!staging)
+        {
+            return { };
+        }
+
+        VkBufferCopy bufferCopy = {
+            .srcOffset = t_offset,
+            .dstOffset = offset,
+            .size = t_size
+        };
+
+        m_context->getDeviceTable().vkCmdCopyBuffer(m_currentFrame->readbackCommandBuffer, t_buffer.getHandle(), staging->getHandle(), 1, &bufferCopy);
+
+        return Readback(*m_context, staging->getAllocation(), static_cast<u8 const*>(staging->getAllocationInfo().pMappedData), offset, t_size, m_currentFrame->readbackFuture);
+    }
+
+    auto Frame::readbackImage(Image& t_image, BufferImageCopy const& t_copyInfo, size_t t_size) noexcept -> Readback
+    {
+        size_t offset;
+        Buffer* staging = beginReadback(t_size, offset);
+
+        if (!staging)
+        {
+            return { };
+        }
+
+        VkBufferImageCopy copy;
+        copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.imageSubresource.layerCount = 1;
+        copy.imageSubresource.mipLevel = 0;
+        copy.imageSubresource.baseArrayLayer = 0;
+        copy.bufferOffset = offset;
+        copy.bufferImageHeight = t_copyInfo.bufferImageHeight;
+        copy.bufferRowLength = t_copyInfo.bufferRowLength;
+        copy.imageOffset = { t_copyInfo.imageOffset.x, t_copyInfo.imageOffset.y, t_copyInfo.imageOffset.z };
+        copy.imageExtent = { t_copyInfo.imageExtent.x, t_copyInfo.imageExtent.y, t_copyInfo.imageExtent.z };
+
+        m_context->getDeviceTable().vkCmdCopyImageToBuffer(m_currentFrame->readbackCommandBuffer, t_image.getHandle(), static_cast<VkImageLayout>(t_copyInfo.imageLayout), staging->getHandle(), 1, &copy);
+
+        return Readback(*m_context, staging->getAllocation(), static_cast<u8 const*>(staging->getAllocationInfo().pMappedData), offset, t_size, m_currentFrame->readbackFuture);
+    }
+
+    auto Frame::beginReadback(size_t t_size, size_t& t_offset) noexcept -> Buffer*
+    {
+        size_t constexpr alignment = 16;
+
+        if (!m_recording)
+        {
+            m_context->getErrorCallback()("Failed to record readback, no frame is being recorded");
+            return nullptr;
+        }
+
+        auto& frame = *m_currentFrame;
+        Buffer* staging = &frame.readbackArena;
+        t_offset = (frame.readbackArenaHead + alignment - 1) & ~(alignment - 1);
+
+        if (!frame.readbackArena.getHandle() || t_offset + t_size > m_readbackArenaSize)
+        {
+            // Lives as long as the arena would have, until this frame slot comes around again
+            staging = &frame.readbackOverflow.emplace_back(m_context->allocateBuffer(0, MemoryType::eReadback, t_size));
+            t_offset = 0;
+        }
+        else
+        {
+            frame.readbackArenaHead = t_offset + t_size;
+        }
+
+        if (!frame.readbackFuture)
+        {
+            frame.readbackFuture = std::make_shared<GpuFuture>();
+        }
+
+        if (frame.readbackRecording)
+        {
+            return staging;
+        }
+
+        VkCommandBufferBeginInfo beginInfo;
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+
+        m_context->getDeviceTable().vkBeginCommandBuffer(frame.readbackCommandBuffer, &beginInfo);
+
+        // Submitted after the frame's command buffers, everything they wrote has to be visible to the copies
+        VkMemoryBarrier2 barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+
+        VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        m_context->getDeviceTable().vkCmdPipelineBarrier2(frame.readbackCommandBuffer, &dependencyInfo);
+        frame.readbackRecording = true;
+
+        return staging;
+    }
+
+    void Frame::setLatencyMode(LatencyMode t_mode, f64 t_frameRateLimit) noexcept
+    {
+        m_latencyMode = t_mode;
+        m_frameRateLimit = std::max(t_frameRateLimit, 0.0);
+        m_nextFrameTime = { };
+    }
+
+    void Frame::waitForPreviousFrame() noexcept
+    {
+        // Nothing is queued behind the previous frame, so input is sampled as late as the GPU allows
+        auto& previousFrame = m_frameContexts[(m_frameIndex + getFrameCount() - 1) % getFrameCount()];
 
-            for (auto pool : fc.commandPools)
+        if (previousFrame.inputTime == TimePoint{ })
+        {
+            return;
+        }
+
+        // Present ids belong to a swapchain, the wait is skipped for frames presented before a recreation
+        if (previousFrame.presentSwapchain && previousFrame.presentSwapchain == m_context->getSwapchain().getHandle())
+        {
+            VkResult result = m_context->getDeviceTable().vkWaitForPresentKHR(m_context->getDevice(), previousFrame.presentSwapchain, previousFrame.presentId, UINT64_MAX);
+
+            if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
             {
-                if (pool) vkDestroyCommandPool(CurrentContext()->getDevice(), pool, nullptr);;
+                m_latencyStats.inputToPresentMilliseconds = millisecondsSince(previousFrame.inputTime);
+                m_latencyStats.presentWait = true;
+                return;
             }
         }
+
+        // Without present feedback the end of rendering is the closest known point to the present
+        previousFrame.renderFuture.wait();
+        m_latencyStats.inputToPresentMilliseconds = millisecondsSince(previousFrame.inputTime);
+        m_latencyStats.presentWait = false;
+    }
+
+    void Frame::limitFrameRate() noexcept
+    {
+        if (m_frameRateLimit <= 0.0)
+        {
+            return;
+        }
+
+        auto const interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<f64>(1.0 / m_frameRateLimit));
+        auto const now = std::chrono::steady_clock::now();
+
+        if (now < m_nextFrameTime)
+        {
+            sleepUntil(m_nextFrameTime);
+        }
+
+        // A late frame restarts the schedule instead of rushing the following ones
+        m_nextFrameTime = std::max(m_nextFrameTime, now) + interval;
+    }
+
+    auto Frame::pushUniform(void const* t_data, size_t t_size) noexcept -> u32
+    {
+        size_t const size = (t_size + m_uniformAlignment - 1) & ~(m_uniformAlignment - 1);
+        size_t const head = m_uniformRingHead.fetch_add(size);
+
+        if (!m_uniformRing.getHandle() || head + size > m_uniformRingSize || t_size > m_uniformRange)
+        {
+            m_context->getErrorCallback()("Failed to push uniform data, the frame uniform ring is full");
+            return 0;
+        }
+
+        size_t const offset = m_frameIndex * m_uniformRingSize + head;
+        std::memcpy(static_cast<u8*>(m_uniformRing.getAllocationInfo().pMappedData) + offset, t_data, t_size);
+        m_context->getCapture().writeBuffer(m_uniformRing, t_data, t_size, offset);
+
+        return static_cast<u32>(offset);
+    }
+
+    auto Frame::getUniformSlice() noexcept -> BufferSlice
+    {
+        return BufferSlice{
+            .buffer = &m_uniformRing,
+            .size = m_uniformRange,
+            .deviceAddress = *m_uniformRing.getDeviceAddress()
+        };
+    }
+
+    void Frame::createUniformRing() noexcept
+    {
+        if (!m_uniformRingSize)
+        {
+            return;
+        }
+
+        auto& limits = m_context->getPhysicalDeviceProperties().properties.limits;
+        m_uniformAlignment = std::max<size_t>(limits.minUniformBufferOffsetAlignment, 16);
+        m_uniformRingSize = (m_uniformRingSize + m_uniformAlignment - 1) & ~(m_uniformAlignment - 1);
+        m_uniformRange = std::min<size_t>(limits.maxUniformBufferRange, m_uniformRingSize);
+
+        // One range of padding keeps the bound range of the last offset inside the buffer
+        size_t const size = m_uniformRingSize * getFrameCount() + m_uniformRange;
+        m_uniformRing = m_context->allocateBuffer(BufferUsageBits::eUniformBuffer, MemoryType::eCpu, size);
+        m_uniformRingHead = 0;
     }
 
-    auto Frame::allocateCommandBuffers() noexcept -> CommandBuffer
+    void Frame::flushUniformRing() noexcept
     {
+        size_t const head = std::min(m_uniformRingHead.load(), m_uniformRingSize);
+
+        if (!head || (m_uniformRing.getAllocationInfo().memoryType & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        {
+            return;
+        }
+
+        vmaFlushAllocation(m_context->getAllocator(), m_uniformRing.getAllocation(), m_frameIndex * m_uniformRingSize, head);
+    }
+
+    void Frame::flushUploadArena() noexcept
+    {
+        auto& arena = m_currentFrame->uploadArena;
+
+        if (!m_currentFrame->uploadArenaHead || (arena.getAllocationInfo().memoryType & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        {
+            return;
+        }
+
+        vmaFlushAllocation(m_context->getAllocator(), arena.getAllocation(), 0, m_currentFrame->uploadArenaHead);
+    }
+
+    void Frame::createFrameContext(FrameContext& t_frame) noexcept
+    {
+        VkSemaphoreCreateInfo semaphoreCreateInfo;
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCreateInfo.pNext = nullptr;
+        semaphoreCreateInfo.flags = 0;
+
+        if (m_context->getDeviceTable().vkCreateSemaphore(m_context->getDevice(), &semaphoreCreateInfo, nullptr, &t_frame.imageAvailableSemaphore) != VK_SUCCESS ||
+            m_context->getDeviceTable().vkCreateSemaphore(m_context->getDevice(), &semaphoreCreateInfo, nullptr, &t_frame.renderFinishedSemaphore) != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to create vulkan semaphore");
+        }
+
         VkCommandPoolCreateInfo commandPoolCreateInfo;
         commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         commandPoolCreateInfo.pNext = nullptr;
         commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-        commandPoolCreateInfo.queueFamilyIndex = CurrentContext()->getQueueIndex();
+        commandPoolCreateInfo.queueFamilyIndex = m_context->getQueueFamilyIndex();
 
-        std::array<VkCommandPool, s_frameCount<u32>> commandPools{};
+        if (m_context->getDeviceTable().vkCreateCommandPool(m_context->getDevice(), &commandPoolCreateInfo, nullptr, &t_frame.uploadCommandPool) != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to create command pool");
+        }
 
-        for (u32 i = s_frameCount<u32>; i--; )
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo;
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.pNext = nullptr;
+        commandBufferAllocateInfo.commandPool = t_frame.uploadCommandPool;
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferAllocateInfo.commandBufferCount = 1;
+
+        if (m_context->getDeviceTable().vkAllocateCommandBuffers(m_context->getDevice(), &commandBufferAllocateInfo, &t_frame.uploadCommandBuffer) != VK_SUCCESS ||
+            m_context->getDeviceTable().vkAllocateCommandBuffers(m_context->getDevice(), &commandBufferAllocateInfo, &t_frame.readbackCommandBuffer) != VK_SUCCESS)
         {
-            VkCommandPool commandPool;
-            if (vkCreateCommandPool(CurrentContext()->getDevice(), &commandPoolCreateInfo, nullptr, &commandPool) != VK_SUCCESS)
-            {
-                CurrentContext()->getErrorCallback()("Failed to create command pool");
-            }
-            m_frameContexts[i].commandPools.emplace_back(commandPool);
+            m_context->getErrorCallback()("Failed to allocate command buffer");
+        }
 
-            commandPools[i] = m_frameContexts[i].commandPools.back();
+        if (m_uploadArenaSize)
+        {
+            t_frame.uploadArena = m_context->allocateBuffer(0, MemoryType::eCpu, m_uploadArenaSize);
         }
 
-        return CommandBuffer(commandPools);
-    }
+        if (m_readbackArenaSize)
+        {
+            t_frame.readbackArena = m_context->allocateBuffer(0, MemoryType::eReadback, m_readbackArenaSize);
+        }
 
-    void Frame::addImageToFree(Image t_imageToFree) noexcept
-    {
-        m_currentFrame.get().imagesToFree.push_back(t_imageToFree);
+        t_frame.uploadArenaHead = 0;
+        t_frame.uploadRecording = false;
+        t_frame.readbackArenaHead = 0;
+        t_frame.readbackRecording = false;
+        t_frame.readbackFuture = nullptr;
+        t_frame.renderFuture = { };
+        t_frame.presentSwapchain = nullptr;
+        t_frame.presentId = 0;
+        t_frame.inputTime = { };
     }
 
-    void Frame::addBufferToFree(Buffer t_buffer) noexcept
+    void Frame::destroyFrameContext(FrameContext& t_frame) noexcept
     {
-        m_currentFrame.get().buffersToFree.push_back(t_buffer);
+        if (t_frame.renderFinishedSemaphore)   m_context->getDeviceTable().vkDestroySemaphore(m_context->getDevice(), t_frame.renderFinishedSemaphore, nullptr);
+        if (t_frame.imageAvailableSemaphore)   m_context->getDeviceTable().vkDestroySemaphore(m_context->getDevice(), t_frame.imageAvailableSemaphore, nullptr);
+        if (t_frame.uploadCommandPool)         m_context->getDeviceTable().vkDestroyCommandPool(m_context->getDevice(), t_frame.uploadCommandPool, nullptr);
+        if (t_frame.uploadArena.getHandle())   vmaDestroyBuffer(m_context->getAllocator(), t_frame.uploadArena.getHandle(), t_frame.uploadArena.getAllocation());
+        if (t_frame.readbackArena.getHandle()) vmaDestroyBuffer(m_context->getAllocator(), t_frame.readbackArena.getHandle(), t_frame.readbackArena.getAllocation());
+
+        for (auto& buffer : t_frame.readbackOverflow)
+        {
+            buffer.free();
+        }
+
+        t_frame.renderFinishedSemaphore = nullptr;
+        t_frame.imageAvailableSemaphore = nullptr;
+        t_frame.uploadCommandPool = nullptr;
+        t_frame.uploadCommandBuffer = nullptr;
+        t_frame.uploadArena = { };
+        t_frame.readbackCommandBuffer = nullptr;
+        t_frame.readbackArena = { };
+        t_frame.readbackOverflow.clear();
+        t_frame.readbackFuture = nullptr;
     }
 
-    void Frame::addPipelineToDestroy(Pipeline t_pipeline) noexcept
+    void Frame::resizeCommandBufferSet(CommandBufferSet& t_set, u32 t_frameCount) noexcept
     {
-        m_currentFrame.get().pipelinesToFree.push_back(t_pipeline);
+        for (size_t i = t_set.commandPools.size(); i-- > t_frameCount; )
+        {
+            m_context->getDeviceTable().vkDestroyCommandPool(m_context->getDevice(), t_set.commandPools[i], nullptr);
+        }
+
+        size_t previousFrameCount = t_set.commandPools.size();
+        t_set.commandPools.resize(t_frameCount);
+        t_set.commandBuffers.resize(t_frameCount);
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo;
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.pNext = nullptr;
+        commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        commandPoolCreateInfo.queueFamilyIndex = t_set.queueFamilyIndex;
+
+        for (size_t i = previousFrameCount; i < t_frameCount; ++i)
+        {
+            if (m_context->getDeviceTable().vkCreateCommandPool(m_context->getDevice(), &commandPoolCreateInfo, nullptr, &t_set.commandPools[i]) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to create command pool");
+            }
+
+            VkCommandBufferAllocateInfo allocateInfo;
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.pNext = nullptr;
+            allocateInfo.commandPool = t_set.commandPools[i];
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocateInfo.commandBufferCount = 1;
+
+            if (m_context->getDeviceTable().vkAllocateCommandBuffers(m_context->getDevice(), &allocateInfo, &t_set.commandBuffers[i]) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to allocate command buffer");
+            }
+        }
     }
 
-    void Frame::addDescriptorPoolToDestroy(VkDescriptorPool t_pool) noexcept
+    void Frame::resizeThreadCommandPool(ThreadCommandPool& t_pool, u32 t_frameCount) noexcept
     {
-        m_currentFrame.get().descriptorPoolsToFree.push_back(t_pool);
+        for (size_t i = t_pool.frames.size(); i-- > t_frameCount; )
+        {
+            m_context->getDeviceTable().vkDestroyCommandPool(m_context->getDevice(), t_pool.frames[i].commandPool, nullptr);
+        }
+
+        size_t previousFrameCount = t_pool.frames.size();
+        t_pool.frames.resize(t_frameCount);
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo;
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.pNext = nullptr;
+        commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        commandPoolCreateInfo.queueFamilyIndex = t_pool.queueFamilyIndex;
+
+        for (size_t i = previousFrameCount; i < t_frameCount; ++i)
+        {
+            if (m_context->getDeviceTable().vkCreateCommandPool(m_context->getDevice(), &commandPoolCreateInfo, nullptr, &t_pool.frames[i].commandPool) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to create command pool");
+            }
+            t_pool.frames[i].usedCount = 0;
+        }
     }
 }
\ No newline at end of file
@@ -3,6 +3,12 @@
 #include "ArlnPipeline.hpp"
 #include "ArlnBuffer.hpp"
 #include "ArlnImage.hpp"
+#include "ArlnSync.hpp"
+#include "ArlnProfiler.hpp"
+#include "ArlnReadback.hpp"
+#include <mutex>
+#include <atomic>
+#include <chrono>
 
 namespace arln {
 
@@ -17,39 +23,138 @@ namespace arln {
         ~Frame() = default;
 
         void beginFrame() noexcept;
-        void endFrame(std::span<const CommandBufferHandle> t_commandBuffers) noexcept;
-        void create() noexcept;
+        auto endFrame(
+            std::span<const CommandBufferHandle> t_commandBuffers,
+            std::span<const CommandBufferHandle> t_computeCommandBuffers,
+            PipelineStage t_computeWaitStage
+        ) noexcept -> GpuFuture;
+        void create(Context& t_context, u32 t_frameCount, size_t t_uploadArenaSize, size_t t_uniformRingSize, size_t t_readbackArenaSize, u32 t_zoneCapacity) noexcept;
         void teardown() noexcept;
-        auto allocateCommandBuffers() noexcept -> CommandBuffer;
-        void addImageToFree(Image t_imageToFree) noexcept;
-        void addBufferToFree(Buffer t_buffer) noexcept;
-        void addPipelineToDestroy(Pipeline t_pipeline) noexcept;
-        void addDescriptorPoolToDestroy(VkDescriptorPool t_pool) noexcept;
+        void resize(u32 t_frameCount) noexcept;
+        auto allocateCommandBuffers(u32 t_queueFamilyIndex) noexcept -> CommandBuffer;
+        auto allocateSecondaryCommandBuffer(u32 t_queueFamilyIndex) noexcept -> CommandBuffer;
+        // Copies run before all of the frame's graphics and compute commands, not at the point of the call,
+        // safe to call from several recording threads
+        void uploadBuffer(VkBuffer t_buffer, void const* t_data, size_t t_size, size_t t_offset) noexcept;
+
+        // Submitted ahead of the frame's graphics and compute command buffers, begun on first use
+        auto getUploadCommandBuffer() noexcept -> VkCommandBuffer;
+        void setLatencyMode(LatencyMode t_mode, f64 t_frameRateLimit) noexcept;
+
+        // Copies run after the frame's command buffers in the same submit, the image must be left in t_copyInfo.imageLayout
+        auto readbackBuffer(Buffer& t_buffer, size_t t_size, size_t t_offset) noexcept -> Readback;
+        auto readbackImage(Image& t_image, BufferImageCopy const& t_copyInfo, size_t t_size) noexcept -> Readback;
+
+        // Copies per-draw constants into this frame's region of the uniform ring and returns the dynamic offset
+        // to bind them with, safe to call from several recording threads
+        auto pushUniform(void const* t_data, size_t t_size) noexcept -> u32;
 
         template<typename T>
-        static constexpr T s_frameCount = static_cast<T>(2);
-        inline auto  getIndex() const   noexcept { return m_frameIndex; }
-        inline auto& getStagingBuffer() noexcept { return m_currentFrame.get().stagingBuffer; }
+        auto pushUniform(T const& t_value) noexcept -> u32 { return pushUniform(&t_value, sizeof(T)); }
+
+        // Range for an eUniformBufferDynamic binding, one descriptor covers every frame since the frame region
+        // is part of the offset. The ring is recreated when the frame count changes, descriptors must be rewritten
+        auto getUniformSlice() noexcept -> BufferSlice;
+
+        inline auto  getIndex()           const noexcept { return m_frameIndex;                             }
+        inline auto  getNumber()          const noexcept { return m_frameNumber;                            }
+        inline auto  getFrameCount()      const noexcept { return static_cast<u32>(m_frameContexts.size()); }
+        inline auto  getUploadArenaSize() const noexcept { return m_uploadArenaSize;                        }
+        inline auto  getUniformRingSize() const noexcept { return m_uniformRingSize;                        }
+        inline auto  getUniformUsage()    const noexcept { return m_uniformRingHead.load();                 }
+        inline auto& getUniformRing()           noexcept { return m_uniformRing;                            }
+        inline auto  isRecording()        const noexcept { return m_recording;                              }
+        inline auto  getLatencyMode()     const noexcept { return m_latencyMode;                            }
+        inline auto  getFrameRateLimit()  const noexcept { return m_frameRateLimit;                         }
+        inline auto& getLatencyStats()    const noexcept { return m_latencyStats;                           }
+        inline auto& getProfiler()              noexcept { return m_profiler;                               }
+        inline auto& getLatestProfile()   const noexcept { return m_profiler.getLatestProfile();           }
+
+        struct CommandBufferSet
+        {
+            std::vector<VkCommandPool>   commandPools;
+            std::vector<VkCommandBuffer> commandBuffers;
+            u32                          queueFamilyIndex;
+        };
 
     private:
+        using TimePoint      = std::chrono::steady_clock::time_point;
+        using ReadbackFuture = std::shared_ptr<GpuFuture>;
+
         struct FrameContext
         {
-            std::vector<Image>            imagesToFree;
-            std::vector<Buffer>           buffersToFree;
-            std::vector<Pipeline>         pipelinesToFree;
-            std::vector<VkDescriptorPool> descriptorPoolsToFree;
-            std::vector<VkCommandPool>    commandPools;
-            VkSemaphore                   imageAvailableSemaphore;
-            VkSemaphore                   renderFinishedSemaphore;
-            VkFence                       renderFence;
-            Buffer                        stagingBuffer;
+            Buffer              uploadArena;
+            size_t              uploadArenaHead;
+            VkCommandPool       uploadCommandPool;
+            VkCommandBuffer     uploadCommandBuffer;
+            bool                uploadRecording;
+            Buffer              readbackArena;
+            size_t              readbackArenaHead;
+            VkCommandBuffer     readbackCommandBuffer;
+            bool                readbackRecording;
+            ReadbackFuture      readbackFuture;
+            std::vector<Buffer> readbackOverflow;
+            VkSemaphore         imageAvailableSemaphore;
+            VkSemaphore         renderFinishedSemaphore;
+            GpuFuture           renderFuture;
+            VkSwapchainKHR      presentSwapchain;
+            u64                 presentId;
+            TimePoint           inputTime;
         };
 
-        using FrameContextArray = std::array<FrameContext, s_frameCount<u32>>;
-        using FrameContextRef   = std::reference_wrapper<FrameContext>;
+        void createFrameContext(FrameContext& t_frame) noexcept;
+        void destroyFrameContext(FrameContext& t_frame) noexcept;
+        struct ThreadCommandPool
+        {
+            struct PerFrame
+            {
+                VkCommandPool                commandPool;
+                std::vector<VkCommandBuffer> commandBuffers;
+                u32                          usedCount;
+            };
+
+            std::thread::id       threadId;
+            u32                   queueFamilyIndex;
+            std::vector<PerFrame> frames;
+        };
+
+        void resizeCommandBufferSet(CommandBufferSet& t_set, u32 t_frameCount) noexcept;
+        void resizeThreadCommandPool(ThreadCommandPool& t_pool, u32 t_frameCount) noexcept;
+        void beginUploadCommands() noexcept;
+        auto beginReadback(size_t t_size, size_t& t_offset) noexcept -> Buffer*;
+        void waitForPreviousFrame() noexcept;
+        void createUniformRing() noexcept;
+        void flushUniformRing() noexcept;
+        void flushUploadArena() noexcept;
+        void limitFrameRate() noexcept;
+
+        using CommandBufferSetRef  = std::shared_ptr<CommandBufferSet>;
+        using ThreadCommandPoolRef = std::unique_ptr<ThreadCommandPool>;
 
-        FrameContextArray m_frameContexts{                        };
-        FrameContextRef   m_currentFrame { m_frameContexts.back() };
-        u32               m_frameIndex   {                        };
+        Context*                          m_context          { };
+        std::vector<FrameContext>         m_frameContexts    { };
+        std::vector<CommandBufferSetRef>  m_commandBufferSets{ };
+        std::vector<ThreadCommandPoolRef> m_threadPools      { };
+        std::mutex                        m_threadPoolsMutex { };
+        std::mutex                        m_uploadMutex      { };
+        Profiler                          m_profiler         { };
+        FrameContext*                     m_currentFrame     { };
+        u32                               m_frameIndex       { };
+        u64                               m_frameNumber      { };
+        u32                               m_previousWidth    { };
+        u32                               m_previousHeight   { };
+        size_t                            m_uploadArenaSize  { };
+        size_t                            m_readbackArenaSize{ };
+        Buffer                            m_uniformRing      { };
+        std::atomic<size_t>               m_uniformRingHead  { };
+        size_t                            m_uniformRingSize  { };
+        size_t                            m_uniformAlignment { };
+        size_t                            m_uniformRange     { };
+        LatencyMode                       m_latencyMode      { };
+        f64                               m_frameRateLimit   { };
+        TimePoint                         m_nextFrameTime    { };
+        u64                               m_presentId        { };
+        LatencyStats                      m_latencyStats     { };
+        bool                              m_recording        { };
     };
 }
\ No newline at end of file
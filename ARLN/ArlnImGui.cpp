@@ -8,6 +8,7 @@ namespace arln {
 
     static struct ImGuiVulkanContext
     {
+        Context* context{};
         DescriptorPool descriptorPool;
         Descriptor descriptor;
         Pipeline pipeline;
@@ -28,12 +29,11 @@ namespace arln {
         io.Fonts->GetTexDataAsRGBA32(&fontData, &texWidth, &texHeight);
         size_t uploadSize = texHeight * texWidth * 4 * sizeof(u8);
 
-        g_imguiVulkanContext.texture = CurrentContext()->allocateImage(texWidth, texHeight, Format::eR8G8B8A8Unorm, ImageUsageBits::eSampled, arln::MemoryType::eGpuOnly);
-        g_imguiVulkanContext.texture.transition(ImageLayout::eUndefined, ImageLayout::eTransferDst, PipelineStageBits::eTopOfPipe, PipelineStageBits::eTransfer, 0, AccessBits::eTransferWrite);
+        g_imguiVulkanContext.texture = g_imguiVulkanContext.context->allocateImage(texWidth, texHeight, Format::eR8G8B8A8Unorm, ImageUsageBits::eSampled, arln::MemoryType::eGpuOnly);
         g_imguiVulkanContext.texture.writeToImage(fontData, uploadSize, {texWidth, texHeight});
         g_imguiVulkanContext.texture.transition(ImageLayout::eTransferDst, ImageLayout::eShaderReadOnly, PipelineStageBits::eTransfer, PipelineStageBits::eFragmentShader, AccessBits::eTransferWrite, AccessBits::eShaderRead);
 
-        g_imguiVulkanContext.sampler = CurrentContext()->createSampler(SamplerOptions{
+        g_imguiVulkanContext.sampler = g_imguiVulkanContext.context->createSampler(SamplerOptions{
             .magFilter = Filter::eNearest,
             .minFilter = Filter::eNearest,
             .mipmapMode = Filter::eNearest,
@@ -42,7 +42,7 @@ namespace arln {
             .addressModeW = SamplerAddressMode::eClampToEdge
         });
 
-        g_imguiVulkanContext.descriptorPool = CurrentContext()->createDescriptorPool();
+        g_imguiVulkanContext.descriptorPool = g_imguiVulkanContext.context->createDescriptorPool();
         g_imguiVulkanContext.descriptor = ImguiContext::CreateImguiImage(g_imguiVulkanContext.texture);
 
         io.Fonts->SetTexID(&g_imguiVulkanContext.descriptor);
@@ -62,7 +62,7 @@ namespace arln {
                                 << AttributeDescription{1, 0, Format::eR32G32Sfloat, static_cast<u32>(offsetof(ImDrawVert, uv)) }
                                 << AttributeDescription{2, 0, Format::eR8G8B8A8Unorm, static_cast<u32>(offsetof(ImDrawVert, col))};
 
-        g_imguiVulkanContext.pipeline = CurrentContext()->createGraphicsPipeline(pipelineInfo);
+        g_imguiVulkanContext.pipeline = g_imguiVulkanContext.context->createGraphicsPipeline(pipelineInfo);
 
         // TODO: Add support for multi viewport
         //ImGuiPlatformIO& platformIo = ImGui::GetPlatformIO();
@@ -76,8 +76,10 @@ namespace arln {
         ImGui::DockSpaceOverViewport(ImGui::GetMainViewport(), ImGuiDockNodeFlags_PassthruCentralNode);
     }
 
-    void ImguiContext::Init(Window& t_window) noexcept
+    void ImguiContext::Init(Context& t_context, Window& t_window) noexcept
     {
+        g_imguiVulkanContext.context = &t_context;
+
         ImGui::CreateContext();
 
         auto& io = ImGui::GetIO(); (void)io;
@@ -118,32 +120,43 @@ namespace arln {
 
             if (vertexBufferSize > g_imguiVulkanContext.vertexBuffer.getSize())
             {
-                g_imguiVulkanContext.vertexBuffer.recreate(
+                g_imguiVulkanContext.vertexBuffer.free();
+                g_imguiVulkanContext.vertexBuffer = g_imguiVulkanContext.context->allocateBuffer(
                     BufferUsageBits::eVertexBuffer,
                     MemoryType::eGpu,
                     vertexBufferSize
                 );
+                g_imguiVulkanContext.context->getDefragmenter().track(g_imguiVulkanContext.vertexBuffer);
             }
 
             if (indexBufferSize > g_imguiVulkanContext.indexBuffer.getSize())
             {
-                g_imguiVulkanContext.indexBuffer.recreate(
+                g_imguiVulkanContext.indexBuffer.free();
+                g_imguiVulkanContext.indexBuffer = g_imguiVulkanContext.context->allocateBuffer(
                     BufferUsageBits::eIndexBuffer,
                     MemoryType::eGpu,
                     indexBufferSize
                 );
+                g_imguiVulkanContext.context->getDefragmenter().track(g_imguiVulkanContext.indexBuffer);
             }
 
             u32 vtxOffset = 0;
             u32 idxOffset = 0;
 
+            // One flush per buffer instead of one per draw list
+            std::vector<BufferWrite> vertexWrites;
+            std::vector<BufferWrite> indexWrites;
+
             for (auto cmdList : imDrawData->CmdLists)
             {
-                g_imguiVulkanContext.vertexBuffer.writeData(cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof(ImDrawVert), vtxOffset);
-                g_imguiVulkanContext.indexBuffer.writeData(cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof(ImDrawIdx), idxOffset);
+                vertexWrites.push_back({ cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof(ImDrawVert), vtxOffset });
+                indexWrites.push_back({ cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof(ImDrawIdx), idxOffset });
                 vtxOffset += cmdList->VtxBuffer.Size * sizeof(ImDrawVert);
                 idxOffset += cmdList->IdxBuffer.Size * sizeof(ImDrawIdx);
             }
+
+            g_imguiVulkanContext.vertexBuffer.writeData(vertexWrites);
+            g_imguiVulkanContext.indexBuffer.writeData(indexWrites);
         };
 
         auto render = [&t_commandBuffer]
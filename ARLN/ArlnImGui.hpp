@@ -12,7 +12,7 @@ namespace arln {
     class ImguiContext
     {
     public:
-        static void Init(Window& t_window) noexcept;
+        static void Init(Context& t_context, Window& t_window) noexcept;
         static void Terminate() noexcept;
         static void Render(CommandBuffer& t_commandBuffer) noexcept;
         static auto CreateImguiImage(Image& t_image) noexcept -> Descriptor;
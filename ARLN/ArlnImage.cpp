@@ -3,7 +3,8 @@
 
 namespace arln {
 
-    Sampler::Sampler(SamplerOptions const& t_options) noexcept
+    Sampler::Sampler(Context& t_context, SamplerOptions const& t_options) noexcept
+        : m_context{ &t_context }
     {
         VkSamplerCreateInfo samplerCreateInfo = {};
         samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -20,23 +21,31 @@ namespace arln {
         samplerCreateInfo.compareOp = VK_COMPARE_OP_NEVER;
         samplerCreateInfo.unnormalizedCoordinates = t_options.unnormalizedCoordinates;
 
-        if (vkCreateSampler(CurrentContext()->getDevice(), &samplerCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreateSampler(m_context->getDevice(), &samplerCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create sampler");
+            m_context->getErrorCallback()("Failed to create sampler");
         }
+
+        m_context->getCapture().createSampler(*this, t_options);
     }
 
     void Sampler::destroy() noexcept
     {
-        if (m_handle) vkDestroySampler(CurrentContext()->getDevice(), m_handle, nullptr);
+        if (m_handle)
+        {
+            m_context->getCapture().freeSampler(m_handle);
+            m_context->getDeviceTable().vkDestroySampler(m_context->getDevice(), m_handle, nullptr);
+        }
     }
 
-    Image::Image(u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept
+    Image::Image(Context& t_context, u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept
+        : m_context{ &t_context }
     {
-        this->recreate(t_width, t_height, t_format, t_usage, t_memoryType);
+        this->recreate(t_context, t_width, t_height, t_format, t_usage, t_memoryType);
     }
 
-    Image::Image(VkImage t_image, VkImageView t_imageView) noexcept
+    Image::Image(Context& t_context, VkImage t_image, VkImageView t_imageView) noexcept
+        : m_context{ &t_context }
     {
         this->recreate(t_image, t_imageView);
     }
@@ -47,12 +56,19 @@ namespace arln {
 
         m_handle = t_image;
         m_view = t_imageView;
+        m_format = m_context->getDefaultColorFormat();
+        m_concurrent = false;
+        resetStates(1, 1);
     }
 
-    void Image::recreate(u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept
+    void Image::recreate(Context& t_context, u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept
     {
         this->free();
 
+        m_context = &t_context;
+
+        m_format = t_format;
+
         VkImageCreateInfo imageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
         imageCreateInfo.format = static_cast<VkFormat>(t_format);
         imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -66,6 +82,16 @@ namespace arln {
         imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | t_usage;
         imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 
+        if (auto& queueFamilyIndices = m_context->getQueueFamilyIndices();
+            queueFamilyIndices.size() > 1 && t_usage & ImageUsageBits::eStorage)
+        {
+            imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            imageCreateInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilyIndices.size());
+            imageCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+        }
+
+        m_concurrent = imageCreateInfo.sharingMode == VK_SHARING_MODE_CONCURRENT;
+
         VmaAllocationCreateInfo allocationCreateInfo{};
         allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
 
@@ -87,16 +113,55 @@ namespace arln {
             allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
                                          VMA_ALLOCATION_CREATE_MAPPED_BIT;
             break;
+        case MemoryType::eReadback:
+            allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
+                                         VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            allocationCreateInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            break;
         default:
             break;
         }
 
+        // Render targets are touched every frame and stay resident longest, VMA only applies the priority
+        // to dedicated allocations. Sampled images keep the default and are paged out before them
+        allocationCreateInfo.priority = 0.5f;
+
+        if (t_usage & (ImageUsageBits::eColorAttachment | ImageUsageBits::eDepthStencilAttachment | ImageUsageBits::eStorage))
+        {
+            allocationCreateInfo.priority = 1.0f;
+
+            if (m_context->isMemoryPrioritySupported())
+            {
+                allocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+            }
+        }
+
         VmaAllocationInfo allocationInfo;
-        if (vmaCreateImage(CurrentContext()->getAllocator(), &imageCreateInfo, &allocationCreateInfo, &m_handle, &m_allocation, &allocationInfo) != VK_SUCCESS)
+        VkResult result = vmaCreateImage(m_context->getAllocator(), &imageCreateInfo, &allocationCreateInfo, &m_handle, &m_allocation, &allocationInfo);
+
+        if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY)
         {
-            CurrentContext()->getErrorCallback()("Failed to allocate image");
+            u32 memoryTypeIndex = ~0u;
+            vmaFindMemoryTypeIndexForImageInfo(m_context->getAllocator(), &imageCreateInfo, &allocationCreateInfo, &memoryTypeIndex);
+
+            m_context->relieveMemoryPressure(memoryTypeIndex);
+            result = vmaCreateImage(m_context->getAllocator(), &imageCreateInfo, &allocationCreateInfo, &m_handle, &m_allocation, &allocationInfo);
         }
 
+        if (result != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to allocate image");
+        }
+
+        createView(t_format, t_usage);
+
+        resetStates(imageCreateInfo.mipLevels, imageCreateInfo.arrayLayers);
+
+        m_context->getCapture().createImage(*this, t_width, t_height, t_usage, t_memoryType);
+    }
+
+    void Image::createView(Format t_format, ImageUsage t_usage) noexcept
+    {
         VkImageViewCreateInfo imageViewCreateInfo;
         imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         imageViewCreateInfo.pNext = nullptr;
@@ -109,24 +174,32 @@ namespace arln {
         imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
         imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
         imageViewCreateInfo.subresourceRange = VkImageSubresourceRange{
-            .aspectMask = t_usage & ImageUsageBits::eDepthStencilAttachment ? VK_IMAGE_ASPECT_DEPTH_BIT : (u32)VK_IMAGE_ASPECT_COLOR_BIT,
+            .aspectMask = t_usage & ImageUsageBits::eDepthStencilAttachment ? (u32)VK_IMAGE_ASPECT_DEPTH_BIT : (u32)VK_IMAGE_ASPECT_COLOR_BIT,
             .baseMipLevel = 0,
             .levelCount = 1,
             .baseArrayLayer = 0,
             .layerCount = 1,
         };
 
-        if (vkCreateImageView(CurrentContext()->getDevice(), &imageViewCreateInfo, nullptr, &m_view) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreateImageView(m_context->getDevice(), &imageViewCreateInfo, nullptr, &m_view) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create image view");
+            m_context->getErrorCallback()("Failed to create image view");
         }
     }
 
+    void Image::resetStates(u32 t_mipLevels, u32 t_arrayLayers) noexcept
+    {
+        m_mipLevels = t_mipLevels;
+        m_arrayLayers = t_arrayLayers;
+        m_states = std::make_shared<std::vector<ResourceState>>(t_mipLevels * t_arrayLayers);
+    }
+
     void Image::free() noexcept
     {
         if (m_handle)
         {
-            CurrentContext()->getFrame().addImageToFree(*this);
+            m_context->getCapture().freeImage(m_handle);
+            m_context->getDeletionQueue().push(*this);
 
             m_handle     = nullptr;
             m_view       = nullptr;
@@ -136,47 +209,12 @@ namespace arln {
 
     void Image::writeToImage(void const* t_data, size_t t_dataSize, uvec2 t_size) noexcept
     {
-        if (t_dataSize > CurrentContext()->getFrame().getStagingBuffer().getSize())
-        {
-            Buffer staging;
-            staging.recreate(0, MemoryType::eCpu, t_dataSize);
-
-            staging.writeData(t_data, t_dataSize, 0);
-
-            VkBufferImageCopy copy{};
-            copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            copy.imageSubresource.layerCount = 1;
-            copy.imageExtent = {
-                .width = t_size.x,
-                .height = t_size.y,
-                .depth = 1
-            };
-
-            CurrentContext()->immediateSubmit([&](VkCommandBuffer t_cmd)
-            {
-                vkCmdCopyBufferToImage(t_cmd, staging.getHandle(), m_handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
-            });
+        m_context->getCapture().writeImage(*this, t_data, t_dataSize, t_size);
+        m_context->getUploadEngine().uploadImage(m_handle, t_data, t_dataSize, t_size, m_concurrent);
 
-            staging.free();
-        }
-        else
+        if (m_states)
         {
-            auto& staging = CurrentContext()->getFrame().getStagingBuffer();
-            staging.writeData(t_data, t_dataSize, 0);
-
-            VkBufferImageCopy copy{};
-            copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            copy.imageSubresource.layerCount = 1;
-            copy.imageExtent = {
-                .width = t_size.x,
-                .height = t_size.y,
-                .depth = 1
-            };
-
-            CurrentContext()->immediateSubmit([&](VkCommandBuffer t_cmd)
-            {
-                vkCmdCopyBufferToImage(t_cmd, staging.getHandle(), m_handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
-            });
+            (*m_states)[0].transitioned(ImageLayout::eTransferDst, PipelineStageBits::eTransfer, AccessBits::eTransferWrite);
         }
     }
 
@@ -204,9 +242,15 @@ namespace arln {
         dependencyInfo.imageMemoryBarrierCount = 1;
         dependencyInfo.pImageMemoryBarriers = &barrier;
 
-        CurrentContext()->immediateSubmit([&](VkCommandBuffer t_cmd)
+        m_context->getCapture().transitionImage(*this, t_old, t_new, t_srcStage, t_dstStage, t_srcAccess, t_dstAccess);
+        m_context->immediateSubmit([&](VkCommandBuffer t_cmd)
         {
-            vkCmdPipelineBarrier2(t_cmd, &dependencyInfo);
+            m_context->getDeviceTable().vkCmdPipelineBarrier2(t_cmd, &dependencyInfo);
         });
+
+        if (m_states)
+        {
+            (*m_states)[0].transitioned(t_new, t_dstStage, t_dstAccess);
+        }
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "ArlnUtility.hpp"
+#include "ArlnSync.hpp"
 
 namespace arln {
 
@@ -7,7 +8,7 @@ namespace arln {
     {
     private:
         friend class Context;
-        explicit Sampler(SamplerOptions const& t_options) noexcept;
+        Sampler(Context& t_context, SamplerOptions const& t_options) noexcept;
 
     public:
         Sampler() = default;
@@ -23,7 +24,8 @@ namespace arln {
         inline operator Sampler*() const noexcept { return (Sampler*)this; }
 
     private:
-        VkSampler m_handle{ };
+        Context*  m_context{ };
+        VkSampler m_handle { };
     };
 
     class Image
@@ -31,8 +33,9 @@ namespace arln {
     private:
         friend class Context;
         friend class Swapchain;
-        Image(u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept;
-        Image(VkImage t_image, VkImageView t_imageView) noexcept;
+        friend class TransientAllocator;
+        Image(Context& t_context, u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept;
+        Image(Context& t_context, VkImage t_image, VkImageView t_imageView) noexcept;
 
         void recreate(VkImage t_image, VkImageView t_imageView) noexcept;
 
@@ -44,19 +47,36 @@ namespace arln {
         Image& operator=(Image const&) = default;
         Image& operator=(Image&&) = default;
 
-        void recreate(u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept;
+        void recreate(Context& t_context, u32 t_width, u32 t_height, Format t_format, ImageUsage t_usage, MemoryType t_memoryType) noexcept;
         void free() noexcept;
         void transition(ImageLayout t_old, ImageLayout t_new, PipelineStage t_srcStage, PipelineStage t_dstStage, Access t_srcAccess, Access t_dstAccess) noexcept;
         void writeToImage(void const* t_data, size_t t_dataSize, uvec2 t_size) noexcept;
 
-        inline auto& getHandle()     const noexcept { return m_handle;     }
-        inline auto& getView()       const noexcept { return m_view;       }
-        inline auto& getAllocation() const noexcept { return m_allocation; }
-        inline operator Image*()     const noexcept { return (Image*)this; }
+        inline auto  getContext()     const noexcept { return m_context;      }
+        inline auto& getHandle()      const noexcept { return m_handle;       }
+        inline auto& getView()        const noexcept { return m_view;         }
+        inline auto& getAllocation()  const noexcept { return m_allocation;   }
+        inline auto  getFormat()      const noexcept { return m_format;       }
+        inline auto  getMipLevels()   const noexcept { return m_mipLevels;    }
+        inline auto  getArrayLayers() const noexcept { return m_arrayLayers;  }
+        inline auto  getStates()      const noexcept { return m_states.get(); }
+        inline auto  isConcurrent()   const noexcept { return m_concurrent;   }
+        inline operator Image*()      const noexcept { return (Image*)this;   }
 
     private:
-        VkImage       m_handle    { };
-        VkImageView   m_view      { };
-        VmaAllocation m_allocation{ };
+        void createView(Format t_format, ImageUsage t_usage) noexcept;
+        void resetStates(u32 t_mipLevels, u32 t_arrayLayers) noexcept;
+
+        Context*      m_context    { };
+        VkImage       m_handle     { };
+        VkImageView   m_view       { };
+        VmaAllocation m_allocation { };
+        Format        m_format     { };
+        u32           m_mipLevels  { };
+        u32           m_arrayLayers{ };
+        bool          m_concurrent { };
+
+        // One entry per mip level of every array layer, shared by all copies of the image
+        std::shared_ptr<std::vector<ResourceState>> m_states{ };
     };
 }
\ No newline at end of file
@@ -29,7 +29,8 @@ namespace arln {
         return buffer;
     }
 
-    Pipeline::Pipeline(GraphicsPipelineInfo const& t_info) noexcept
+    Pipeline::Pipeline(Context& t_context, GraphicsPipelineInfo const& t_info) noexcept
+        : m_context{ &t_context }
     {
         std::vector<VkPushConstantRange> pushConstantRanges(t_info.pushConstants.pushConstantRanges.size());
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
@@ -55,9 +56,9 @@ namespace arln {
         pipelineLayoutCreateInfo.setLayoutCount = static_cast<u32>(descriptorSetLayouts.size());
         pipelineLayoutCreateInfo.pSetLayouts = descriptorSetLayouts.data();
 
-        if (vkCreatePipelineLayout(CurrentContext()->getDevice(), &pipelineLayoutCreateInfo, nullptr, &m_layout) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreatePipelineLayout(m_context->getDevice(), &pipelineLayoutCreateInfo, nullptr, &m_layout) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create pipeline layout");
+            m_context->getErrorCallback()("Failed to create pipeline layout");
         }
 
 
@@ -81,8 +82,8 @@ namespace arln {
             fragShaderModuleCreateInfo.codeSize = fragShaderCode.size();
             fragShaderModuleCreateInfo.pCode = reinterpret_cast<const u32*>(fragShaderCode.data());
 
-            vkCreateShaderModule(CurrentContext()->getDevice(), &vertShaderModuleCreateInfo, nullptr, &vertShaderModule);
-            vkCreateShaderModule(CurrentContext()->getDevice(), &fragShaderModuleCreateInfo, nullptr, &fragShaderModule);
+            m_context->getDeviceTable().vkCreateShaderModule(m_context->getDevice(), &vertShaderModuleCreateInfo, nullptr, &vertShaderModule);
+            m_context->getDeviceTable().vkCreateShaderModule(m_context->getDevice(), &fragShaderModuleCreateInfo, nullptr, &fragShaderModule);
 
             shaderStageCreateInfos.resize(2);
             for (u32 i = 2; i--; )
@@ -107,7 +108,7 @@ namespace arln {
                 VkShaderModuleCreateInfo taskShaderModuleCreateInfo{ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
                 taskShaderModuleCreateInfo.codeSize = taskShaderCode.size();
                 taskShaderModuleCreateInfo.pCode = reinterpret_cast<const u32*>(taskShaderCode.data());
-                vkCreateShaderModule(CurrentContext()->getDevice(), &taskShaderModuleCreateInfo, nullptr, &taskShaderModule);
+                m_context->getDeviceTable().vkCreateShaderModule(m_context->getDevice(), &taskShaderModuleCreateInfo, nullptr, &taskShaderModule);
             }
 
             VkShaderModuleCreateInfo meshShaderModuleCreateInfo{ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
@@ -118,8 +119,8 @@ namespace arln {
             fragShaderModuleCreateInfo.codeSize = fragShaderCode.size();
             fragShaderModuleCreateInfo.pCode = reinterpret_cast<const u32*>(fragShaderCode.data());
 
-            vkCreateShaderModule(CurrentContext()->getDevice(), &meshShaderModuleCreateInfo, nullptr, &meshShaderModule);
-            vkCreateShaderModule(CurrentContext()->getDevice(), &fragShaderModuleCreateInfo, nullptr, &fragShaderModule);
+            m_context->getDeviceTable().vkCreateShaderModule(m_context->getDevice(), &meshShaderModuleCreateInfo, nullptr, &meshShaderModule);
+            m_context->getDeviceTable().vkCreateShaderModule(m_context->getDevice(), &fragShaderModuleCreateInfo, nullptr, &fragShaderModule);
 
             shaderStageCreateInfos.emplace_back(VkPipelineShaderStageCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -156,7 +157,7 @@ namespace arln {
         }
         else
         {
-            CurrentContext()->getErrorCallback()("Could not find any shader file while creating vulkan pipeline");
+            m_context->getErrorCallback()("Could not find any shader file while creating vulkan pipeline");
         }
 
         VkPipelineViewportStateCreateInfo viewportStateCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
@@ -208,7 +209,7 @@ namespace arln {
         }
         else
         {
-            colorFormats.emplace_back(static_cast<VkFormat>(CurrentContext()->getDefaultColorFormat()));
+            colorFormats.emplace_back(static_cast<VkFormat>(m_context->getDefaultColorFormat()));
         }
 
         VkPipelineRenderingCreateInfo renderingCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
@@ -265,24 +266,27 @@ namespace arln {
             graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssemblyStateCreateInfo;
             graphicsPipelineCreateInfo.pVertexInputState = &vertexInputStateCreateInfo;
         }
-        if (vkCreateGraphicsPipelines(CurrentContext()->getDevice(), nullptr, 1, &graphicsPipelineCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreateGraphicsPipelines(m_context->getDevice(), m_context->getPipelineCache(), 1, &graphicsPipelineCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create graphics pipeline");
+            m_context->getErrorCallback()("Failed to create graphics pipeline");
         }
 
-        if (vertShaderModule) vkDestroyShaderModule(CurrentContext()->getDevice(), vertShaderModule, nullptr);
-        if (fragShaderModule) vkDestroyShaderModule(CurrentContext()->getDevice(), fragShaderModule, nullptr);
-        if (taskShaderModule) vkDestroyShaderModule(CurrentContext()->getDevice(), taskShaderModule, nullptr);
-        if (meshShaderModule) vkDestroyShaderModule(CurrentContext()->getDevice(), meshShaderModule, nullptr);
+        if (vertShaderModule) m_context->getDeviceTable().vkDestroyShaderModule(m_context->getDevice(), vertShaderModule, nullptr);
+        if (fragShaderModule) m_context->getDeviceTable().vkDestroyShaderModule(m_context->getDevice(), fragShaderModule, nullptr);
+        if (taskShaderModule) m_context->getDeviceTable().vkDestroyShaderModule(m_context->getDevice(), taskShaderModule, nullptr);
+        if (meshShaderModule) m_context->getDeviceTable().vkDestroyShaderModule(m_context->getDevice(), meshShaderModule, nullptr);
+
+        m_context->getCapture().createPipeline(*this, t_info);
     }
 
-    Pipeline::Pipeline(ComputePipelineInfo const& t_info) noexcept
+    Pipeline::Pipeline(Context& t_context, ComputePipelineInfo const& t_info) noexcept
+        : m_context{ &t_context }
     {
         const auto compShaderCode = readFile(t_info.compShaderPath);
 
         if (compShaderCode.empty())
         {
-            CurrentContext()->getErrorCallback()(std::string("Failed to open shader file: ") + t_info.compShaderPath.data());
+            m_context->getErrorCallback()(std::string("Failed to open shader file: ") + t_info.compShaderPath.data());
         }
 
         std::vector<VkPushConstantRange> pushConstantRanges(t_info.pushConstants.pushConstantRanges.size());
@@ -309,9 +313,9 @@ namespace arln {
         pipelineLayoutCreateInfo.setLayoutCount = static_cast<u32>(descriptorSetLayouts.size());
         pipelineLayoutCreateInfo.pSetLayouts = descriptorSetLayouts.data();
 
-        if (vkCreatePipelineLayout(CurrentContext()->getDevice(), &pipelineLayoutCreateInfo, nullptr, &m_layout) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreatePipelineLayout(m_context->getDevice(), &pipelineLayoutCreateInfo, nullptr, &m_layout) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create pipeline layout");
+            m_context->getErrorCallback()("Failed to create pipeline layout");
         }
 
         VkShaderModuleCreateInfo compShaderModuleCreateInfo{ VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
@@ -319,7 +323,7 @@ namespace arln {
         compShaderModuleCreateInfo.pCode = reinterpret_cast<const u32*>(compShaderCode.data());
 
         VkShaderModule compShaderModule;
-        vkCreateShaderModule(CurrentContext()->getDevice(), &compShaderModuleCreateInfo, nullptr, &compShaderModule);
+        m_context->getDeviceTable().vkCreateShaderModule(m_context->getDevice(), &compShaderModuleCreateInfo, nullptr, &compShaderModule);
 
         VkPipelineShaderStageCreateInfo shaderStageCreateInfo;
         shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -334,17 +338,20 @@ namespace arln {
         computePipelineCreateInfo.layout = m_layout;
         computePipelineCreateInfo.stage = shaderStageCreateInfo;
 
-        if (vkCreateComputePipelines(CurrentContext()->getDevice(), nullptr, 1, &computePipelineCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreateComputePipelines(m_context->getDevice(), m_context->getPipelineCache(), 1, &computePipelineCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create compute pipeline");
+            m_context->getErrorCallback()("Failed to create compute pipeline");
         }
 
-        vkDestroyShaderModule(CurrentContext()->getDevice(), compShaderModule, nullptr);
+        m_context->getDeviceTable().vkDestroyShaderModule(m_context->getDevice(), compShaderModule, nullptr);
+
+        m_context->getCapture().createPipeline(*this, t_info);
     }
 
     void Pipeline::destroy() noexcept
     {
-        CurrentContext()->getFrame().addPipelineToDestroy(*this);
+        m_context->getCapture().destroyPipeline(m_handle);
+        m_context->getDeletionQueue().push(*this);
 
         m_layout = nullptr;
         m_handle = nullptr;
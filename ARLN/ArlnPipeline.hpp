@@ -8,8 +8,8 @@ namespace arln {
     {
     private:
         friend class Context;
-        explicit Pipeline(GraphicsPipelineInfo const& t_info) noexcept;
-        explicit Pipeline(ComputePipelineInfo const& t_info) noexcept;
+        Pipeline(Context& t_context, GraphicsPipelineInfo const& t_info) noexcept;
+        Pipeline(Context& t_context, ComputePipelineInfo const& t_info) noexcept;
 
     public:
         Pipeline() = default;
@@ -21,11 +21,13 @@ namespace arln {
 
         void destroy() noexcept;
 
-        inline auto& getHandle() const noexcept { return m_handle; }
-        inline auto& getLayout() const noexcept { return m_layout; }
+        inline auto  getContext() const noexcept { return m_context; }
+        inline auto& getHandle()  const noexcept { return m_handle;  }
+        inline auto& getLayout()  const noexcept { return m_layout;  }
 
     private:
-        VkPipeline m_handle;
-        VkPipelineLayout m_layout;
+        Context*         m_context{ };
+        VkPipeline       m_handle { };
+        VkPipelineLayout m_layout { };
     };
 }
\ No newline at end of file
@@ -0,0 +1,426 @@
+#include "ArlnProfiler.hpp"
+#include "ArlnContext.hpp"
+#include <fstream>
+#include <iomanip>
+#include <bit>
+
+namespace arln {
+
+    static auto escapeJson(std::string_view t_text) noexcept -> std::string
+    {
+        std::string escaped;
+        escaped.reserve(t_text.size());
+
+        for (char c : t_text)
+        {
+            switch (c)
+            {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n";  break;
+            case '\t': escaped += "\\t";  break;
+            default:
+                if (static_cast<u8>(c) >= 0x20)
+                {
+                    escaped += c;
+                }
+                break;
+            }
+        }
+
+        return escaped;
+    }
+
+    void Profiler::create(Context& t_context, u32 t_frameCount, u32 t_zoneCapacity) noexcept
+    {
+        m_context = &t_context;
+        m_epoch = std::chrono::steady_clock::now();
+        m_zoneCapacity = t_zoneCapacity;
+
+        auto& limits = m_context->getPhysicalDeviceProperties().properties.limits;
+        m_tickPeriod = static_cast<f64>(limits.timestampPeriod) / 1'000'000.0;
+
+        if (m_zoneCapacity && !limits.timestampComputeAndGraphics)
+        {
+            m_context->getInfoCallback()("Timestamps are not supported on all queues, GPU zones are disabled");
+            m_zoneCapacity = 0;
+        }
+
+        if (m_zoneCapacity)
+        {
+            m_statisticsFlags =
+                VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+            if (m_context->isMeshShaderQueriesSupported())
+            {
+                m_statisticsFlags |= VK_QUERY_PIPELINE_STATISTIC_TASK_SHADER_INVOCATIONS_BIT_EXT | VK_QUERY_PIPELINE_STATISTIC_MESH_SHADER_INVOCATIONS_BIT_EXT;
+            }
+        }
+
+        resize(t_frameCount);
+    }
+
+    void Profiler::teardown() noexcept
+    {
+        for (auto& frame : m_frames)
+        {
+            destroyQueries(frame);
+        }
+        m_frames.clear();
+        m_currentFrame = nullptr;
+    }
+
+    void Profiler::resize(u32 t_frameCount) noexcept
+    {
+        teardown();
+
+        m_frames.resize(t_frameCount);
+
+        for (auto& frame : m_frames)
+        {
+            createQueries(frame);
+        }
+    }
+
+    void Profiler::beginFrame(u32 t_frameIndex) noexcept
+    {
+        auto& frame = m_frames[t_frameIndex];
+
+        if (frame.frameNumber)
+        {
+            collect(frame);
+        }
+
+        if (frame.timestampPool && !frame.zones.empty())
+        {
+            m_context->getDeviceTable().vkResetQueryPool(m_context->getDevice(), frame.timestampPool, 0, static_cast<u32>(frame.zones.size()) * 2);
+        }
+
+        if (frame.statisticsPool && frame.statisticsCount)
+        {
+            m_context->getDeviceTable().vkResetQueryPool(m_context->getDevice(), frame.statisticsPool, 0, frame.statisticsCount);
+        }
+
+        frame.zones.clear();
+        frame.statisticsCount = 0;
+        frame.frameNumber = ++m_frameNumber;
+        frame.cpuBeginMilliseconds = millisecondsSinceEpoch();
+        frame.cpuEndMilliseconds = frame.cpuBeginMilliseconds;
+
+        m_currentFrame = &frame;
+    }
+
+    void Profiler::endFrame() noexcept
+    {
+        if (m_currentFrame)
+        {
+            m_currentFrame->cpuEndMilliseconds = millisecondsSinceEpoch();
+        }
+        m_currentFrame = nullptr;
+    }
+
+    auto Profiler::beginZone(VkCommandBuffer t_commandBuffer, std::string_view t_name, u32 t_depth, bool t_statistics) noexcept -> u32
+    {
+        if (!m_currentFrame || !m_currentFrame->timestampPool)
+        {
+            return ~0u;
+        }
+
+        u32 zone;
+        u32 statisticsQuery = ~0u;
+        {
+            std::scoped_lock lock(m_zoneMutex);
+
+            if (m_currentFrame->zones.size() >= m_zoneCapacity)
+            {
+                return ~0u;
+            }
+
+            if (t_statistics && m_currentFrame->statisticsPool)
+            {
+                statisticsQuery = m_currentFrame->statisticsCount++;
+            }
+
+            zone = static_cast<u32>(m_currentFrame->zones.size());
+            m_currentFrame->zones.push_back({ std::string(t_name), t_depth, statisticsQuery });
+        }
+
+        m_context->getDeviceTable().vkCmdWriteTimestamp2(t_commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_currentFrame->timestampPool, zone * 2);
+
+        if (statisticsQuery != ~0u)
+        {
+            m_context->getDeviceTable().vkCmdBeginQuery(t_commandBuffer, m_currentFrame->statisticsPool, statisticsQuery, 0);
+        }
+
+        return zone;
+    }
+
+    void Profiler::endZone(VkCommandBuffer t_commandBuffer, u32 t_zone) noexcept
+    {
+        if (!m_currentFrame || t_zone == ~0u)
+        {
+            return;
+        }
+
+        u32 statisticsQuery;
+        {
+            std::scoped_lock lock(m_zoneMutex);
+            statisticsQuery = m_currentFrame->zones[t_zone].statisticsQuery;
+        }
+
+        if (statisticsQuery != ~0u)
+        {
+            m_context->getDeviceTable().vkCmdEndQuery(t_commandBuffer, m_currentFrame->statisticsPool, statisticsQuery);
+        }
+
+        m_context->getDeviceTable().vkCmdWriteTimestamp2(t_commandBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_currentFrame->timestampPool, t_zone * 2 + 1);
+    }
+
+    auto Profiler::exportChromeTrace(std::string const& t_path) const noexcept -> bool
+    {
+        std::ofstream file(t_path, std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            m_context->getInfoCallback()("Failed to open trace file for writing: " + t_path);
+            return false;
+        }
+
+        auto writeEvent = [&](std::string_view t_name, f64 t_beginMilliseconds, f64 t_durationMilliseconds, u32 t_thread, std::string const& t_args = { })
+        {
+            file << ",\n{\"name\":\"" << escapeJson(t_name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << t_thread
+                 << ",\"ts\":" << t_beginMilliseconds * 1000.0 << ",\"dur\":" << t_durationMilliseconds * 1000.0;
+
+            if (!t_args.empty())
+            {
+                file << ",\"args\":{" << t_args << "}";
+            }
+
+            file << "}";
+        };
+
+        file << std::fixed << std::setprecision(3);
+        file << "{\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+        for (auto& profile : m_history)
+        {
+            writeEvent("Frame " + std::to_string(profile.frameNumber), profile.cpuBeginMilliseconds, profile.cpuEndMilliseconds - profile.cpuBeginMilliseconds, 0);
+
+            for (auto& zone : profile.zones)
+            {
+                std::string args;
+
+                if (zone.hasStatistics)
+                {
+                    auto& statistics = zone.statistics;
+                    args = "\"vertices\":" + std::to_string(statistics.inputAssemblyVertices)
+                        + ",\"primitives\":" + std::to_string(statistics.inputAssemblyPrimitives)
+                        + ",\"vertexInvocations\":" + std::to_string(statistics.vertexShaderInvocations)
+                        + ",\"clippingInvocations\":" + std::to_string(statistics.clippingInvocations)
+                        + ",\"clippingPrimitives\":" + std::to_string(statistics.clippingPrimitives)
+                        + ",\"fragmentInvocations\":" + std::to_string(statistics.fragmentShaderInvocations)
+                        + ",\"computeInvocations\":" + std::to_string(statistics.computeShaderInvocations)
+                        + ",\"taskInvocations\":" + std::to_string(statistics.taskShaderInvocations)
+                        + ",\"meshInvocations\":" + std::to_string(statistics.meshShaderInvocations);
+                }
+
+                writeEvent(zone.name, zone.beginMilliseconds, zone.durationMilliseconds, 1, args);
+            }
+        }
+
+        file << "\n]}\n";
+
+        return file.good();
+    }
+
+    void Profiler::createQueries(FrameQueries& t_queries) noexcept
+    {
+        t_queries.timestampPool = nullptr;
+        t_queries.statisticsPool = nullptr;
+        t_queries.statisticsCount = 0;
+        t_queries.frameNumber = 0;
+        t_queries.cpuBeginMilliseconds = 0.0;
+        t_queries.cpuEndMilliseconds = 0.0;
+
+        if (!m_zoneCapacity)
+        {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolCreateInfo;
+        queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolCreateInfo.pNext = nullptr;
+        queryPoolCreateInfo.flags = 0;
+        queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolCreateInfo.queryCount = m_zoneCapacity * 2;
+        queryPoolCreateInfo.pipelineStatistics = 0;
+
+        if (m_context->getDeviceTable().vkCreateQueryPool(m_context->getDevice(), &queryPoolCreateInfo, nullptr, &t_queries.timestampPool) != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to create timestamp query pool");
+        }
+
+        m_context->getDeviceTable().vkResetQueryPool(m_context->getDevice(), t_queries.timestampPool, 0, queryPoolCreateInfo.queryCount);
+
+        queryPoolCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        queryPoolCreateInfo.queryCount = m_zoneCapacity;
+        queryPoolCreateInfo.pipelineStatistics = m_statisticsFlags;
+
+        if (m_context->getDeviceTable().vkCreateQueryPool(m_context->getDevice(), &queryPoolCreateInfo, nullptr, &t_queries.statisticsPool) != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to create pipeline statistics query pool");
+        }
+
+        m_context->getDeviceTable().vkResetQueryPool(m_context->getDevice(), t_queries.statisticsPool, 0, queryPoolCreateInfo.queryCount);
+    }
+
+    void Profiler::destroyQueries(FrameQueries& t_queries) noexcept
+    {
+        if (t_queries.timestampPool)  m_context->getDeviceTable().vkDestroyQueryPool(m_context->getDevice(), t_queries.timestampPool, nullptr);
+        if (t_queries.statisticsPool) m_context->getDeviceTable().vkDestroyQueryPool(m_context->getDevice(), t_queries.statisticsPool, nullptr);
+
+        t_queries.timestampPool = nullptr;
+        t_queries.statisticsPool = nullptr;
+        t_queries.statisticsCount = 0;
+        t_queries.zones.clear();
+    }
+
+    void Profiler::collect(FrameQueries& t_queries) noexcept
+    {
+        FrameProfile profile;
+        profile.frameNumber = t_queries.frameNumber;
+        profile.cpuBeginMilliseconds = t_queries.cpuBeginMilliseconds;
+        profile.cpuEndMilliseconds = t_queries.cpuEndMilliseconds;
+
+        if (!t_queries.zones.empty())
+        {
+            // Each query yields its value followed by its availability
+            u32 const queryCount = static_cast<u32>(t_queries.zones.size()) * 2;
+            std::vector<u64> results(queryCount * 2);
+
+            m_context->getDeviceTable().vkGetQueryPoolResults(
+                m_context->getDevice(),
+                t_queries.timestampPool,
+                0,
+                queryCount,
+                results.size() * sizeof(u64),
+                results.data(),
+                sizeof(u64) * 2,
+                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+            );
+
+            u64 referenceTicks = ~0ull;
+            f64 referenceMilliseconds = t_queries.cpuEndMilliseconds;
+
+            if (m_context->isCalibratedTimestampsSupported())
+            {
+                VkCalibratedTimestampInfoEXT timestampInfos[2];
+                timestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+                timestampInfos[0].pNext = nullptr;
+                timestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+                timestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+                timestampInfos[1].pNext = nullptr;
+                timestampInfos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+
+                uint64_t timestamps[2];
+                uint64_t maxDeviation;
+
+                if (m_context->getDeviceTable().vkGetCalibratedTimestampsEXT(m_context->getDevice(), 2, timestampInfos, timestamps, &maxDeviation) == VK_SUCCESS)
+                {
+                    auto const epochNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(m_epoch.time_since_epoch()).count();
+
+                    referenceTicks = timestamps[0];
+                    referenceMilliseconds = static_cast<f64>(static_cast<i64>(timestamps[1]) - epochNanoseconds) / 1'000'000.0;
+                    profile.calibrated = true;
+                }
+            }
+
+            if (!profile.calibrated)
+            {
+                // Without calibration the earliest zone is pinned to the submission
+                for (u32 i = 0; i < queryCount; i += 2)
+                {
+                    if (results[i * 2 + 1])
+                    {
+                        referenceTicks = std::min(referenceTicks, results[i * 2]);
+                    }
+                }
+            }
+
+            // Values come in flag bit order, followed by the availability
+            u32 const statisticsStride = static_cast<u32>(std::popcount(m_statisticsFlags)) + 1;
+            std::vector<u64> statistics(t_queries.statisticsCount * statisticsStride);
+
+            if (t_queries.statisticsCount)
+            {
+                m_context->getDeviceTable().vkGetQueryPoolResults(
+                    m_context->getDevice(),
+                    t_queries.statisticsPool,
+                    0,
+                    t_queries.statisticsCount,
+                    statistics.size() * sizeof(u64),
+                    statistics.data(),
+                    sizeof(u64) * statisticsStride,
+                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+                );
+            }
+
+            for (u32 i = 0; i < t_queries.zones.size(); ++i)
+            {
+                u64 const* begin = &results[i * 4];
+                u64 const* end = &results[i * 4 + 2];
+
+                if (!begin[1] || !end[1])
+                {
+                    continue;
+                }
+
+                GpuZone zone;
+                zone.name = std::move(t_queries.zones[i].name);
+                zone.depth = t_queries.zones[i].depth;
+                zone.beginMilliseconds = referenceMilliseconds + static_cast<f64>(static_cast<i64>(begin[0] - referenceTicks)) * m_tickPeriod;
+                zone.durationMilliseconds = static_cast<f64>(end[0] - begin[0]) * m_tickPeriod;
+
+                if (u32 query = t_queries.zones[i].statisticsQuery; query != ~0u && statistics[query * statisticsStride + statisticsStride - 1])
+                {
+                    u64 const* value = &statistics[query * statisticsStride];
+                    auto read = [&](VkQueryPipelineStatisticFlagBits t_bit) { return m_statisticsFlags & t_bit ? *value++ : 0; };
+
+                    zone.statistics.inputAssemblyVertices = read(VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT);
+                    zone.statistics.inputAssemblyPrimitives = read(VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT);
+                    zone.statistics.vertexShaderInvocations = read(VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT);
+                    zone.statistics.clippingInvocations = read(VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT);
+                    zone.statistics.clippingPrimitives = read(VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT);
+                    zone.statistics.fragmentShaderInvocations = read(VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT);
+                    zone.statistics.computeShaderInvocations = read(VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT);
+                    zone.statistics.taskShaderInvocations = read(VK_QUERY_PIPELINE_STATISTIC_TASK_SHADER_INVOCATIONS_BIT_EXT);
+                    zone.statistics.meshShaderInvocations = read(VK_QUERY_PIPELINE_STATISTIC_MESH_SHADER_INVOCATIONS_BIT_EXT);
+                    zone.hasStatistics = true;
+                }
+
+                profile.zones.push_back(std::move(zone));
+            }
+        }
+
+        m_latestProfile = profile;
+        m_history.push_back(std::move(profile));
+
+        if (m_history.size() > s_historySize)
+        {
+            m_history.pop_front();
+        }
+    }
+
+    auto Profiler::millisecondsSinceEpoch() const noexcept -> f64
+    {
+        return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - m_epoch).count();
+    }
+}
\ No newline at end of file
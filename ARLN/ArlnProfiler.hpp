@@ -0,0 +1,75 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+namespace arln {
+
+    class Profiler
+    {
+    public:
+        Profiler() = default;
+        Profiler(Profiler const&) = delete;
+        Profiler(Profiler&&) = delete;
+        Profiler& operator=(Profiler const&) = delete;
+        Profiler& operator=(Profiler&&) = delete;
+        ~Profiler() = default;
+
+        void create(Context& t_context, u32 t_frameCount, u32 t_zoneCapacity) noexcept;
+        void teardown() noexcept;
+        void resize(u32 t_frameCount) noexcept;
+
+        void beginFrame(u32 t_frameIndex) noexcept;
+        void endFrame() noexcept;
+
+        // ~0u means the zone is not measured, statistics zones must not overlap
+        auto beginZone(VkCommandBuffer t_commandBuffer, std::string_view t_name, u32 t_depth, bool t_statistics) noexcept -> u32;
+        void endZone(VkCommandBuffer t_commandBuffer, u32 t_zone) noexcept;
+
+        auto exportChromeTrace(std::string const& t_path) const noexcept -> bool;
+
+        inline auto& getLatestProfile()   const noexcept { return m_latestProfile;     }
+        inline auto& getHistory()         const noexcept { return m_history;           }
+        inline auto  isEnabled()          const noexcept { return m_zoneCapacity != 0; }
+        inline auto  getStatisticsFlags() const noexcept { return m_statisticsFlags;   }
+
+        static constexpr size_t s_historySize = 300;
+
+    private:
+        struct PendingZone
+        {
+            std::string name;
+            u32         depth;
+            u32         statisticsQuery;
+        };
+
+        struct FrameQueries
+        {
+            VkQueryPool              timestampPool;
+            VkQueryPool              statisticsPool;
+            u32                      statisticsCount;
+            std::vector<PendingZone> zones;
+            u64                      frameNumber;
+            f64                      cpuBeginMilliseconds;
+            f64                      cpuEndMilliseconds;
+        };
+
+        void createQueries(FrameQueries& t_queries) noexcept;
+        void destroyQueries(FrameQueries& t_queries) noexcept;
+        void collect(FrameQueries& t_queries) noexcept;
+        auto millisecondsSinceEpoch() const noexcept -> f64;
+
+        Context*                              m_context        { };
+        std::vector<FrameQueries>             m_frames         { };
+        FrameQueries*                         m_currentFrame   { };
+        std::mutex                            m_zoneMutex      { };
+        std::chrono::steady_clock::time_point m_epoch          { };
+        FrameProfile                          m_latestProfile  { };
+        std::deque<FrameProfile>              m_history        { };
+        u64                                   m_frameNumber    { };
+        u32                                   m_zoneCapacity   { };
+        f64                                   m_tickPeriod     { };
+        VkQueryPipelineStatisticFlags         m_statisticsFlags{ };
+    };
+}
\ No newline at end of file
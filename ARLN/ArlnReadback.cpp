@@ -0,0 +1,50 @@
+#include "ArlnReadback.hpp"
+#include "ArlnContext.hpp"
+
+namespace arln {
+
+    Readback::Readback(Context& t_context, VmaAllocation t_allocation, u8 const* t_data, size_t t_offset, size_t t_size, std::shared_ptr<GpuFuture const> t_future) noexcept
+        : m_context{ &t_context }
+        , m_allocation{ t_allocation }
+        , m_data{ t_data }
+        , m_offset{ t_offset }
+        , m_size{ t_size }
+        , m_future{ std::move(t_future) }
+    {
+    }
+
+    auto Readback::isReady() const noexcept -> bool
+    {
+        // The future is filled in when the frame is submitted
+        return m_future && m_future->isValid() && m_future->isReady();
+    }
+
+    void Readback::wait() const noexcept
+    {
+        if (!m_future)
+        {
+            return;
+        }
+
+        if (!m_future->isValid())
+        {
+            m_context->getErrorCallback()("Failed to wait for readback, its frame has not been submitted");
+            return;
+        }
+
+        m_future->wait();
+    }
+
+    auto Readback::getData() const noexcept -> std::span<const u8>
+    {
+        if (!isReady())
+        {
+            return { };
+        }
+
+        // Host cached memory is not always coherent, the range is invalidated before every read
+        vmaInvalidateAllocation(m_context->getAllocator(), m_allocation, m_offset, m_size);
+
+        return { m_data + m_offset, m_size };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include "ArlnSync.hpp"
+#include <memory>
+
+namespace arln {
+
+    // Result of a copy recorded at the end of a frame into host cached memory. The data becomes readable once
+    // that frame has finished on the GPU and stays valid until the frame slot is reused, frames in flight later
+    class Readback
+    {
+    private:
+        friend class Frame;
+        Readback(Context& t_context, VmaAllocation t_allocation, u8 const* t_data, size_t t_offset, size_t t_size, std::shared_ptr<GpuFuture const> t_future) noexcept;
+
+    public:
+        Readback() = default;
+        ~Readback() = default;
+        Readback(Readback const&) = default;
+        Readback(Readback&&) = default;
+        Readback& operator=(Readback const&) = default;
+        Readback& operator=(Readback&&) = default;
+
+        // False until the frame holding the copy has been submitted and has finished
+        auto isReady() const noexcept -> bool;
+        void wait() const noexcept;
+
+        // Empty while the copy is still pending, never blocks
+        auto getData() const noexcept -> std::span<const u8>;
+
+        template<typename T>
+        auto getData() const noexcept -> std::span<const T>
+        {
+            auto const bytes = getData();
+            return { reinterpret_cast<T const*>(bytes.data()), bytes.size() / sizeof(T) };
+        }
+
+        inline auto getSize() const noexcept { return m_size;               }
+        inline auto isValid() const noexcept { return m_future != nullptr; }
+
+    private:
+        Context*                         m_context   { };
+        VmaAllocation                    m_allocation{ };
+        u8 const*                        m_data      { };
+        size_t                           m_offset    { };
+        size_t                           m_size      { };
+        std::shared_ptr<GpuFuture const> m_future    { };
+    };
+}
\ No newline at end of file
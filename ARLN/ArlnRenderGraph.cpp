@@ -0,0 +1,601 @@
+#include "ArlnRenderGraph.hpp"
+#include "ArlnContext.hpp"
+#include "ArlnCommandBuffer.hpp"
+#include <algorithm>
+
+namespace arln {
+
+    // Transients have no handle while passes are declared, their keys use a bit no handle or pointer sets
+    static constexpr u64 s_transientKey = 1ull << 63;
+
+    auto RenderGraph::PassBuilder::read(Image& t_image, ResourceUsage t_usage) noexcept -> PassBuilder&
+    {
+        use(m_graph->getKey(t_image), t_image, t_usage, false);
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::write(Image& t_image, ResourceUsage t_usage) noexcept -> PassBuilder&
+    {
+        use(m_graph->getKey(t_image), t_image, t_usage, true);
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::read(Buffer& t_buffer, ResourceUsage t_usage) noexcept -> PassBuilder&
+    {
+        use(m_graph->getKey(t_buffer), nullptr, t_usage, false);
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::write(Buffer& t_buffer, ResourceUsage t_usage) noexcept -> PassBuilder&
+    {
+        use(m_graph->getKey(t_buffer), nullptr, t_usage, true);
+        return *this;
+    }
+
+    auto RenderGraph::PassBuilder::sideEffect() noexcept -> PassBuilder&
+    {
+        m_pass->sideEffect = true;
+        return *this;
+    }
+
+    void RenderGraph::PassBuilder::use(u64 t_key, Image* t_image, ResourceUsage t_usage, bool t_write) noexcept
+    {
+        auto const usage = getUsageInfo(t_usage);
+
+        PassResource resource;
+        resource.handle = t_key;
+        resource.image = t_image;
+        resource.transient = t_key & s_transientKey ? static_cast<u32>(t_key & ~s_transientKey) : ~0u;
+        resource.stage = usage.stage;
+        resource.access = usage.access;
+        resource.layout = usage.layout;
+        resource.reads = usage.reads || !t_write;
+        resource.writes = usage.writes || t_write;
+
+        auto it = std::ranges::find_if(m_pass->resources, [&](PassResource const& t_resource)
+        {
+            return t_resource.handle == t_key && (t_resource.image != nullptr) == (t_image != nullptr);
+        });
+
+        if (it == m_pass->resources.end())
+        {
+            m_pass->resources.emplace_back(resource);
+            return;
+        }
+
+        if (t_image && it->layout != resource.layout)
+        {
+            m_graph->m_context->getErrorCallback()("Render graph pass \"" + m_pass->name + "\" uses an image in two different layouts");
+        }
+
+        it->stage |= resource.stage;
+        it->access |= resource.access;
+        it->reads |= resource.reads;
+        it->writes |= resource.writes;
+    }
+
+    RenderGraph::RenderGraph(Context& t_context) noexcept
+        : m_context{ &t_context }
+    {
+    }
+
+    auto RenderGraph::addPass(std::string_view t_name, std::function<void(PassBuilder&)> const& t_setup, std::function<void(CommandBuffer&)>&& t_execute) noexcept -> RenderGraph&
+    {
+        auto& pass = m_passes.emplace_back();
+        pass.name = t_name;
+        pass.execute = std::move(t_execute);
+        pass.sideEffect = false;
+        pass.live = false;
+
+        PassBuilder builder(*this, pass);
+        t_setup(builder);
+
+        return *this;
+    }
+
+    auto RenderGraph::createTransientImage(TransientImageInfo const& t_info) noexcept -> Image&
+    {
+        auto& transient = m_transients.emplace_back();
+        transient.imageInfo = t_info;
+        transient.isImage = true;
+        transient.first = ~0u;
+        transient.last = 0;
+        transient.initialized = false;
+
+        return transient.image;
+    }
+
+    auto RenderGraph::createTransientBuffer(TransientBufferInfo const& t_info) noexcept -> Buffer&
+    {
+        auto& transient = m_transients.emplace_back();
+        transient.bufferInfo = t_info;
+        transient.isImage = false;
+        transient.first = ~0u;
+        transient.last = 0;
+        transient.initialized = false;
+
+        return transient.buffer;
+    }
+
+    void RenderGraph::importImage(Image& t_image, ImageLayout t_layout, PipelineStage t_stage, Access t_access) noexcept
+    {
+        ResourceState state{ };
+        state.layout = t_layout;
+        state.writeStages = t_stage;
+        state.writeAccess = t_access;
+
+        std::ranges::fill(*t_image.getStates(), state);
+    }
+
+    void RenderGraph::exportImage(Image& t_image, ResourceUsage t_finalUsage) noexcept
+    {
+        m_exports.push_back({ getKey(t_image), t_image, t_finalUsage });
+    }
+
+    void RenderGraph::exportBuffer(Buffer& t_buffer) noexcept
+    {
+        m_exports.push_back({ getKey(t_buffer), nullptr, ResourceUsage::eNone });
+    }
+
+    void RenderGraph::execute(CommandBuffer& t_commandBuffer) noexcept
+    {
+        m_culledPassCount = 0;
+        m_barrierCount = 0;
+
+        cullPasses();
+        buildDependencies();
+
+        auto const order = schedulePasses();
+        allocateTransients(order);
+
+        std::vector<ImageTransitionInfo> transitions;
+        MemoryBarrierInfo memoryBarrier{ };
+
+        // Barriers requested outside the graph have to land before the ones recorded here
+        t_commandBuffer.flushBarriers();
+
+        auto flushBarriers = [&]
+        {
+            bool const hasMemoryBarrier = memoryBarrier.srcStageMask || memoryBarrier.srcAccessMask;
+
+            t_commandBuffer.recordBarriers(transitions, { &memoryBarrier, hasMemoryBarrier ? 1u : 0u });
+            m_barrierCount += static_cast<u32>(transitions.size()) + (hasMemoryBarrier ? 1 : 0);
+
+            transitions.clear();
+            memoryBarrier = { };
+        };
+
+        for (u32 passIndex : order)
+        {
+            auto& pass = m_passes[passIndex];
+
+            for (auto& resource : pass.resources)
+            {
+                synchronize(resource, transitions, memoryBarrier);
+            }
+
+            flushBarriers();
+
+            t_commandBuffer.beginZone(pass.name);
+            pass.execute(t_commandBuffer);
+            t_commandBuffer.endZone();
+        }
+
+        for (auto& output : m_exports)
+        {
+            if (output.finalUsage == ResourceUsage::eNone)
+            {
+                continue;
+            }
+
+            auto const usage = getUsageInfo(output.finalUsage);
+
+            PassResource resource;
+            resource.handle = output.handle;
+            resource.image = output.image;
+            resource.transient = ~0u;
+            resource.stage = usage.stage;
+            resource.access = usage.access;
+            resource.layout = usage.layout;
+            resource.reads = usage.reads;
+            resource.writes = usage.writes;
+
+            synchronize(resource, transitions, memoryBarrier);
+        }
+
+        flushBarriers();
+
+        for (u32 i = 0; i < m_transients.size(); ++i)
+        {
+            m_bufferStates.erase(s_transientKey | i);
+        }
+
+        m_passes.clear();
+        m_exports.clear();
+        m_transients.clear();
+    }
+
+    void RenderGraph::reset() noexcept
+    {
+        m_passes.clear();
+        m_exports.clear();
+        m_transients.clear();
+        m_bufferStates.clear();
+    }
+
+    void RenderGraph::destroy() noexcept
+    {
+        for (auto& allocators : m_transientAllocators)
+        {
+            for (auto& allocator : allocators)
+            {
+                allocator.destroy();
+            }
+        }
+
+        m_transientAllocators.clear();
+        reset();
+    }
+
+    auto RenderGraph::getKey(Image const& t_image) const noexcept -> u64
+    {
+        if (u32 transient = findTransient(&t_image); transient != ~0u)
+        {
+            return s_transientKey | transient;
+        }
+
+        return reinterpret_cast<u64>(t_image.getHandle());
+    }
+
+    auto RenderGraph::getKey(Buffer const& t_buffer) const noexcept -> u64
+    {
+        if (u32 transient = findTransient(&t_buffer); transient != ~0u)
+        {
+            return s_transientKey | transient;
+        }
+
+        return reinterpret_cast<u64>(t_buffer.getHandle());
+    }
+
+    auto RenderGraph::findTransient(void const* t_resource) const noexcept -> u32
+    {
+        for (u32 i = 0; i < m_transients.size(); ++i)
+        {
+            if (&m_transients[i].image == t_resource || &m_transients[i].buffer == t_resource)
+            {
+                return i;
+            }
+        }
+
+        return ~0u;
+    }
+
+    void RenderGraph::cullPasses() noexcept
+    {
+        std::unordered_map<u64, u32> imageWriters;
+        std::unordered_map<u64, u32> bufferWriters;
+
+        for (u32 i = 0; i < m_passes.size(); ++i)
+        {
+            auto& pass = m_passes[i];
+
+            for (auto& resource : pass.resources)
+            {
+                auto& writers = resource.image ? imageWriters : bufferWriters;
+
+                if (auto it = writers.find(resource.handle); resource.reads && it != writers.end())
+                {
+                    pass.producers.push_back(it->second);
+                }
+            }
+
+            for (auto& resource : pass.resources)
+            {
+                if (resource.writes)
+                {
+                    (resource.image ? imageWriters : bufferWriters)[resource.handle] = i;
+                }
+            }
+        }
+
+        // Walk backwards from the passes with visible results, producers always come earlier
+        for (size_t i = m_passes.size(); i--; )
+        {
+            auto& pass = m_passes[i];
+
+            pass.live = pass.live || pass.sideEffect || std::ranges::any_of(pass.resources, [&](PassResource const& t_resource)
+            {
+                return t_resource.writes && std::ranges::any_of(m_exports, [&](Export const& t_export)
+                {
+                    return t_export.handle == t_resource.handle && (t_export.image != nullptr) == (t_resource.image != nullptr);
+                });
+            });
+
+            if (!pass.live)
+            {
+                ++m_culledPassCount;
+                continue;
+            }
+
+            for (u32 producer : pass.producers)
+            {
+                m_passes[producer].live = true;
+            }
+        }
+    }
+
+    void RenderGraph::buildDependencies() noexcept
+    {
+        struct Tracker
+        {
+            u32              lastConflict = ~0u;
+            std::vector<u32> readers;
+            ImageLayout      layout = ImageLayout::eUndefined;
+            bool             seen = false;
+        };
+
+        std::unordered_map<u64, Tracker> imageTrackers;
+        std::unordered_map<u64, Tracker> bufferTrackers;
+
+        for (u32 i = 0; i < m_passes.size(); ++i)
+        {
+            auto& pass = m_passes[i];
+
+            if (!pass.live)
+            {
+                continue;
+            }
+
+            for (auto& resource : pass.resources)
+            {
+                auto& tracker = (resource.image ? imageTrackers : bufferTrackers)[resource.handle];
+                bool const conflict = resource.writes || (resource.image && tracker.seen && tracker.layout != resource.layout);
+
+                if (tracker.lastConflict != ~0u && tracker.lastConflict != i)
+                {
+                    pass.dependencies.push_back(tracker.lastConflict);
+                }
+
+                if (conflict)
+                {
+                    for (u32 reader : tracker.readers)
+                    {
+                        if (reader != i) pass.dependencies.push_back(reader);
+                    }
+
+                    tracker.lastConflict = i;
+                    tracker.readers.clear();
+                }
+                else
+                {
+                    tracker.readers.push_back(i);
+                }
+
+                tracker.layout = resource.layout;
+                tracker.seen = true;
+            }
+
+            std::ranges::sort(pass.dependencies);
+            auto duplicates = std::ranges::unique(pass.dependencies);
+            pass.dependencies.erase(duplicates.begin(), duplicates.end());
+        }
+    }
+
+    auto RenderGraph::schedulePasses() noexcept -> std::vector<u32>
+    {
+        std::vector<u32> pendingCounts(m_passes.size());
+        std::vector<std::vector<u32>> dependents(m_passes.size());
+        std::vector<u32> ready;
+        std::vector<u32> order;
+
+        for (u32 i = 0; i < m_passes.size(); ++i)
+        {
+            if (!m_passes[i].live)
+            {
+                continue;
+            }
+
+            pendingCounts[i] = static_cast<u32>(m_passes[i].dependencies.size());
+
+            for (u32 dependency : m_passes[i].dependencies)
+            {
+                dependents[dependency].push_back(i);
+            }
+
+            if (pendingCounts[i] == 0)
+            {
+                ready.push_back(i);
+            }
+        }
+
+        u32 previous = ~0u;
+
+        while (!ready.empty())
+        {
+            // Prefer a pass that does not wait on the one just recorded, so the barrier between
+            // a producer and its consumer has independent work in front of it
+            auto next = std::ranges::find_if(ready, [&](u32 t_pass)
+            {
+                return !std::ranges::binary_search(m_passes[t_pass].dependencies, previous);
+            });
+
+            if (next == ready.end())
+            {
+                next = ready.begin();
+            }
+
+            previous = *next;
+            ready.erase(next);
+            order.push_back(previous);
+
+            for (u32 dependent : dependents[previous])
+            {
+                if (--pendingCounts[dependent] == 0)
+                {
+                    ready.insert(std::ranges::lower_bound(ready, dependent), dependent);
+                }
+            }
+        }
+
+        return order;
+    }
+
+    void RenderGraph::allocateTransients(std::vector<u32> const& t_order) noexcept
+    {
+        if (m_transients.empty())
+        {
+            return;
+        }
+
+        for (u32 position = 0; position < t_order.size(); ++position)
+        {
+            for (auto& resource : m_passes[t_order[position]].resources)
+            {
+                if (resource.transient != ~0u)
+                {
+                    auto& transient = m_transients[resource.transient];
+                    transient.first = std::min(transient.first, position);
+                    transient.last = std::max(transient.last, position);
+                }
+            }
+        }
+
+        // Every batch of every frame in flight owns its memory, so nothing is aliased with work still on the GPU.
+        // Keyed on the frame rather than the timeline, submits in the middle of a frame must not recycle batches
+        if (u64 frameNumber = m_context->getFrame().getNumber(); frameNumber != m_frameNumber)
+        {
+            m_frameNumber = frameNumber;
+            m_batchIndex = 0;
+        }
+
+        u32 const frameIndex = m_context->getFrame().getIndex();
+
+        if (m_transientAllocators.size() <= frameIndex)
+        {
+            m_transientAllocators.resize(frameIndex + 1);
+        }
+
+        auto& allocators = m_transientAllocators[frameIndex];
+
+        while (allocators.size() <= m_batchIndex)
+        {
+            allocators.emplace_back(m_context->createTransientAllocator());
+        }
+
+        auto& allocator = allocators[m_batchIndex++];
+        std::vector<u32> allocationToTransient;
+
+        allocator.clear();
+
+        for (u32 i = 0; i < m_transients.size(); ++i)
+        {
+            auto& transient = m_transients[i];
+
+            if (transient.first == ~0u)
+            {
+                continue;
+            }
+
+            transient.allocation = transient.isImage
+                ? allocator.addImage(transient.imageInfo, transient.first, transient.last)
+                : allocator.addBuffer(transient.bufferInfo, transient.first, transient.last);
+            allocationToTransient.push_back(i);
+        }
+
+        allocator.build();
+
+        for (u32 i : allocationToTransient)
+        {
+            auto& transient = m_transients[i];
+
+            if (transient.isImage)
+            {
+                transient.image = allocator.getImage(transient.allocation);
+            }
+            else
+            {
+                transient.buffer = allocator.getBuffer(transient.allocation);
+            }
+
+            for (u32 predecessor : allocator.getAliasPredecessors(transient.allocation))
+            {
+                transient.predecessors.push_back(allocationToTransient[predecessor]);
+            }
+        }
+
+        m_transientMemorySize = allocator.getMemorySize();
+        m_transientRequestedSize = allocator.getRequestedSize();
+    }
+
+    void RenderGraph::synchronize(PassResource const& t_resource, std::vector<ImageTransitionInfo>& t_transitions, MemoryBarrierInfo& t_memoryBarrier) noexcept
+    {
+        UsageInfo const usage{ t_resource.stage, t_resource.access, t_resource.layout, t_resource.reads, t_resource.writes };
+
+        if (t_resource.transient != ~0u && !m_transients[t_resource.transient].initialized)
+        {
+            // Aliasing barrier, the memory is taken over from transients that were last used earlier
+            auto& transient = m_transients[t_resource.transient];
+            transient.initialized = true;
+
+            ResourceState initial{ };
+
+            for (u32 predecessor : transient.predecessors)
+            {
+                auto const& previous = t_resource.image ? m_transients[predecessor].image.getStates()->front() : m_bufferStates[s_transientKey | predecessor];
+                initial.writeStages |= previous.writeStages | previous.readStages;
+                initial.writeAccess |= previous.writeAccess;
+            }
+
+            if (t_resource.image)
+            {
+                std::ranges::fill(*t_resource.image->getStates(), initial);
+            }
+            else
+            {
+                m_bufferStates[t_resource.handle] = initial;
+            }
+        }
+
+        if (!t_resource.image)
+        {
+            MemoryBarrierInfo barrier;
+
+            if (m_bufferStates[t_resource.handle].access(usage, false, barrier))
+            {
+                t_memoryBarrier.srcStageMask |= barrier.srcStageMask;
+                t_memoryBarrier.dstStageMask |= barrier.dstStageMask;
+                t_memoryBarrier.srcAccessMask |= barrier.srcAccessMask;
+                t_memoryBarrier.dstAccessMask |= barrier.dstAccessMask;
+            }
+            return;
+        }
+
+        auto& states = *t_resource.image->getStates();
+        u32 const mipLevels = t_resource.image->getMipLevels();
+
+        for (u32 i = 0; i < states.size(); ++i)
+        {
+            ImageLayout const oldLayout = states[i].layout;
+            MemoryBarrierInfo barrier;
+
+            if (!states[i].access(usage, true, barrier))
+            {
+                continue;
+            }
+
+            t_transitions.push_back(ImageTransitionInfo{
+                .image = t_resource.image,
+                .oldLayout = oldLayout,
+                .newLayout = t_resource.layout,
+                .srcStageMask = barrier.srcStageMask,
+                .dstStageMask = barrier.dstStageMask,
+                .srcAccessMask = barrier.srcAccessMask,
+                .dstAccessMask = barrier.dstAccessMask,
+                .baseMipLevel = i % mipLevels,
+                .levelCount = 1,
+                .baseArrayLayer = i / mipLevels,
+                .layerCount = 1
+            });
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include "ArlnTransientAllocator.hpp"
+#include "ArlnSync.hpp"
+#include <unordered_map>
+#include <deque>
+
+namespace arln {
+
+    class RenderGraph
+    {
+    private:
+        friend class Context;
+        explicit RenderGraph(Context& t_context) noexcept;
+
+        struct PassResource
+        {
+            u64           handle;
+            Image*        image;
+            PipelineStage stage;
+            Access        access;
+            ImageLayout   layout;
+            u32           transient;
+            bool          reads;
+            bool          writes;
+        };
+
+        struct Pass
+        {
+            std::string                         name;
+            std::vector<PassResource>           resources;
+            std::function<void(CommandBuffer&)> execute;
+            std::vector<u32>                    producers;
+            std::vector<u32>                    dependencies;
+            bool                                sideEffect;
+            bool                                live;
+        };
+
+    public:
+        class PassBuilder
+        {
+        private:
+            friend class RenderGraph;
+            PassBuilder(RenderGraph& t_graph, Pass& t_pass) noexcept : m_graph{ &t_graph }, m_pass{ &t_pass } { }
+
+        public:
+            auto read(Image& t_image, ResourceUsage t_usage) noexcept -> PassBuilder&;
+            auto write(Image& t_image, ResourceUsage t_usage) noexcept -> PassBuilder&;
+            auto read(Buffer& t_buffer, ResourceUsage t_usage) noexcept -> PassBuilder&;
+            auto write(Buffer& t_buffer, ResourceUsage t_usage) noexcept -> PassBuilder&;
+
+            // Keeps the pass even if nothing reads what it writes
+            auto sideEffect() noexcept -> PassBuilder&;
+
+        private:
+            void use(u64 t_key, Image* t_image, ResourceUsage t_usage, bool t_write) noexcept;
+
+            RenderGraph* m_graph{ };
+            Pass*        m_pass { };
+        };
+
+        RenderGraph() = default;
+        ~RenderGraph() = default;
+        RenderGraph(RenderGraph const&) = delete;
+        RenderGraph(RenderGraph&&) = default;
+        RenderGraph& operator=(RenderGraph const&) = delete;
+        RenderGraph& operator=(RenderGraph&&) = default;
+
+        auto addPass(std::string_view t_name, std::function<void(PassBuilder&)> const& t_setup, std::function<void(CommandBuffer&)>&& t_execute) noexcept -> RenderGraph&;
+
+        // Transient resources only live until the end of the next execute, their memory is shared with
+        // other transients whose passes do not overlap. The handles are valid inside the pass functions
+        auto createTransientImage(TransientImageInfo const& t_info) noexcept -> Image&;
+        auto createTransientBuffer(TransientBufferInfo const& t_info) noexcept -> Buffer&;
+
+        // Overrides the tracked state of an image, e.g. a freshly acquired swapchain image or a recreated attachment
+        void importImage(Image& t_image, ImageLayout t_layout = ImageLayout::eUndefined, PipelineStage t_stage = PipelineStageBits::eNone, Access t_access = AccessBits::eNone) noexcept;
+
+        // Marks a resource as graph output, passes contributing to it are never culled.
+        // A final usage other than eNone is transitioned to after the last pass
+        void exportImage(Image& t_image, ResourceUsage t_finalUsage = ResourceUsage::eNone) noexcept;
+        void exportBuffer(Buffer& t_buffer) noexcept;
+
+        // Culls, orders and records the passes added since the last execute, the resource states persist
+        void execute(CommandBuffer& t_commandBuffer) noexcept;
+        void reset() noexcept;
+        void destroy() noexcept;
+
+        inline auto getCulledPassCount()        const noexcept { return m_culledPassCount;        }
+        inline auto getBarrierCount()           const noexcept { return m_barrierCount;           }
+        inline auto getTransientMemorySize()    const noexcept { return m_transientMemorySize;    }
+        inline auto getTransientRequestedSize() const noexcept { return m_transientRequestedSize; }
+
+    private:
+        struct Transient
+        {
+            TransientImageInfo  imageInfo;
+            TransientBufferInfo bufferInfo;
+            bool                isImage;
+            Image               image;
+            Buffer              buffer;
+            u32                 first;
+            u32                 last;
+            u32                 allocation;
+            std::vector<u32>    predecessors;
+            bool                initialized;
+        };
+
+        struct Export
+        {
+            u64           handle;
+            Image*        image;
+            ResourceUsage finalUsage;
+        };
+
+        auto getKey(Image const& t_image) const noexcept -> u64;
+        auto getKey(Buffer const& t_buffer) const noexcept -> u64;
+        auto findTransient(void const* t_resource) const noexcept -> u32;
+        void cullPasses() noexcept;
+        void buildDependencies() noexcept;
+        auto schedulePasses() noexcept -> std::vector<u32>;
+        void allocateTransients(std::vector<u32> const& t_order) noexcept;
+        void synchronize(PassResource const& t_resource, std::vector<ImageTransitionInfo>& t_transitions, MemoryBarrierInfo& t_memoryBarrier) noexcept;
+
+        Context*                                     m_context               { };
+        std::vector<Pass>                            m_passes                { };
+        std::vector<Export>                          m_exports               { };
+        std::unordered_map<u64, ResourceState>       m_bufferStates          { };
+        std::deque<Transient>                        m_transients            { };
+        std::vector<std::vector<TransientAllocator>> m_transientAllocators   { };
+        u64                                          m_frameNumber           { };
+        u32                                          m_batchIndex            { };
+        u32                                          m_culledPassCount       { };
+        u32                                          m_barrierCount          { };
+        size_t                                       m_transientMemorySize   { };
+        size_t                                       m_transientRequestedSize{ };
+    };
+}
\ No newline at end of file
@@ -6,8 +6,14 @@ namespace arln {
 
     void Swapchain::acquireNextImage(VkSemaphore t_semaphore) noexcept
     {
-        switch (vkAcquireNextImageKHR(
-            CurrentContext()->getDevice(),
+        if (m_context->isHeadless())
+        {
+            m_imageIndex = (m_imageIndex + 1) % static_cast<u32>(m_images.size());
+            return;
+        }
+
+        switch (m_context->getDeviceTable().vkAcquireNextImageKHR(
+            m_context->getDevice(),
             m_handle,
             UINT64_MAX,
             t_semaphore,
@@ -22,52 +28,58 @@ namespace arln {
             recreate();
             break;
         default:
-            CurrentContext()->getErrorCallback()("Failed to acquire swapchain image");
+            m_context->getErrorCallback()("Failed to acquire swapchain image");
             break;
         }
     }
 
-    void Swapchain::create() noexcept
+    void Swapchain::create(Context& t_context) noexcept
     {
+        m_context = &t_context;
 
+        if (m_context->isHeadless())
+        {
+            createHeadless();
+            return;
+        }
 
         VkSurfaceCapabilitiesKHR capabilities;
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(CurrentContext()->getPhysicalDevice(), CurrentContext()->getSurface(), &capabilities);
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_context->getPhysicalDevice(), m_context->getSurface(), &capabilities);
 
         VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
 
-        if (CurrentContext()->isPresentModeSupported(CurrentContext()->getSurfacePresentMode()))
+        if (m_context->isPresentModeSupported(m_context->getSurfacePresentMode()))
         {
-            presentMode = static_cast<VkPresentModeKHR>(CurrentContext()->getSurfacePresentMode());
+            presentMode = static_cast<VkPresentModeKHR>(m_context->getSurfacePresentMode());
         }
 
-        m_extent.width = std::clamp(CurrentContext()->getWindowWidth(), capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
-        m_extent.height = std::clamp(CurrentContext()->getWindowHeight(), capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+        m_extent.width = std::clamp(m_context->getWindowWidth(), capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+        m_extent.height = std::clamp(m_context->getWindowHeight(), capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
 
         VkSwapchainCreateInfoKHR swapchainCreateInfo{ VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
-        swapchainCreateInfo.minImageCount    = std::max(3u, CurrentContext()->getSurfaceCapabilities().minImageCount);
+        swapchainCreateInfo.minImageCount    = std::max(3u, m_context->getSurfaceCapabilities().minImageCount);
         swapchainCreateInfo.preTransform     = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
         swapchainCreateInfo.imageUsage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
         swapchainCreateInfo.compositeAlpha   = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
         swapchainCreateInfo.imageColorSpace  = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
-        swapchainCreateInfo.surface          = CurrentContext()->getSurface();
+        swapchainCreateInfo.surface          = m_context->getSurface();
         swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        swapchainCreateInfo.imageFormat      = static_cast<VkFormat>(CurrentContext()->getDefaultColorFormat());
+        swapchainCreateInfo.imageFormat      = static_cast<VkFormat>(m_context->getDefaultColorFormat());
         swapchainCreateInfo.presentMode      = presentMode;
         swapchainCreateInfo.imageExtent      = m_extent;
         swapchainCreateInfo.oldSwapchain     = nullptr;
         swapchainCreateInfo.imageArrayLayers = 1;
         swapchainCreateInfo.clipped          = 1;
 
-        if (vkCreateSwapchainKHR(CurrentContext()->getDevice(), &swapchainCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
+        if (m_context->getDeviceTable().vkCreateSwapchainKHR(m_context->getDevice(), &swapchainCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
         {
-            CurrentContext()->getErrorCallback()("Failed to create vulkan swapchain");
+            m_context->getErrorCallback()("Failed to create vulkan swapchain");
         }
 
         u32 imageCount;
-        vkGetSwapchainImagesKHR(CurrentContext()->getDevice(), m_handle, &imageCount, nullptr);
+        m_context->getDeviceTable().vkGetSwapchainImagesKHR(m_context->getDevice(), m_handle, &imageCount, nullptr);
         std::vector<VkImage> images(imageCount);
-        vkGetSwapchainImagesKHR(CurrentContext()->getDevice(), m_handle, &imageCount, images.data());
+        m_context->getDeviceTable().vkGetSwapchainImagesKHR(m_context->getDevice(), m_handle, &imageCount, images.data());
 
         bool isImageVectorEmpty = m_images.empty();
 
@@ -78,7 +90,7 @@ namespace arln {
             imageViewCreateInfo.pNext = nullptr;
             imageViewCreateInfo.flags = 0;
             imageViewCreateInfo.image = images[i];
-            imageViewCreateInfo.format = static_cast<VkFormat>(CurrentContext()->getDefaultColorFormat());
+            imageViewCreateInfo.format = static_cast<VkFormat>(m_context->getDefaultColorFormat());
             imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
             imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
             imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -93,11 +105,11 @@ namespace arln {
             };
 
             VkImageView imageView;
-            vkCreateImageView(CurrentContext()->getDevice(), &imageViewCreateInfo, nullptr, &imageView);
+            m_context->getDeviceTable().vkCreateImageView(m_context->getDevice(), &imageViewCreateInfo, nullptr, &imageView);
 
             if (isImageVectorEmpty)
             {
-                m_images.push_back({images[i], imageView});
+                m_images.push_back({ *m_context, images[i], imageView });
             }
             else
             {
@@ -105,28 +117,53 @@ namespace arln {
             }
         }
 
-        CurrentContext()->getInfoCallback()(
+        m_context->getInfoCallback()(
             "Created vulkan swapchain [ width{" + std::to_string(m_extent.width)
             + "}, height{" + std::to_string(m_extent.height) + "} ]"
         );
     }
 
+    void Swapchain::createHeadless() noexcept
+    {
+        m_extent.width = std::max(m_context->getWindowWidth(), 1u);
+        m_extent.height = std::max(m_context->getWindowHeight(), 1u);
+        m_images.resize(m_context->getHeadlessImageCount());
+        m_imageIndex = 0;
+
+        for (auto& image : m_images)
+        {
+            image = m_context->allocateImage(
+                m_extent.width,
+                m_extent.height,
+                m_context->getDefaultColorFormat(),
+                ImageUsageBits::eColorAttachment,
+                MemoryType::eDedicated
+            );
+        }
+
+        m_context->getInfoCallback()(
+            "Created headless swapchain [ width{" + std::to_string(m_extent.width)
+            + "}, height{" + std::to_string(m_extent.height)
+            + "}, images{" + std::to_string(m_images.size()) + "} ]"
+        );
+    }
+
     void Swapchain::teardown() noexcept
     {
         for (auto& image : m_images)
             image.free();
 
-        if (m_handle) vkDestroySwapchainKHR(CurrentContext()->getDevice(), m_handle, nullptr);
+        if (m_handle) m_context->getDeviceTable().vkDestroySwapchainKHR(m_context->getDevice(), m_handle, nullptr);
         m_handle = nullptr;
     }
 
     void Swapchain::recreate() noexcept
     {
-        vkDeviceWaitIdle(CurrentContext()->getDevice());
+        m_context->waitIdle();
 
         teardown();
-        create();
+        create(*m_context);
 
-        CurrentContext()->getResizeCallback()(m_extent.width, m_extent.height);
+        m_context->getResizeCallback()(m_extent.width, m_extent.height);
     }
 }
\ No newline at end of file
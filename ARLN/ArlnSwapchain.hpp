@@ -15,7 +15,7 @@ namespace arln {
         ~Swapchain() = default;
 
         void acquireNextImage(VkSemaphore t_semaphore) noexcept;
-        void create() noexcept;
+        void create(Context& t_context) noexcept;
         void teardown() noexcept;
         void recreate() noexcept;
 
@@ -25,9 +25,13 @@ namespace arln {
         inline auto getImage()            -> Image&         { return m_images[m_imageIndex]; }
 
     private:
+        void createHeadless() noexcept;
+
+    private:
+        Context*                 m_context{ };
         VkSwapchainKHR           m_handle{ };
         VkExtent2D               m_extent;
         std::vector<Image>       m_images;
-        u32                      m_imageIndex;
+        u32                      m_imageIndex{ };
     };
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "ArlnSync.hpp"
+#include "ArlnContext.hpp"
+
+namespace arln {
+
+    auto getUsageInfo(ResourceUsage t_usage) noexcept -> UsageInfo
+    {
+        switch (t_usage)
+        {
+        case ResourceUsage::eColorAttachmentWrite:
+            return { PipelineStageBits::eColorAttachmentOutput, AccessBits::eColorAttachmentRead | AccessBits::eColorAttachmentWrite, ImageLayout::eColorAttachment, false, true };
+        case ResourceUsage::eDepthAttachmentWrite:
+            return { PipelineStageBits::eEarlyFragmentTests | PipelineStageBits::eLateFragmentTests, AccessBits::eDepthStencilAttachmentRead | AccessBits::eDepthStencilAttachmentWrite, ImageLayout::eDepthAttachment, false, true };
+        case ResourceUsage::eDepthAttachmentRead:
+            return { PipelineStageBits::eEarlyFragmentTests | PipelineStageBits::eLateFragmentTests, AccessBits::eDepthStencilAttachmentRead, ImageLayout::eDepthReadOnly, true, false };
+        case ResourceUsage::eFragmentSampled:
+            return { PipelineStageBits::eFragmentShader, AccessBits::eShaderSamplerRead, ImageLayout::eShaderReadOnly, true, false };
+        case ResourceUsage::eComputeSampled:
+            return { PipelineStageBits::eComputeShader, AccessBits::eShaderSamplerRead, ImageLayout::eShaderReadOnly, true, false };
+        case ResourceUsage::eComputeStorageRead:
+            return { PipelineStageBits::eComputeShader, AccessBits::eShaderStorageRead, ImageLayout::eGeneral, true, false };
+        case ResourceUsage::eComputeStorageWrite:
+            return { PipelineStageBits::eComputeShader, AccessBits::eShaderStorageWrite, ImageLayout::eGeneral, false, true };
+        case ResourceUsage::eComputeStorageReadWrite:
+            return { PipelineStageBits::eComputeShader, AccessBits::eShaderStorageRead | AccessBits::eShaderStorageWrite, ImageLayout::eGeneral, true, true };
+        case ResourceUsage::eTransferSrc:
+            return { PipelineStageBits::eTransfer, AccessBits::eTransferRead, ImageLayout::eTransferSrc, true, false };
+        case ResourceUsage::eTransferDst:
+            return { PipelineStageBits::eTransfer, AccessBits::eTransferWrite, ImageLayout::eTransferDst, false, true };
+        case ResourceUsage::ePresent:
+            return { PipelineStageBits::eColorAttachmentOutput, AccessBits::eNone, ImageLayout::ePresentSrc, true, false };
+        case ResourceUsage::eVertexBuffer:
+            return { PipelineStageBits::eVertexAttributeInput, AccessBits::eVertexAttributeRead, ImageLayout::eUndefined, true, false };
+        case ResourceUsage::eIndexBuffer:
+            return { PipelineStageBits::eIndexInput, AccessBits::eIndexRead, ImageLayout::eUndefined, true, false };
+        case ResourceUsage::eIndirectBuffer:
+            return { PipelineStageBits::eDrawIndirect, AccessBits::eIndirectCommandRead, ImageLayout::eUndefined, true, false };
+        case ResourceUsage::eUniformBuffer:
+            return { PipelineStageBits::eVertexShader | PipelineStageBits::eFragmentShader | PipelineStageBits::eComputeShader, AccessBits::eUniformRead, ImageLayout::eUndefined, true, false };
+        case ResourceUsage::eNone:
+            break;
+        }
+
+        return { PipelineStageBits::eNone, AccessBits::eNone, ImageLayout::eUndefined, false, false };
+    }
+
+    auto ResourceState::access(UsageInfo const& t_usage, bool t_image, MemoryBarrierInfo& t_barrier) noexcept -> bool
+    {
+        bool const layoutChange = t_image && layout != t_usage.layout;
+
+        if (layoutChange || t_usage.writes)
+        {
+            // Write after read only needs an execution dependency, write after write also needs availability
+            t_barrier = { writeStages | readStages, t_usage.stage, writeAccess, t_usage.access };
+
+            layout = t_usage.layout;
+            writeStages = t_usage.stage;
+            writeAccess = t_usage.writes ? t_usage.access : AccessBits::eNone;
+            readStages = t_usage.writes ? PipelineStageBits::eNone : t_usage.stage;
+            visibleStages = t_usage.writes ? PipelineStageBits::eNone : t_usage.stage;
+            visibleAccess = t_usage.writes ? AccessBits::eNone : t_usage.access;
+
+            return layoutChange || t_barrier.srcStageMask;
+        }
+
+        bool const visible = (t_usage.stage & ~visibleStages) == 0 && (t_usage.access & ~visibleAccess) == 0;
+        t_barrier = { writeStages, t_usage.stage, writeAccess, t_usage.access };
+
+        readStages |= t_usage.stage;
+        visibleStages |= t_usage.stage;
+        visibleAccess |= t_usage.access;
+
+        return !visible && t_barrier.srcStageMask;
+    }
+
+    void ResourceState::transitioned(ImageLayout t_layout, PipelineStage t_stage, Access t_access) noexcept
+    {
+        layout = t_layout;
+        writeStages = t_stage;
+        writeAccess = AccessBits::eNone;
+        readStages = t_stage;
+        visibleStages = t_stage;
+        visibleAccess = t_access;
+    }
+
+    static void waitSemaphore(Context& t_context, VkSemaphore t_semaphore, u64 t_value) noexcept
+    {
+        uint64_t value = t_value;
+
+        VkSemaphoreWaitInfo waitInfo;
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.pNext = nullptr;
+        waitInfo.flags = 0;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &t_semaphore;
+        waitInfo.pValues = &value;
+
+        if (t_context.getDeviceTable().vkWaitSemaphores(t_context.getDevice(), &waitInfo, UINT64_MAX) != VK_SUCCESS)
+        {
+            t_context.getErrorCallback()("Failed to wait for timeline semaphore");
+        }
+    }
+
+    static auto semaphoreValue(Context& t_context, VkSemaphore t_semaphore) noexcept -> u64
+    {
+        uint64_t value = 0;
+        t_context.getDeviceTable().vkGetSemaphoreCounterValue(t_context.getDevice(), t_semaphore, &value);
+
+        return value;
+    }
+
+    GpuFuture::GpuFuture(Context* t_context, VkSemaphore t_semaphore, u64 t_value) noexcept
+        : m_context{ t_context }
+        , m_semaphore{ t_semaphore }
+        , m_value{ t_value }
+    {
+    }
+
+    auto GpuFuture::isReady() const noexcept -> bool
+    {
+        if (!m_semaphore || m_value == 0)
+        {
+            return true;
+        }
+
+        return semaphoreValue(*m_context, m_semaphore) >= m_value;
+    }
+
+    void GpuFuture::wait() const noexcept
+    {
+        if (!m_semaphore || m_value == 0)
+        {
+            return;
+        }
+
+        waitSemaphore(*m_context, m_semaphore, m_value);
+    }
+
+    auto GpuFuture::getSubmitInfo(PipelineStage t_stage) const noexcept -> VkSemaphoreSubmitInfo
+    {
+        VkSemaphoreSubmitInfo semaphoreInfo;
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        semaphoreInfo.pNext = nullptr;
+        semaphoreInfo.semaphore = m_semaphore;
+        semaphoreInfo.value = m_value;
+        semaphoreInfo.stageMask = t_stage;
+        semaphoreInfo.deviceIndex = 0;
+
+        return semaphoreInfo;
+    }
+
+    void TimelineSemaphore::create(Context& t_context) noexcept
+    {
+        m_context = &t_context;
+
+        VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo;
+        semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        semaphoreTypeCreateInfo.pNext = nullptr;
+        semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        semaphoreTypeCreateInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo;
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+        semaphoreCreateInfo.flags = 0;
+
+        if (m_context->getDeviceTable().vkCreateSemaphore(m_context->getDevice(), &semaphoreCreateInfo, nullptr, &m_handle) != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to create timeline semaphore");
+        }
+
+        m_submittedValue = 0;
+    }
+
+    void TimelineSemaphore::teardown() noexcept
+    {
+        if (m_handle) m_context->getDeviceTable().vkDestroySemaphore(m_context->getDevice(), m_handle, nullptr);
+        m_handle = nullptr;
+    }
+
+    auto TimelineSemaphore::submit(VkQueue t_queue, VkSubmitInfo2 t_submitInfo, PipelineStage t_stage) noexcept -> GpuFuture
+    {
+        std::scoped_lock lock(m_context->getQueueMutex());
+
+        GpuFuture future(m_context, m_handle, m_submittedValue.load() + 1);
+
+        std::vector<VkSemaphoreSubmitInfo> signalSemaphores(t_submitInfo.pSignalSemaphoreInfos, t_submitInfo.pSignalSemaphoreInfos + t_submitInfo.signalSemaphoreInfoCount);
+        signalSemaphores.emplace_back(future.getSubmitInfo(t_stage));
+
+        t_submitInfo.signalSemaphoreInfoCount = static_cast<u32>(signalSemaphores.size());
+        t_submitInfo.pSignalSemaphoreInfos = signalSemaphores.data();
+
+        if (m_context->getDeviceTable().vkQueueSubmit2(t_queue, 1, &t_submitInfo, nullptr) != VK_SUCCESS)
+        {
+            return { };
+        }
+
+        // Published only once submitted, so waiters never block on a value that will not be signaled
+        m_submittedValue = future.getValue();
+
+        return future;
+    }
+
+    auto TimelineSemaphore::getCompletedValue() const noexcept -> u64
+    {
+        return semaphoreValue(*m_context, m_handle);
+    }
+
+    auto TimelineSemaphore::isComplete(u64 t_value) const noexcept -> bool
+    {
+        return GpuFuture(m_context, m_handle, t_value).isReady();
+    }
+
+    void TimelineSemaphore::wait(u64 t_value) const noexcept
+    {
+        GpuFuture(m_context, m_handle, t_value).wait();
+    }
+
+    void TimelineSemaphore::waitIdle() const noexcept
+    {
+        wait(getSubmittedValue());
+    }
+}
\ No newline at end of file
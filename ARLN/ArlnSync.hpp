@@ -0,0 +1,90 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include <atomic>
+
+namespace arln {
+
+    struct UsageInfo
+    {
+        PipelineStage stage;
+        Access        access;
+        ImageLayout   layout;
+        bool          reads;
+        bool          writes;
+    };
+
+    auto getUsageInfo(ResourceUsage t_usage) noexcept -> UsageInfo;
+
+    // What the last accesses to an image subresource or buffer left behind, in recording order
+    struct ResourceState
+    {
+        ImageLayout   layout       { };
+        PipelineStage writeStages  { };
+        Access        writeAccess  { };
+        PipelineStage readStages   { };
+        PipelineStage visibleStages{ };
+        Access        visibleAccess{ };
+
+        // Records an access and fills t_barrier with the dependency it needs, returns false when none is needed
+        auto access(UsageInfo const& t_usage, bool t_image, MemoryBarrierInfo& t_barrier) noexcept -> bool;
+        void transitioned(ImageLayout t_layout, PipelineStage t_stage, Access t_access) noexcept;
+    };
+
+    class GpuFuture
+    {
+    private:
+        friend class TimelineSemaphore;
+        GpuFuture(Context* t_context, VkSemaphore t_semaphore, u64 t_value) noexcept;
+
+    public:
+        GpuFuture() = default;
+        ~GpuFuture() = default;
+        GpuFuture(GpuFuture const&) = default;
+        GpuFuture(GpuFuture&&) = default;
+        GpuFuture& operator=(GpuFuture const&) = default;
+        GpuFuture& operator=(GpuFuture&&) = default;
+
+        auto isReady() const noexcept -> bool;
+        void wait() const noexcept;
+        auto getSubmitInfo(PipelineStage t_stage) const noexcept -> VkSemaphoreSubmitInfo;
+
+        inline auto getContext()   const noexcept { return m_context;              }
+        inline auto getSemaphore() const noexcept { return m_semaphore;            }
+        inline auto getValue()     const noexcept { return m_value;                }
+        inline auto isValid()      const noexcept { return m_semaphore != nullptr; }
+
+    private:
+        Context*    m_context  { };
+        VkSemaphore m_semaphore{ };
+        u64         m_value    { };
+    };
+
+    class TimelineSemaphore
+    {
+    public:
+        TimelineSemaphore() = default;
+        TimelineSemaphore(TimelineSemaphore const&) = delete;
+        TimelineSemaphore(TimelineSemaphore&&) = delete;
+        TimelineSemaphore& operator=(TimelineSemaphore const&) = delete;
+        TimelineSemaphore& operator=(TimelineSemaphore&&) = delete;
+        ~TimelineSemaphore() = default;
+
+        void create(Context& t_context) noexcept;
+        void teardown() noexcept;
+        // Submits under the queue lock, signaling the next value at t_stage, returns an invalid future when the submit fails
+        auto submit(VkQueue t_queue, VkSubmitInfo2 t_submitInfo, PipelineStage t_stage) noexcept -> GpuFuture;
+        auto getCompletedValue() const noexcept -> u64;
+        auto isComplete(u64 t_value) const noexcept -> bool;
+        void wait(u64 t_value) const noexcept;
+        void waitIdle() const noexcept;
+
+        inline auto getHandle()         const noexcept { return m_handle;                                            }
+        inline auto getSubmittedValue() const noexcept { return m_submittedValue.load();                             }
+        inline auto getFuture()         const noexcept { return GpuFuture(m_context, m_handle, getSubmittedValue()); }
+
+    private:
+        Context*         m_context       { };
+        VkSemaphore      m_handle        { };
+        std::atomic<u64> m_submittedValue{ };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "ArlnTransientAllocator.hpp"
+#include "ArlnContext.hpp"
+#include <algorithm>
+
+namespace arln {
+
+    static auto toImageCreateInfo(Context const& t_context, TransientImageInfo const& t_info) noexcept -> VkImageCreateInfo
+    {
+        VkImageCreateInfo imageCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+        imageCreateInfo.format = static_cast<VkFormat>(t_info.format);
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.extent.width = t_info.width;
+        imageCreateInfo.extent.height = t_info.height;
+        imageCreateInfo.extent.depth = 1;
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | t_info.usage;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (auto& queueFamilyIndices = t_context.getQueueFamilyIndices();
+            queueFamilyIndices.size() > 1 && t_info.usage & ImageUsageBits::eStorage)
+        {
+            imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            imageCreateInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilyIndices.size());
+            imageCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+        }
+
+        return imageCreateInfo;
+    }
+
+    static auto toBufferCreateInfo(Context const& t_context, TransientBufferInfo const& t_info) noexcept -> VkBufferCreateInfo
+    {
+        VkBufferCreateInfo bufferCreateInfo;
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.pNext = nullptr;
+        bufferCreateInfo.flags = 0;
+        bufferCreateInfo.usage = t_info.usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | 1 | 2;
+        bufferCreateInfo.size = t_info.size;
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        bufferCreateInfo.queueFamilyIndexCount = 0;
+        bufferCreateInfo.pQueueFamilyIndices = nullptr;
+
+        if (auto& queueFamilyIndices = t_context.getQueueFamilyIndices(); queueFamilyIndices.size() > 1)
+        {
+            bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferCreateInfo.queueFamilyIndexCount = static_cast<u32>(queueFamilyIndices.size());
+            bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+        }
+
+        return bufferCreateInfo;
+    }
+
+    static auto alignUp(size_t t_value, size_t t_alignment) noexcept -> size_t
+    {
+        return (t_value + t_alignment - 1) / t_alignment * t_alignment;
+    }
+
+    TransientAllocator::TransientAllocator(Context& t_context) noexcept
+        : m_context{ &t_context }
+    {
+    }
+
+    auto TransientAllocator::addImage(TransientImageInfo const& t_info, u32 t_first, u32 t_last) noexcept -> u32
+    {
+        auto& resource = m_resources.emplace_back();
+        resource.imageInfo = t_info;
+        resource.isImage = true;
+        resource.first = t_first;
+        resource.last = t_last;
+
+        return static_cast<u32>(m_resources.size() - 1);
+    }
+
+    auto TransientAllocator::addBuffer(TransientBufferInfo const& t_info, u32 t_first, u32 t_last) noexcept -> u32
+    {
+        auto& resource = m_resources.emplace_back();
+        resource.bufferInfo = t_info;
+        resource.isImage = false;
+        resource.first = t_first;
+        resource.last = t_last;
+
+        return static_cast<u32>(m_resources.size() - 1);
+    }
+
+    void TransientAllocator::build() noexcept
+    {
+        bool const unchanged = std::ranges::equal(m_resources, m_built, [](Resource const& t_a, Resource const& t_b)
+        {
+            return t_a.isImage == t_b.isImage && t_a.first == t_b.first && t_a.last == t_b.last &&
+                   (t_a.isImage ? t_a.imageInfo == t_b.imageInfo : t_a.bufferInfo == t_b.bufferInfo);
+        });
+
+        if (unchanged)
+        {
+            m_resources = m_built;
+            return;
+        }
+
+        release();
+
+        m_memorySize = 0;
+        m_requestedSize = 0;
+
+        for (auto& resource : m_resources)
+        {
+            VkMemoryRequirements2 memoryRequirements{ VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+
+            if (resource.isImage)
+            {
+                auto imageCreateInfo = toImageCreateInfo(*m_context, resource.imageInfo);
+
+                VkDeviceImageMemoryRequirements imageRequirements{ VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS };
+                imageRequirements.pCreateInfo = &imageCreateInfo;
+
+                m_context->getDeviceTable().vkGetDeviceImageMemoryRequirements(m_context->getDevice(), &imageRequirements, &memoryRequirements);
+            }
+            else
+            {
+                auto bufferCreateInfo = toBufferCreateInfo(*m_context, resource.bufferInfo);
+
+                VkDeviceBufferMemoryRequirements bufferRequirements{ VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS };
+                bufferRequirements.pCreateInfo = &bufferCreateInfo;
+
+                m_context->getDeviceTable().vkGetDeviceBufferMemoryRequirements(m_context->getDevice(), &bufferRequirements, &memoryRequirements);
+            }
+
+            resource.requirements = memoryRequirements.memoryRequirements;
+            resource.predecessors.clear();
+        }
+
+        // Images and buffers get separate heaps so bufferImageGranularity never has to be considered
+        place(true, m_imageHeap);
+        place(false, m_bufferHeap);
+
+        for (auto& resource : m_resources)
+        {
+            Heap& heap = resource.isImage ? m_imageHeap : m_bufferHeap;
+
+            if (resource.isImage)
+            {
+                auto imageCreateInfo = toImageCreateInfo(*m_context, resource.imageInfo);
+
+                resource.image = Image{ };
+                resource.image.m_context = m_context;
+                resource.image.m_format = resource.imageInfo.format;
+                resource.image.m_concurrent = imageCreateInfo.sharingMode == VK_SHARING_MODE_CONCURRENT;
+
+                if (vmaCreateAliasingImage2(m_context->getAllocator(), heap.memory, resource.offset, &imageCreateInfo, &resource.image.m_handle) != VK_SUCCESS)
+                {
+                    m_context->getErrorCallback()("Failed to create transient image");
+                }
+
+                resource.image.createView(resource.imageInfo.format, resource.imageInfo.usage);
+
+                resource.image.resetStates(imageCreateInfo.mipLevels, imageCreateInfo.arrayLayers);
+
+                m_context->getCapture().createImage(resource.image, resource.imageInfo.width, resource.imageInfo.height, resource.imageInfo.usage, MemoryType::eGpuOnly);
+            }
+            else
+            {
+                auto bufferCreateInfo = toBufferCreateInfo(*m_context, resource.bufferInfo);
+
+                resource.buffer = Buffer{ };
+                resource.buffer.m_context = m_context;
+
+                if (vmaCreateAliasingBuffer2(m_context->getAllocator(), heap.memory, resource.offset, &bufferCreateInfo, &resource.buffer.m_handle) != VK_SUCCESS)
+                {
+                    m_context->getErrorCallback()("Failed to create transient buffer");
+                }
+
+                vmaGetAllocationInfo(m_context->getAllocator(), heap.memory, &resource.buffer.m_allocationInfo);
+                vmaGetAllocationMemoryProperties(m_context->getAllocator(), heap.memory, &resource.buffer.m_allocationInfo.memoryType);
+                resource.buffer.m_allocationInfo.offset += resource.offset;
+                resource.buffer.m_allocationInfo.size = resource.bufferInfo.size;
+                resource.buffer.m_allocationInfo.pMappedData = nullptr;
+
+                VkBufferDeviceAddressInfo bufferDeviceAddressInfo;
+                bufferDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+                bufferDeviceAddressInfo.buffer = resource.buffer.m_handle;
+                bufferDeviceAddressInfo.pNext = nullptr;
+
+                resource.buffer.m_deviceAddress = m_context->getDeviceTable().vkGetBufferDeviceAddress(m_context->getDevice(), &bufferDeviceAddressInfo);
+
+                m_context->getCapture().createBuffer(resource.buffer, resource.bufferInfo.usage, MemoryType::eGpuOnly);
+            }
+        }
+
+        m_built = m_resources;
+    }
+
+    void TransientAllocator::clear() noexcept
+    {
+        m_resources.clear();
+    }
+
+    void TransientAllocator::destroy() noexcept
+    {
+        release();
+        m_resources.clear();
+    }
+
+    void TransientAllocator::place(bool t_images, Heap& t_heap) noexcept
+    {
+        std::vector<u32> order;
+
+        for (u32 i = 0; i < m_resources.size(); ++i)
+        {
+            if (m_resources[i].isImage == t_images)
+            {
+                order.push_back(i);
+            }
+        }
+
+        if (order.empty())
+        {
+            return;
+        }
+
+        // Largest first, each resource takes the lowest offset not used by anything alive at the same time
+        std::ranges::stable_sort(order, [&](u32 t_a, u32 t_b)
+        {
+            return m_resources[t_a].requirements.size > m_resources[t_b].requirements.size;
+        });
+
+        VkMemoryRequirements heapRequirements{ 0, 1, ~0u };
+        std::vector<u32> placed;
+        std::vector<std::pair<size_t, size_t>> occupied;
+
+        for (u32 index : order)
+        {
+            auto& resource = m_resources[index];
+            auto const& requirements = resource.requirements;
+
+            occupied.clear();
+            for (u32 other : placed)
+            {
+                auto& placedResource = m_resources[other];
+
+                if (placedResource.first <= resource.last && resource.first <= placedResource.last)
+                {
+                    occupied.emplace_back(placedResource.offset, placedResource.offset + placedResource.requirements.size);
+                }
+            }
+            std::ranges::sort(occupied);
+
+            size_t offset = 0;
+            for (auto [begin, end] : occupied)
+            {
+                if (alignUp(offset, requirements.alignment) + requirements.size <= begin)
+                {
+                    break;
+                }
+                offset = std::max(offset, end);
+            }
+
+            resource.offset = alignUp(offset, requirements.alignment);
+            heapRequirements.size = std::max<VkDeviceSize>(heapRequirements.size, resource.offset + requirements.size);
+            heapRequirements.alignment = std::max(heapRequirements.alignment, requirements.alignment);
+            heapRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+            m_requestedSize += requirements.size;
+
+            placed.push_back(index);
+        }
+
+        // Whatever used overlapping memory earlier in the frame has to finish before a resource takes it over
+        for (u32 index : placed)
+        {
+            auto& resource = m_resources[index];
+
+            for (u32 other : placed)
+            {
+                auto& previous = m_resources[other];
+
+                if (previous.last < resource.first &&
+                    previous.offset < resource.offset + resource.requirements.size &&
+                    resource.offset < previous.offset + previous.requirements.size)
+                {
+                    resource.predecessors.push_back(other);
+                }
+            }
+        }
+
+        if (heapRequirements.memoryTypeBits == 0)
+        {
+            m_context->getErrorCallback()("Transient resources have no memory type in common");
+            return;
+        }
+
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        allocationCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        if (vmaAllocateMemory(m_context->getAllocator(), &heapRequirements, &allocationCreateInfo, &t_heap.memory, nullptr) != VK_SUCCESS)
+        {
+            m_context->getErrorCallback()("Failed to allocate transient memory");
+        }
+
+        t_heap.size = heapRequirements.size;
+        m_memorySize += t_heap.size;
+    }
+
+    void TransientAllocator::release() noexcept
+    {
+        if (!m_context)
+        {
+            return;
+        }
+
+        auto& deletionQueue = m_context->getDeletionQueue();
+
+        for (auto& resource : m_built)
+        {
+            if (resource.isImage && resource.image.getHandle())
+            {
+                m_context->getCapture().freeImage(resource.image.getHandle());
+                deletionQueue.push(resource.image.getHandle(), resource.image.getView());
+            }
+            else if (!resource.isImage && resource.buffer.getHandle())
+            {
+                m_context->getCapture().freeBuffer(resource.buffer.getHandle());
+                deletionQueue.push(resource.buffer.getHandle());
+            }
+        }
+
+        for (Heap* heap : { &m_imageHeap, &m_bufferHeap })
+        {
+            if (heap->memory)
+            {
+                deletionQueue.push(heap->memory);
+            }
+            *heap = { };
+        }
+
+        m_built.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include "ArlnImage.hpp"
+#include "ArlnBuffer.hpp"
+
+namespace arln {
+
+    class TransientAllocator
+    {
+    private:
+        friend class Context;
+        explicit TransientAllocator(Context& t_context) noexcept;
+
+    public:
+        TransientAllocator() = default;
+        ~TransientAllocator() = default;
+        TransientAllocator(TransientAllocator const&) = delete;
+        TransientAllocator(TransientAllocator&&) = default;
+        TransientAllocator& operator=(TransientAllocator const&) = delete;
+        TransientAllocator& operator=(TransientAllocator&&) = default;
+
+        // Lifetimes are inclusive [first, last] positions in recording order,
+        // resources whose lifetimes do not overlap may be placed in the same memory
+        auto addImage(TransientImageInfo const& t_info, u32 t_first, u32 t_last) noexcept -> u32;
+        auto addBuffer(TransientBufferInfo const& t_info, u32 t_first, u32 t_last) noexcept -> u32;
+
+        // Places and binds everything added since clear(), an unchanged set keeps its memory and handles
+        void build() noexcept;
+        void clear() noexcept;
+        void destroy() noexcept;
+
+        inline auto& getImage(u32 t_resource)             const noexcept { return m_resources[t_resource].image;        }
+        inline auto& getBuffer(u32 t_resource)            const noexcept { return m_resources[t_resource].buffer;       }
+        inline auto& getAliasPredecessors(u32 t_resource) const noexcept { return m_resources[t_resource].predecessors; }
+        inline auto  getMemorySize()                      const noexcept { return m_memorySize;                         }
+        inline auto  getRequestedSize()                   const noexcept { return m_requestedSize;                      }
+
+    private:
+        struct Resource
+        {
+            TransientImageInfo   imageInfo;
+            TransientBufferInfo  bufferInfo;
+            bool                 isImage;
+            u32                  first;
+            u32                  last;
+            VkMemoryRequirements requirements;
+            size_t               offset;
+            std::vector<u32>     predecessors;
+            Image                image;
+            Buffer               buffer;
+        };
+
+        struct Heap
+        {
+            VmaAllocation memory;
+            size_t        size;
+        };
+
+        void place(bool t_images, Heap& t_heap) noexcept;
+        void release() noexcept;
+
+        Context*              m_context      { };
+        std::vector<Resource> m_resources    { };
+        std::vector<Resource> m_built        { };
+        Heap                  m_imageHeap    { };
+        Heap                  m_bufferHeap   { };
+        size_t                m_memorySize   { };
+        size_t                m_requestedSize{ };
+    };
+}
\ No newline at end of file
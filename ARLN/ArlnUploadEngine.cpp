@@ -0,0 +1,372 @@
+#include "ArlnUploadEngine.hpp"
+#include "ArlnContext.hpp"
+#include <cstring>
+
+namespace arln {
+
+    void UploadEngine::create(Context& t_context) noexcept
+    {
+        m_context = &t_context;
+
+        m_timeline.create(t_context);
+        m_stagingBuffer = m_context->allocateBuffer(0, MemoryType::eCpu, s_stagingSize);
+    }
+
+    void UploadEngine::teardown() noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_recording)
+        {
+            m_context->getDeviceTable().vkEndCommandBuffer(m_currentBatch.commandBuffer);
+            m_freeBatches.emplace_back(std::move(m_currentBatch));
+            m_recording = false;
+        }
+
+        while (!m_inFlightBatches.empty())
+        {
+            m_freeBatches.emplace_back(std::move(m_inFlightBatches.front()));
+            m_inFlightBatches.pop_front();
+        }
+
+        for (auto& batch : m_freeBatches)
+        {
+            for (auto& buffer : batch.temporaryBuffers)
+            {
+                buffer.free();
+            }
+
+            if (batch.commandPool) m_context->getDeviceTable().vkDestroyCommandPool(m_context->getDevice(), batch.commandPool, nullptr);
+        }
+        m_freeBatches.clear();
+        m_pendingAcquires.clear();
+
+        m_stagingBuffer.free();
+
+        m_timeline.teardown();
+    }
+
+    void UploadEngine::uploadBuffer(VkBuffer t_buffer, void const* t_data, size_t t_size, size_t t_offset) noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        auto staging = allocateStaging(t_size);
+        writeStaging(staging, t_data, t_size);
+
+        beginBatch();
+
+        VkBufferCopy bufferCopy = {
+            .srcOffset = staging.offset,
+            .dstOffset = t_offset,
+            .size = t_size
+        };
+
+        m_context->getDeviceTable().vkCmdCopyBuffer(m_currentBatch.commandBuffer, staging.buffer, t_buffer, 1, &bufferCopy);
+    }
+
+    void UploadEngine::uploadImage(VkImage t_image, void const* t_data, size_t t_size, uvec2 t_extent, bool t_concurrent) noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        auto staging = allocateStaging(t_size);
+        writeStaging(staging, t_data, t_size);
+
+        beginBatch();
+
+        VkImageMemoryBarrier2 barrier;
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.pNext = nullptr;
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = t_image;
+        barrier.subresourceRange = VkImageSubresourceRange{
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        };
+
+        VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.imageMemoryBarrierCount = 1;
+        dependencyInfo.pImageMemoryBarriers = &barrier;
+
+        // The whole level is overwritten, so the transfer queue discards the old contents instead of acquiring them
+        m_context->getDeviceTable().vkCmdPipelineBarrier2(m_currentBatch.commandBuffer, &dependencyInfo);
+
+        VkBufferImageCopy copy{};
+        copy.bufferOffset = staging.offset;
+        copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.imageSubresource.layerCount = 1;
+        copy.imageExtent = {
+            .width = t_extent.x,
+            .height = t_extent.y,
+            .depth = 1
+        };
+
+        m_context->getDeviceTable().vkCmdCopyBufferToImage(m_currentBatch.commandBuffer, staging.buffer, t_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+        // Concurrent images are shared by every family and must not be transferred
+        if (t_concurrent || m_context->getTransferFamilyIndex() == m_context->getQueueFamilyIndex())
+        {
+            return;
+        }
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = m_context->getTransferFamilyIndex();
+        barrier.dstQueueFamilyIndex = m_context->getQueueFamilyIndex();
+
+        m_context->getDeviceTable().vkCmdPipelineBarrier2(m_currentBatch.commandBuffer, &dependencyInfo);
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+        // Only recordable once the batch releasing the image has been submitted
+        m_currentBatch.acquires.emplace_back(barrier);
+    }
+
+    void UploadEngine::recordAcquireBarriers(VkCommandBuffer t_commandBuffer) noexcept
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_pendingAcquires.empty())
+        {
+            return;
+        }
+
+        VkDependencyInfo dependencyInfo{ VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.imageMemoryBarrierCount = static_cast<u32>(m_pendingAcquires.size());
+        dependencyInfo.pImageMemoryBarriers = m_pendingAcquires.data();
+
+        m_context->getDeviceTable().vkCmdPipelineBarrier2(t_commandBuffer, &dependencyInfo);
+
+        m_pendingAcquires.clear();
+    }
+
+    auto UploadEngine::flush() noexcept -> GpuFuture
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (!m_recording)
+        {
+            return m_timeline.getFuture();
+        }
+
+        m_context->getDeviceTable().vkEndCommandBuffer(m_currentBatch.commandBuffer);
+        m_recording = false;
+
+        VkCommandBufferSubmitInfo commandBufferInfo;
+        commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+        commandBufferInfo.pNext = nullptr;
+        commandBufferInfo.commandBuffer = m_currentBatch.commandBuffer;
+        commandBufferInfo.deviceMask = 0;
+
+        VkSubmitInfo2 submitInfo;
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submitInfo.pNext = nullptr;
+        submitInfo.flags = 0;
+        submitInfo.waitSemaphoreInfoCount = 0;
+        submitInfo.pWaitSemaphoreInfos = nullptr;
+        submitInfo.commandBufferInfoCount = 1;
+        submitInfo.pCommandBufferInfos = &commandBufferInfo;
+        submitInfo.signalSemaphoreInfoCount = 0;
+        submitInfo.pSignalSemaphoreInfos = nullptr;
+
+        auto future = m_timeline.submit(m_context->getTransferQueue(), submitInfo, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+        if (!future.isValid())
+        {
+            m_context->getErrorCallback()("Failed to submit upload batch");
+        }
+
+        m_currentBatch.value = future.getValue();
+        m_pendingAcquires.insert(m_pendingAcquires.end(), m_currentBatch.acquires.begin(), m_currentBatch.acquires.end());
+        m_currentBatch.acquires.clear();
+
+        m_inFlightBatches.emplace_back(std::move(m_currentBatch));
+        m_currentBatch = { };
+
+        return future;
+    }
+
+    auto UploadEngine::hasPendingAcquires() const noexcept -> bool
+    {
+        std::scoped_lock lock(m_mutex);
+
+        return !m_pendingAcquires.empty();
+    }
+
+    void UploadEngine::beginBatch() noexcept
+    {
+        if (m_recording)
+        {
+            return;
+        }
+
+        reclaim();
+
+        if (m_freeBatches.empty())
+        {
+            VkCommandPoolCreateInfo commandPoolCreateInfo;
+            commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            commandPoolCreateInfo.pNext = nullptr;
+            commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            commandPoolCreateInfo.queueFamilyIndex = m_context->getTransferFamilyIndex();
+
+            if (m_context->getDeviceTable().vkCreateCommandPool(m_context->getDevice(), &commandPoolCreateInfo, nullptr, &m_currentBatch.commandPool) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to create upload command pool");
+            }
+
+            VkCommandBufferAllocateInfo allocateInfo;
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.pNext = nullptr;
+            allocateInfo.commandPool = m_currentBatch.commandPool;
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocateInfo.commandBufferCount = 1;
+
+            if (m_context->getDeviceTable().vkAllocateCommandBuffers(m_context->getDevice(), &allocateInfo, &m_currentBatch.commandBuffer) != VK_SUCCESS)
+            {
+                m_context->getErrorCallback()("Failed to allocate upload command buffer");
+            }
+        }
+        else
+        {
+            m_currentBatch.commandPool = m_freeBatches.back().commandPool;
+            m_currentBatch.commandBuffer = m_freeBatches.back().commandBuffer;
+            m_freeBatches.pop_back();
+        }
+
+        VkCommandBufferBeginInfo beginInfo;
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.pNext = nullptr;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+
+        m_context->getDeviceTable().vkBeginCommandBuffer(m_currentBatch.commandBuffer, &beginInfo);
+        m_recording = true;
+    }
+
+    void UploadEngine::reclaim() noexcept
+    {
+        if (m_inFlightBatches.empty())
+        {
+            return;
+        }
+
+        u64 completedValue = m_timeline.getCompletedValue();
+
+        while (!m_inFlightBatches.empty() && m_inFlightBatches.front().value <= completedValue)
+        {
+            auto& batch = m_inFlightBatches.front();
+
+            for (auto& buffer : batch.temporaryBuffers)
+            {
+                buffer.free();
+            }
+
+            m_context->getDeviceTable().vkResetCommandPool(m_context->getDevice(), batch.commandPool, 0);
+            m_stagingUsed -= batch.stagingBytes;
+
+            m_freeBatches.push_back({ batch.commandPool, batch.commandBuffer, {}, {}, 0, 0 });
+            m_inFlightBatches.pop_front();
+        }
+    }
+
+    auto UploadEngine::allocateStaging(size_t t_size) noexcept -> StagingRegion
+    {
+        size_t constexpr alignment = 16;
+        size_t const alignedSize = (t_size + alignment - 1) & ~(alignment - 1);
+
+        if (alignedSize > s_stagingSize)
+        {
+            beginBatch();
+
+            Buffer staging = m_context->allocateBuffer(0, MemoryType::eCpu, t_size);
+            m_currentBatch.temporaryBuffers.push_back(staging);
+
+            return {
+                staging.getHandle(),
+                staging.getAllocation(),
+                t_size,
+                0,
+                static_cast<u8*>(staging.getAllocationInfo().pMappedData),
+                (staging.getAllocationInfo().memoryType & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0
+            };
+        }
+
+        for (;;)
+        {
+            if (m_stagingUsed == 0)
+            {
+                m_stagingHead = 0;
+            }
+
+            size_t offset = m_stagingHead;
+            size_t padding = 0;
+
+            if (offset + alignedSize > s_stagingSize)
+            {
+                padding = s_stagingSize - offset;
+                offset = 0;
+            }
+
+            if (m_stagingUsed + padding + alignedSize <= s_stagingSize)
+            {
+                beginBatch();
+
+                m_stagingHead = offset + alignedSize;
+                m_stagingUsed += padding + alignedSize;
+                m_currentBatch.stagingBytes += padding + alignedSize;
+
+                return {
+                    m_stagingBuffer.getHandle(),
+                    m_stagingBuffer.getAllocation(),
+                    s_stagingSize,
+                    offset,
+                    static_cast<u8*>(m_stagingBuffer.getAllocationInfo().pMappedData) + offset,
+                    (m_stagingBuffer.getAllocationInfo().memoryType & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0
+                };
+            }
+
+            if (m_recording)
+            {
+                flush();
+            }
+            else
+            {
+                m_timeline.wait(m_inFlightBatches.front().value);
+                reclaim();
+            }
+        }
+    }
+
+    void UploadEngine::writeStaging(StagingRegion const& t_staging, void const* t_data, size_t t_size) noexcept
+    {
+        std::memcpy(t_staging.data, t_data, t_size);
+
+        if (t_staging.coherent || !t_size)
+        {
+            return;
+        }
+
+        VkDeviceSize const atomSize = std::max<VkDeviceSize>(m_context->getPhysicalDeviceProperties().properties.limits.nonCoherentAtomSize, 1);
+        VkDeviceSize const begin = t_staging.offset / atomSize * atomSize;
+        VkDeviceSize const end = std::min<VkDeviceSize>((t_staging.offset + t_size + atomSize - 1) / atomSize * atomSize, t_staging.capacity);
+
+        vmaFlushAllocation(m_context->getAllocator(), t_staging.allocation, begin, end - begin);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include "ArlnBuffer.hpp"
+#include "ArlnSync.hpp"
+#include <deque>
+#include <mutex>
+
+namespace arln {
+
+    class UploadEngine
+    {
+    public:
+        UploadEngine() = default;
+        UploadEngine(UploadEngine const&) = delete;
+        UploadEngine(UploadEngine&&) = delete;
+        UploadEngine& operator=(UploadEngine const&) = delete;
+        UploadEngine& operator=(UploadEngine&&) = delete;
+        ~UploadEngine() = default;
+
+        void create(Context& t_context) noexcept;
+        void teardown() noexcept;
+        void uploadBuffer(VkBuffer t_buffer, void const* t_data, size_t t_size, size_t t_offset) noexcept;
+        void uploadImage(VkImage t_image, void const* t_data, size_t t_size, uvec2 t_extent, bool t_concurrent) noexcept;
+        void recordAcquireBarriers(VkCommandBuffer t_commandBuffer) noexcept;
+        auto flush() noexcept -> GpuFuture;
+        auto hasPendingAcquires() const noexcept -> bool;
+
+        inline auto& getTimeline()        const noexcept { return m_timeline;             }
+        inline auto  getFuture()          const noexcept { return m_timeline.getFuture(); }
+
+        static constexpr size_t s_stagingSize = 64 * 1024 * 1024;
+
+    private:
+        struct Batch
+        {
+            VkCommandPool                      commandPool;
+            VkCommandBuffer                    commandBuffer;
+            std::vector<Buffer>                temporaryBuffers;
+            std::vector<VkImageMemoryBarrier2> acquires;
+            size_t                             stagingBytes;
+            u64                                value;
+        };
+
+        struct StagingRegion
+        {
+            VkBuffer      buffer;
+            VmaAllocation allocation;
+            size_t        capacity;
+            size_t        offset;
+            u8*           data;
+            bool          coherent;
+        };
+
+        void beginBatch() noexcept;
+        void reclaim() noexcept;
+        auto allocateStaging(size_t t_size) noexcept -> StagingRegion;
+        void writeStaging(StagingRegion const& t_staging, void const* t_data, size_t t_size) noexcept;
+
+        // Guards the staging ring, batches and pending acquires, recursive since allocateStaging may flush
+        mutable std::recursive_mutex       m_mutex          { };
+        Context*                           m_context        { };
+        Buffer                             m_stagingBuffer  { };
+        TimelineSemaphore                  m_timeline       { };
+        Batch                              m_currentBatch   { };
+        std::deque<Batch>                  m_inFlightBatches{ };
+        std::vector<Batch>                 m_freeBatches    { };
+        std::vector<VkImageMemoryBarrier2> m_pendingAcquires{ };
+        size_t                             m_stagingHead    { };
+        size_t                             m_stagingUsed    { };
+        bool                               m_recording      { };
+    };
+}
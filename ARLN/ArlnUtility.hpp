@@ -15,16 +15,26 @@
 namespace arln {
 
     class Buffer;
+    class BufferAllocator;
+    class Capture;
     class CommandBuffer;
     class Context;
+    class Defragmenter;
+    class DeletionQueue;
     class Descriptor;
     class DescriptorPool;
     class Frame;
+    class GpuFuture;
     class Image;
     class ImguiContext;
     class Pipeline;
+    class RenderGraph;
     class Sampler;
     class Swapchain;
+    class TransientAllocator;
+    class TimelineSemaphore;
+    class UploadEngine;
+    class WorkerPool;
     class Window;
 
     using CommandBufferHandle = VkCommandBuffer;
@@ -211,12 +221,33 @@ namespace arln {
         ePresentSrc = 1000001002,
     };
 
+    enum class ResourceUsage : u32
+    {
+        eNone = 0,
+        eColorAttachmentWrite,
+        eDepthAttachmentWrite,
+        eDepthAttachmentRead,
+        eFragmentSampled,
+        eComputeSampled,
+        eComputeStorageRead,
+        eComputeStorageWrite,
+        eComputeStorageReadWrite,
+        eTransferSrc,
+        eTransferDst,
+        ePresent,
+        eVertexBuffer,
+        eIndexBuffer,
+        eIndirectBuffer,
+        eUniformBuffer
+    };
+
     enum class MemoryType : u32
     {
         eGpu = 0,
         eGpuOnly = 1,
         eDedicated = 2,
-        eCpu = 3
+        eCpu = 3,
+        eReadback = 4
     };
 
     enum class DescriptorType : u32
@@ -241,6 +272,12 @@ namespace arln {
         eVsyncRelaxed = 3
     };
 
+    enum class LatencyMode : u32
+    {
+        eThroughput = 0,
+        eLowLatency = 1
+    };
+
     enum class Filter : u32
     {
         eNearest = 0,
@@ -436,6 +473,13 @@ namespace arln {
         ImageLayout imageLayout;
     };
 
+    struct BufferWrite
+    {
+        void const* data;
+        size_t      size;
+        size_t      offset;
+    };
+
     struct ImageCopy
     {
         ImageLayout srcLayout;
@@ -565,6 +609,98 @@ namespace arln {
         std::string applicationName = "ARLN Application";
         std::string engineName = "ARLN";
         PresentMode presentMode = PresentMode::eNoSync;
+        LatencyMode latencyMode = LatencyMode::eThroughput;
+        f64 frameRateLimit = 0.0;
+        bool headless = false;
+        u32 headlessImageCount = 3;
+        uvec2 headlessExtent = { 1280, 720 };
+        u32 framesInFlight = 2;
+        size_t frameUploadArenaSize = 16 * 1024 * 1024;
+        size_t frameUniformRingSize = 4 * 1024 * 1024;
+        size_t frameReadbackArenaSize = 4 * 1024 * 1024;
+        u32 gpuZoneCapacity = 256;
+        u32 workerThreadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        std::string pipelineCachePath;
+        std::string physicalDeviceName;
+        std::string physicalDeviceUUID;
+        i32 physicalDeviceIndex = -1;
+        bool parallelStartup = true;
+        std::string capturePath;
+        u64 captureFirstFrame = 0;
+        u64 captureFrameCount = 1;
+        size_t defragmentationBytesPerFrame = 0;
+    };
+
+    struct StartupPhase
+    {
+        std::string name;
+        f64 startMilliseconds{ };
+        f64 durationMilliseconds{ };
+        bool asynchronous{ };
+    };
+
+    struct StartupReport
+    {
+        std::vector<StartupPhase> phases;
+        f64 totalMilliseconds{ };
+    };
+
+    // Task and mesh invocations stay zero unless mesh shader queries are supported
+    struct PipelineStatistics
+    {
+        u64 inputAssemblyVertices{ };
+        u64 inputAssemblyPrimitives{ };
+        u64 vertexShaderInvocations{ };
+        u64 clippingInvocations{ };
+        u64 clippingPrimitives{ };
+        u64 fragmentShaderInvocations{ };
+        u64 computeShaderInvocations{ };
+        u64 taskShaderInvocations{ };
+        u64 meshShaderInvocations{ };
+    };
+
+    struct GpuZone
+    {
+        std::string name;
+        f64 beginMilliseconds{ };
+        f64 durationMilliseconds{ };
+        u32 depth{ };
+        PipelineStatistics statistics{ };
+        bool hasStatistics{ };
+    };
+
+    // Times are milliseconds on the CPU timeline since the context was created
+    struct FrameProfile
+    {
+        u64 frameNumber{ };
+        f64 cpuBeginMilliseconds{ };
+        f64 cpuEndMilliseconds{ };
+        std::vector<GpuZone> zones;
+        bool calibrated{ };
+    };
+
+    struct LatencyStats
+    {
+        f64 inputToPresentMilliseconds{ };
+        f64 frameWaitMilliseconds{ };
+        bool presentWait{ };
+    };
+
+    struct HeapBudget
+    {
+        u64 usage{ };
+        u64 budget{ };
+        u64 blockBytes{ };
+        u64 allocationBytes{ };
+        bool deviceLocal{ };
+    };
+
+    struct MemoryPressure
+    {
+        u32 heapIndex{ };
+        u64 usage{ };
+        u64 budget{ };
+        bool allocationFailed{ };
     };
 
     struct ImageTransitionInfo
@@ -576,6 +712,49 @@ namespace arln {
         PipelineStage dstStageMask;
         Access srcAccessMask;
         Access dstAccessMask;
+        u32 baseMipLevel = 0;
+        u32 levelCount = 1;
+        u32 baseArrayLayer = 0;
+        u32 layerCount = 1;
+    };
+
+    struct MemoryBarrierInfo
+    {
+        PipelineStage srcStageMask;
+        PipelineStage dstStageMask;
+        Access srcAccessMask;
+        Access dstAccessMask;
+    };
+
+    struct TransientImageInfo
+    {
+        u32 width;
+        u32 height;
+        Format format;
+        ImageUsage usage;
+
+        auto operator==(TransientImageInfo const&) const -> bool = default;
+    };
+
+    struct TransientBufferInfo
+    {
+        size_t size;
+        BufferUsage usage;
+
+        auto operator==(TransientBufferInfo const&) const -> bool = default;
+    };
+
+    // A range of a larger buffer owned by a BufferAllocator, offsets are in bytes from the start of buffer
+    struct BufferSlice
+    {
+        Buffer* buffer{ };
+        size_t size{ };
+        size_t offset{ };
+        u64 deviceAddress{ };
+        VmaVirtualAllocation allocation{ };
+        u32 block{ };
+
+        inline explicit operator bool() const noexcept { return buffer != nullptr; }
     };
 
     struct ColorAttachmentInfo
@@ -599,5 +778,6 @@ namespace arln {
         DepthAttachmentInfo* pDepthAttachment = nullptr;
         ivec2 size{ 0, 0 };
         ivec2 offset{ 0, 0 };
+        bool secondaryCommandBuffers{ };
     };
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "ArlnWorkerPool.hpp"
+
+namespace arln {
+
+    void WorkerPool::create(u32 t_threadCount) noexcept
+    {
+        m_stopping = false;
+        m_threads.reserve(t_threadCount);
+
+        for (u32 i = 0; i < t_threadCount; ++i)
+        {
+            m_threads.emplace_back([this]{ run(); });
+        }
+    }
+
+    void WorkerPool::teardown() noexcept
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeUp.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+        m_threads.clear();
+    }
+
+    void WorkerPool::parallelFor(u32 t_count, std::function<void(u32)> const& t_function) noexcept
+    {
+        if (t_count == 0)
+        {
+            return;
+        }
+
+        if (m_threads.empty() || t_count == 1)
+        {
+            for (u32 i = 0; i < t_count; ++i)
+            {
+                t_function(i);
+            }
+            return;
+        }
+
+        std::scoped_lock jobLock(m_jobMutex);
+
+        auto job = std::make_shared<Job>();
+        job->function = &t_function;
+        job->count = t_count;
+        {
+            std::scoped_lock lock(m_mutex);
+            m_job = job;
+            ++m_generation;
+        }
+        m_wakeUp.notify_all();
+
+        execute(*job);
+
+        std::unique_lock lock(m_mutex);
+        m_finished.wait(lock, [&]{ return job->doneCount.load() == t_count; });
+        m_job = nullptr;
+    }
+
+    void WorkerPool::run() noexcept
+    {
+        u64 generation = 0;
+
+        for (;;)
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock lock(m_mutex);
+                m_wakeUp.wait(lock, [&]{ return m_stopping || (m_job && m_generation != generation); });
+
+                if (m_stopping)
+                {
+                    return;
+                }
+
+                generation = m_generation;
+                job = m_job;
+            }
+
+            execute(*job);
+        }
+    }
+
+    void WorkerPool::execute(Job& t_job) noexcept
+    {
+        u32 completed = 0;
+
+        for (u32 index = t_job.nextIndex.fetch_add(1); index < t_job.count; index = t_job.nextIndex.fetch_add(1))
+        {
+            (*t_job.function)(index);
+            ++completed;
+        }
+
+        if (completed && t_job.doneCount.fetch_add(completed) + completed == t_job.count)
+        {
+            std::scoped_lock lock(m_mutex);
+            m_finished.notify_all();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include "ArlnUtility.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace arln {
+
+    class WorkerPool
+    {
+    public:
+        WorkerPool() = default;
+        WorkerPool(WorkerPool const&) = delete;
+        WorkerPool(WorkerPool&&) = delete;
+        WorkerPool& operator=(WorkerPool const&) = delete;
+        WorkerPool& operator=(WorkerPool&&) = delete;
+        ~WorkerPool() = default;
+
+        void create(u32 t_threadCount) noexcept;
+        void teardown() noexcept;
+
+        // Runs t_function for every index in [0, t_count) and returns once all of them finished,
+        // the calling thread takes part in the work
+        void parallelFor(u32 t_count, std::function<void(u32)> const& t_function) noexcept;
+
+        inline auto getThreadCount() const noexcept { return static_cast<u32>(m_threads.size()); }
+
+    private:
+        struct Job
+        {
+            std::function<void(u32)> const* function;
+            u32                             count;
+            std::atomic<u32>                nextIndex;
+            std::atomic<u32>                doneCount;
+        };
+
+        void run() noexcept;
+        void execute(Job& t_job) noexcept;
+
+        std::vector<std::thread> m_threads   { };
+        std::mutex               m_mutex     { };
+        std::mutex               m_jobMutex  { };
+        std::condition_variable  m_wakeUp    { };
+        std::condition_variable  m_finished  { };
+        std::shared_ptr<Job>     m_job       { };
+        u64                      m_generation{ };
+        bool                     m_stopping  { };
+    };
+}
\ No newline at end of file
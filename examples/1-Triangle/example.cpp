@@ -57,17 +57,7 @@ auto main() -> int
                 renderingInfo.pColorAttachment = &colorAttachmentInfo;
 
                 commandBuffer.begin();
-                commandBuffer.transitionImages({
-                    ImageTransitionInfo{
-                        context.getPresentImage(),
-                        ImageLayout::eUndefined,
-                        ImageLayout::eColorAttachment,
-                        PipelineStageBits::eColorAttachmentOutput,
-                        PipelineStageBits::eColorAttachmentOutput,
-                        0,
-                        AccessBits::eColorAttachmentWrite
-                    }
-                });
+                commandBuffer.require(context.getPresentImage(), ResourceUsage::eColorAttachmentWrite, true);
                 commandBuffer.beginRendering(renderingInfo);
 
                 commandBuffer.setViewport(0, f32(h), f32(w), -f32(h));
@@ -76,17 +66,7 @@ auto main() -> int
                 commandBuffer.draw(3);
 
                 commandBuffer.endRendering();
-                commandBuffer.transitionImages({
-                    ImageTransitionInfo{
-                        context.getPresentImage(),
-                        ImageLayout::eColorAttachment,
-                        ImageLayout::ePresentSrc,
-                        PipelineStageBits::eColorAttachmentOutput,
-                        PipelineStageBits::eColorAttachmentOutput,
-                        AccessBits::eColorAttachmentWrite,
-                        0
-                    }
-                });
+                commandBuffer.require(context.getPresentImage(), ResourceUsage::ePresent);
                 commandBuffer.end();
             }
             context.endFrame({ commandBuffer });
@@ -51,24 +51,34 @@ auto main() -> int
 #endif
     });
 
-    Image storageImage;
+    std::vector<Image> storageImages(context.getFramesInFlight());
+    std::vector<Descriptor> descriptors(context.getFramesInFlight());
     auto commandBuffer = context.allocateCommandBuffer();
+    auto computeCommandBuffer = context.allocateComputeCommandBuffer();
     auto descriptorPool = context.createDescriptorPool();
+    auto renderGraph = context.createRenderGraph();
 
     descriptorPool.addBinding(0, DescriptorType::eStorageImage, ShaderStageBits::eCompute);
-    auto descriptor = descriptorPool.createDescriptor();
+    for (auto& descriptor : descriptors)
+    {
+        descriptor = descriptorPool.createDescriptor();
+    }
 
     ComputePipelineInfo pipelineInfo;
     pipelineInfo.compShaderPath = "shaders/main.comp.spv";
-    pipelineInfo.descriptors << descriptor;
+    pipelineInfo.descriptors << descriptors.front();
     auto computePipeline = context.createComputePipeline(pipelineInfo);
 
     auto onResize = [&](u32 t_width, u32 t_height)
     {
-        storageImage.recreate(t_width, t_height, Format::eR16G16B16A16Sfloat, ImageUsageBits::eSampled | ImageUsageBits::eStorage, MemoryType::eDedicated);
-        DescriptorWriter()
-            .addImage(descriptor, storageImage, nullptr, 0, DescriptorType::eStorageImage)
-            .write();
+        for (size_t i = storageImages.size(); i--; )
+        {
+            storageImages[i].free();
+            storageImages[i] = context.allocateImage(t_width, t_height, Format::eR16G16B16A16Sfloat, ImageUsageBits::eSampled | ImageUsageBits::eStorage, MemoryType::eDedicated);
+            DescriptorWriter()
+                .addImage(descriptors[i], storageImages[i], nullptr, 0, DescriptorType::eStorageImage)
+                .write();
+        }
     };
 
     onResize(context.getCurrentExtent().x, context.getCurrentExtent().y);
@@ -92,68 +102,59 @@ auto main() -> int
         if (context.canRender())
         {
             context.beginFrame();
-            commandBuffer.begin();
-            {
-                commandBuffer.transitionImages(ImageTransitionInfo{
-                    .image = storageImage,
-                    .oldLayout = ImageLayout::eUndefined,
-                    .newLayout = ImageLayout::eGeneral,
-                    .srcStageMask = PipelineStageBits::eTransfer,
-                    .dstStageMask = PipelineStageBits::eComputeShader,
-                    .srcAccessMask = AccessBits::eTransferRead,
-                    .dstAccessMask = AccessBits::eShaderStorageRead | AccessBits::eShaderStorageWrite
-                });
 
-                commandBuffer.bindComputePipeline(computePipeline);
-                commandBuffer.bindDescriptorCompute(computePipeline, descriptor);
-                commandBuffer.dispatch(static_cast<u32>(std::ceil(f32(context.getCurrentExtent().x) / 16.f)),
-                                       static_cast<u32>(std::ceil(f32(context.getCurrentExtent().y) / 16.f)), 1);
-
-                commandBuffer.transitionImages({
-                    ImageTransitionInfo{
-                        .image = storageImage,
-                        .oldLayout = ImageLayout::eGeneral,
-                        .newLayout = ImageLayout::eTransferSrc,
-                        .srcStageMask = PipelineStageBits::eComputeShader,
-                        .dstStageMask = PipelineStageBits::eTransfer,
-                        .srcAccessMask = AccessBits::eShaderStorageRead | AccessBits::eShaderStorageWrite,
-                        .dstAccessMask = AccessBits::eTransferRead
-                    },
-                    ImageTransitionInfo{
-                        .image = context.getPresentImage(),
-                        .oldLayout = ImageLayout::eUndefined,
-                        .newLayout = ImageLayout::eTransferDst,
-                        .srcStageMask = PipelineStageBits::eColorAttachmentOutput,
-                        .dstStageMask = PipelineStageBits::eTransfer,
-                        .srcAccessMask = AccessBits::eNone,
-                        .dstAccessMask = AccessBits::eTransferWrite
-                    }
-                });
+            auto& storageImage = storageImages[context.getFrame().getIndex()];
+            auto& descriptor = descriptors[context.getFrame().getIndex()];
 
-                commandBuffer.blitImage(storageImage, context.getPresentImage(), ImageBlit{
+            // Both batches share one graph so the storage image state carries over from the compute queue
+            renderGraph.importImage(storageImage);
+            renderGraph.importImage(context.getPresentImage(), ImageLayout::eUndefined, PipelineStageBits::eColorAttachmentOutput);
+
+            computeCommandBuffer.begin();
+            renderGraph.addPass("Compute", [&](RenderGraph::PassBuilder& t_builder)
+            {
+                t_builder.write(storageImage, ResourceUsage::eComputeStorageWrite);
+            },
+            [&](CommandBuffer& t_commandBuffer)
+            {
+                t_commandBuffer.bindComputePipeline(computePipeline);
+                t_commandBuffer.bindDescriptorCompute(computePipeline, descriptor);
+                t_commandBuffer.dispatch(static_cast<u32>(std::ceil(f32(context.getCurrentExtent().x) / 16.f)),
+                                         static_cast<u32>(std::ceil(f32(context.getCurrentExtent().y) / 16.f)), 1);
+            });
+            renderGraph.exportImage(storageImage);
+            renderGraph.execute(computeCommandBuffer);
+            computeCommandBuffer.end();
+
+            commandBuffer.begin();
+            renderGraph.addPass("Blit", [&](RenderGraph::PassBuilder& t_builder)
+            {
+                t_builder.read(storageImage, ResourceUsage::eTransferSrc);
+                t_builder.write(context.getPresentImage(), ResourceUsage::eTransferDst);
+            },
+            [&](CommandBuffer& t_commandBuffer)
+            {
+                t_commandBuffer.blitImage(storageImage, context.getPresentImage(), ImageBlit{
                     .srcLayout = ImageLayout::eTransferSrc,
                     .dstLayout = ImageLayout::eTransferDst,
                     .srcSize = { w, h, 1 },
                     .dstSize = { w, h, 1 },
                     .filter = Filter::eLinear
                 });
-
-                commandBuffer.transitionImages(ImageTransitionInfo{
-                    .image = context.getPresentImage(),
-                    .oldLayout = ImageLayout::eTransferDst,
-                    .newLayout = ImageLayout::ePresentSrc,
-                    .srcStageMask = PipelineStageBits::eTransfer,
-                    .dstStageMask = PipelineStageBits::eColorAttachmentOutput,
-                    .srcAccessMask = AccessBits::eTransferWrite,
-                    .dstAccessMask = AccessBits::eNone
-                });
-            }
+            });
+            renderGraph.exportImage(context.getPresentImage(), ResourceUsage::ePresent);
+            renderGraph.execute(commandBuffer);
             commandBuffer.end();
-            context.endFrame({ commandBuffer });
+            // The blit barrier takes over the compute queue state, so its compute source stage has to be waited on too
+            context.endFrame({ commandBuffer }, { computeCommandBuffer }, PipelineStageBits::eComputeShader | PipelineStageBits::eTransfer);
         }
     }
 
+    renderGraph.destroy();
     computePipeline.destroy();
     descriptorPool.destroy();
-    storageImage.free();
+    for (auto& storageImage : storageImages)
+    {
+        storageImage.free();
+    }
 }
\ No newline at end of file
@@ -22,7 +22,7 @@ auto main() -> int
         .layers = { "VK_LAYER_KHRONOS_validation" }
 #endif
     });
-    ImguiContext::Init(window);
+    ImguiContext::Init(context, window);
     ImGui::GetIO().IniFilename = nullptr;
     ImGui::GetIO().LogFilename = nullptr;
 
@@ -32,7 +32,7 @@ auto main() -> int
     });
 
     auto commandBuffer = context.allocateCommandBuffer();
-    auto imguiCommandBuffer = context.allocateCommandBuffer();
+    auto renderGraph = context.createRenderGraph();
     auto renderAttachment = context.allocateImage(1, 1, context.getDefaultColorFormat(), ImageUsageBits::eColorAttachment | ImageUsageBits::eSampled, MemoryType::eCpu);
     auto imguiDescriptor = ImguiContext::CreateImguiImage(renderAttachment);
 
@@ -58,6 +58,31 @@ auto main() -> int
                 ImGui::TextColored({1.f, 1.f, 0.f, 1.f}, "Hello world!");
                 ImGui::TextColored({1.f, 1.f, 0.f, 1.f}, "Hello world!");
                 ImGui::TextColored({1.f, 1.f, 0.f, 1.f}, "Hello world!");
+
+                static bool lowLatency = false;
+                if (ImGui::Checkbox("Low latency", &lowLatency))
+                {
+                    context.setLatencyMode(lowLatency ? LatencyMode::eLowLatency : LatencyMode::eThroughput);
+                }
+                ImGui::Text("Input to present: %.2f ms", context.getLatencyStats().inputToPresentMilliseconds);
+
+                for (auto& heap : context.getHeapBudgets())
+                {
+                    if (heap.deviceLocal)
+                    {
+                        ImGui::Text("VRAM: %llu / %llu MB", heap.usage >> 20, heap.budget >> 20);
+                    }
+                }
+
+                for (auto& zone : context.getFrame().getLatestProfile().zones)
+                {
+                    ImGui::Text("%s: %.3f ms", zone.name.c_str(), zone.durationMilliseconds);
+
+                    if (zone.hasStatistics)
+                    {
+                        ImGui::Text("  vertices %llu, fragments %llu", zone.statistics.vertexShaderInvocations, zone.statistics.fragmentShaderInvocations);
+                    }
+                }
             }
             ImGui::End();
 
@@ -76,7 +101,7 @@ auto main() -> int
             if ((viewportSize.x != currentSize.x || viewportSize.y != currentSize.y) && (viewportSize.x > 0 && viewportSize.y > 0))
             {
                 currentSize = viewportSize;
-                renderAttachment.recreate((u32)viewportSize.x, (u32)viewportSize.y, context.getDefaultColorFormat(), ImageUsageBits::eColorAttachment | ImageUsageBits::eSampled, MemoryType::eGpu);
+                renderAttachment.recreate(context, (u32)viewportSize.x, (u32)viewportSize.y, context.getDefaultColorFormat(), ImageUsageBits::eColorAttachment | ImageUsageBits::eSampled, MemoryType::eGpu);
                 ImguiContext::RecreateImguiImage(renderAttachment, imguiDescriptor);
             }
 
@@ -85,81 +110,63 @@ auto main() -> int
 
             context.beginFrame();
             {
+                ColorAttachmentInfo colorAttachment;
+                colorAttachment.image = renderAttachment;
+                colorAttachment.clearColor = {clearColors[0], clearColors[1], clearColors[2], 1.f};
+
+                RenderingInfo renderingInfo;
+                renderingInfo.pColorAttachment = &colorAttachment;
+                renderingInfo.size = {currentSize.x, currentSize.y};
+
+                ColorAttachmentInfo imguiColorAttachment;
+                imguiColorAttachment.image = context.getPresentImage();
+                imguiColorAttachment.clearColor = {0.f, 0.f, 0.f, 1.f};
+
+                RenderingInfo imguiRenderingInfo;
+                imguiRenderingInfo.pColorAttachment = &imguiColorAttachment;
+
+                renderGraph.importImage(renderAttachment);
+                renderGraph.importImage(context.getPresentImage(), ImageLayout::eUndefined, PipelineStageBits::eColorAttachmentOutput);
+
+                renderGraph.addPass("Scene", [&](RenderGraph::PassBuilder& t_builder)
                 {
-                    commandBuffer.begin();
-                    ColorAttachmentInfo colorAttachment;
-                    colorAttachment.image = renderAttachment;
-                    colorAttachment.clearColor = {clearColors[0], clearColors[1], clearColors[2], 1.f};
-
-                    RenderingInfo renderingInfo;
-                    renderingInfo.pColorAttachment = &colorAttachment;
-                    renderingInfo.size = {currentSize.x, currentSize.y};
-
-                    commandBuffer.transitionImages(ImageTransitionInfo{
-                        renderAttachment,
-                        ImageLayout::eUndefined,
-                        ImageLayout::eColorAttachment,
-                        PipelineStageBits::eFragmentShader,
-                        PipelineStageBits::eColorAttachmentOutput,
-                        AccessBits::eShaderRead,
-                        AccessBits::eColorAttachmentWrite
-                    });
-                    commandBuffer.beginRendering(renderingInfo);
-
-                    commandBuffer.setScissor(0, 0, static_cast<u32>(currentSize.x), static_cast<u32>(currentSize.y));
-                    commandBuffer.setViewport(0, currentSize.y, currentSize.x, -currentSize.y);
-                    commandBuffer.bindGraphicsPipeline(pipeline);
-                    commandBuffer.draw(3);
-
-                    commandBuffer.endRendering();
-                    commandBuffer.transitionImages(ImageTransitionInfo{
-                        renderAttachment,
-                        ImageLayout::eColorAttachment,
-                        ImageLayout::eShaderReadOnly,
-                        PipelineStageBits::eColorAttachmentOutput,
-                        PipelineStageBits::eFragmentShader,
-                        AccessBits::eColorAttachmentWrite,
-                        AccessBits::eShaderRead
-                    });
-                    commandBuffer.end();
-                }
+                    t_builder.write(renderAttachment, ResourceUsage::eColorAttachmentWrite);
+                },
+                [&](CommandBuffer& t_commandBuffer)
                 {
-                    ColorAttachmentInfo imguiColorAttachment;
-                    imguiColorAttachment.image = context.getPresentImage();
-                    imguiColorAttachment.clearColor = {0.f, 0.f, 0.f, 1.f};
-
-                    RenderingInfo imguiRenderingInfo;
-                    imguiRenderingInfo.pColorAttachment = &imguiColorAttachment;
-
-                    imguiCommandBuffer.begin();
-                    imguiCommandBuffer.transitionImages(ImageTransitionInfo{
-                        .image = context.getPresentImage(),
-                        .oldLayout = ImageLayout::eUndefined,
-                        .newLayout = ImageLayout::eColorAttachment,
-                        .srcStageMask = PipelineStageBits::eColorAttachmentOutput,
-                        .dstStageMask = PipelineStageBits::eColorAttachmentOutput,
-                        .srcAccessMask = AccessBits::eNone,
-                        .dstAccessMask = AccessBits::eColorAttachmentWrite
-                    });
-                    imguiCommandBuffer.beginRendering(imguiRenderingInfo);
-                    ImguiContext::Render(imguiCommandBuffer);
-                    imguiCommandBuffer.endRendering();
-                    imguiCommandBuffer.transitionImages(ImageTransitionInfo{
-                        .image = context.getPresentImage(),
-                        .oldLayout = ImageLayout::eColorAttachment,
-                        .newLayout = ImageLayout::ePresentSrc,
-                        .srcStageMask = PipelineStageBits::eColorAttachmentOutput,
-                        .dstStageMask = PipelineStageBits::eColorAttachmentOutput,
-                        .srcAccessMask = AccessBits::eColorAttachmentWrite,
-                        .dstAccessMask = AccessBits::eNone
-                    });
-                    imguiCommandBuffer.end();
-                }
+                    t_commandBuffer.beginZone("Scene draw", true);
+                    t_commandBuffer.beginRendering(renderingInfo);
+                    t_commandBuffer.setScissor(0, 0, static_cast<u32>(currentSize.x), static_cast<u32>(currentSize.y));
+                    t_commandBuffer.setViewport(0, currentSize.y, currentSize.x, -currentSize.y);
+                    t_commandBuffer.bindGraphicsPipeline(pipeline);
+                    t_commandBuffer.draw(3);
+                    t_commandBuffer.endRendering();
+                    t_commandBuffer.endZone();
+                });
+
+                renderGraph.addPass("ImGui", [&](RenderGraph::PassBuilder& t_builder)
+                {
+                    t_builder.read(renderAttachment, ResourceUsage::eFragmentSampled);
+                    t_builder.write(context.getPresentImage(), ResourceUsage::eColorAttachmentWrite);
+                },
+                [&](CommandBuffer& t_commandBuffer)
+                {
+                    t_commandBuffer.beginRendering(imguiRenderingInfo);
+                    ImguiContext::Render(t_commandBuffer);
+                    t_commandBuffer.endRendering();
+                });
+
+                renderGraph.exportImage(context.getPresentImage(), ResourceUsage::ePresent);
+
+                commandBuffer.begin();
+                renderGraph.execute(commandBuffer);
+                commandBuffer.end();
             }
-            context.endFrame({ commandBuffer, imguiCommandBuffer });
+            context.endFrame({ commandBuffer });
         }
     }
 
+    renderGraph.destroy();
     pipeline.destroy();
     renderAttachment.free();
     ImguiContext::Terminate();
@@ -0,0 +1,105 @@
+#include <Arln.hpp>
+#include <iostream>
+#include <chrono>
+
+auto main(int argc, char** argv) -> int
+{
+    using namespace arln;
+
+    u32 frameCount = argc > 1 ? static_cast<u32>(std::stoul(argv[1])) : 1000;
+
+    auto errorCallback = [](std::string_view t_error) { std::cerr << "[ERROR]\t" << t_error << std::endl; std::exit(1); };
+    auto infoCallback  = [](std::string_view t_info) { std::cout << "[INFO]\t" << t_info << std::endl; };
+
+    Context context = Context({
+        .errorCallback = errorCallback,
+        .infoCallback = infoCallback,
+#ifndef NDEBUG
+        .layers = { "VK_LAYER_KHRONOS_validation" },
+#endif
+        .headless = true,
+        .headlessImageCount = 3,
+        .headlessExtent = { 1920, 1080 }
+    });
+
+    auto commandBuffer = context.allocateCommandBuffer();
+
+    auto pipeline = context.createGraphicsPipeline({
+        .vertShaderPath = "shaders/main.vert.spv",
+        .fragShaderPath = "shaders/main.frag.spv"
+    });
+
+    auto w = context.getCurrentExtent().x;
+    auto h = context.getCurrentExtent().y;
+
+    GpuFuture lastFrame;
+    Readback centerPixel;
+    auto start = std::chrono::steady_clock::now();
+
+    for (u32 i = 0; i < frameCount; ++i)
+    {
+        context.beginFrame();
+        {
+            ColorAttachmentInfo colorAttachmentInfo;
+            colorAttachmentInfo.clearColor = { 0.25f, 0.25f, 0.25f, 1.f };
+            colorAttachmentInfo.image = context.getPresentImage();
+
+            RenderingInfo renderingInfo;
+            renderingInfo.pColorAttachment = &colorAttachmentInfo;
+
+            commandBuffer.begin();
+            commandBuffer.transitionImages({
+                ImageTransitionInfo{
+                    context.getPresentImage(),
+                    ImageLayout::eUndefined,
+                    ImageLayout::eColorAttachment,
+                    PipelineStageBits::eColorAttachmentOutput,
+                    PipelineStageBits::eColorAttachmentOutput,
+                    0,
+                    AccessBits::eColorAttachmentWrite
+                }
+            });
+            commandBuffer.beginRendering(renderingInfo);
+
+            commandBuffer.setViewport(0, f32(h), f32(w), -f32(h));
+            commandBuffer.setScissor(0, 0, w, h);
+            commandBuffer.bindGraphicsPipeline(pipeline);
+            commandBuffer.draw(3);
+
+            commandBuffer.endRendering();
+            commandBuffer.transitionImages({
+                ImageTransitionInfo{
+                    context.getPresentImage(),
+                    ImageLayout::eColorAttachment,
+                    ImageLayout::eTransferSrc,
+                    PipelineStageBits::eColorAttachmentOutput,
+                    PipelineStageBits::eTransfer,
+                    AccessBits::eColorAttachmentWrite,
+                    AccessBits::eTransferRead
+                }
+            });
+            commandBuffer.end();
+
+            // Comes back a frame or two later without stalling the loop
+            centerPixel = context.readbackImage(context.getPresentImage(), BufferImageCopy{
+                .imageOffset = { i32(w / 2), i32(h / 2), 0 },
+                .imageExtent = { 1, 1, 1 },
+                .imageLayout = ImageLayout::eTransferSrc
+            }, 4);
+        }
+        lastFrame = context.endFrame({ commandBuffer });
+    }
+
+    lastFrame.wait();
+
+    auto seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[INFO]\tRendered " << frameCount << " frames in " << seconds << "s ("
+              << static_cast<f64>(frameCount) / seconds << " frames/s)" << std::endl;
+
+    if (auto pixel = centerPixel.getData(); !pixel.empty())
+    {
+        std::cout << "[INFO]\tCenter pixel: " << u32(pixel[0]) << " " << u32(pixel[1]) << " " << u32(pixel[2]) << " " << u32(pixel[3]) << std::endl;
+    }
+
+    pipeline.destroy();
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include <Arln.hpp>
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+auto main(int argc, char** argv) -> int
+{
+    using namespace arln;
+
+    u32 contextCount = argc > 1 ? static_cast<u32>(std::stoul(argv[1])) : std::max(std::thread::hardware_concurrency(), 1u);
+    u32 frameCount   = argc > 2 ? static_cast<u32>(std::stoul(argv[2])) : 500;
+
+    std::mutex outputMutex;
+
+    auto worker = [&](u32 t_index)
+    {
+        auto errorCallback = [&](std::string_view t_error) { std::scoped_lock lock(outputMutex); std::cerr << "[ERROR " << t_index << "]\t" << t_error << std::endl; std::exit(1); };
+        auto infoCallback  = [&](std::string_view t_info) { std::scoped_lock lock(outputMutex); std::cout << "[INFO " << t_index << "]\t" << t_info << std::endl; };
+
+        Context context = Context({
+            .errorCallback = errorCallback,
+            .infoCallback = infoCallback,
+            .headless = true,
+            .headlessImageCount = 3,
+            .headlessExtent = { 1280, 720 },
+            .pipelineCachePath = "pipeline_cache_" + std::to_string(t_index) + ".bin"
+        });
+
+        auto commandBuffer = context.allocateCommandBuffer();
+
+        auto pipeline = context.createGraphicsPipeline({
+            .vertShaderPath = "shaders/main.vert.spv",
+            .fragShaderPath = "shaders/main.frag.spv"
+        });
+
+        auto w = context.getCurrentExtent().x;
+        auto h = context.getCurrentExtent().y;
+
+        GpuFuture lastFrame;
+
+        for (u32 i = 0; i < frameCount; ++i)
+        {
+            context.beginFrame();
+            {
+                ColorAttachmentInfo colorAttachmentInfo;
+                colorAttachmentInfo.clearColor = { 0.25f, 0.25f, 0.25f, 1.f };
+                colorAttachmentInfo.image = context.getPresentImage();
+
+                RenderingInfo renderingInfo;
+                renderingInfo.pColorAttachment = &colorAttachmentInfo;
+
+                commandBuffer.begin();
+                commandBuffer.transitionImages({
+                    ImageTransitionInfo{
+                        context.getPresentImage(),
+                        ImageLayout::eUndefined,
+                        ImageLayout::eColorAttachment,
+                        PipelineStageBits::eColorAttachmentOutput,
+                        PipelineStageBits::eColorAttachmentOutput,
+                        0,
+                        AccessBits::eColorAttachmentWrite
+                    }
+                });
+                commandBuffer.beginRendering(renderingInfo);
+
+                commandBuffer.setViewport(0, f32(h), f32(w), -f32(h));
+                commandBuffer.setScissor(0, 0, w, h);
+                commandBuffer.bindGraphicsPipeline(pipeline);
+                commandBuffer.draw(3);
+
+                commandBuffer.endRendering();
+                commandBuffer.end();
+            }
+            lastFrame = context.endFrame({ commandBuffer });
+        }
+
+        lastFrame.wait();
+        pipeline.destroy();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (u32 i = 0; i < contextCount; ++i)
+    {
+        threads.emplace_back(worker, i);
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[INFO]\tRendered " << contextCount * frameCount << " frames on " << contextCount << " contexts in " << seconds << "s ("
+              << static_cast<f64>(contextCount * frameCount) / seconds << " frames/s)" << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <Arln.hpp>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <map>
+
+auto main(int argc, char** argv) -> int
+{
+    using namespace arln;
+
+    if (argc < 2)
+    {
+        std::cout << "usage: ArlnReplay <capture file> [--loops N] [--paced]" << std::endl;
+        return 1;
+    }
+
+    std::string path = argv[1];
+    u32 loops = 1;
+    bool paced = false;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string_view argument = argv[i];
+
+        if (argument == "--loops" && i + 1 < argc) loops = std::max(static_cast<u32>(std::stoul(argv[++i])), 1u);
+        else if (argument == "--paced")            paced = true;
+    }
+
+    auto errorCallback = [](std::string_view t_error) { std::cerr << "[ERROR]\t" << t_error << std::endl; std::exit(1); };
+    auto infoCallback  = [](std::string_view t_info) { std::cout << "[INFO]\t" << t_info << std::endl; };
+
+    CaptureHeader header;
+    if (!CaptureReplay::readHeader(path, header))
+    {
+        errorCallback("Not a capture file: " + path);
+    }
+
+    Context context = Context({
+        .errorCallback = errorCallback,
+        .infoCallback = infoCallback,
+#ifndef NDEBUG
+        .layers = { "VK_LAYER_KHRONOS_validation" },
+#endif
+        .headless = true,
+        .headlessImageCount = 3,
+        .headlessExtent = header.extent
+    });
+
+    std::vector<f64> intervals;
+    std::map<std::string, std::pair<f64, u32>> zones;
+    u32 frameCount = 0;
+    f64 seconds = 0.0;
+    u64 missingReferences = 0;
+
+    {
+        CaptureReplay replay(context);
+
+        if (!replay.load(path) || replay.getFrameCount() == 0)
+        {
+            errorCallback("Capture holds no frames: " + path);
+        }
+
+        GpuFuture lastFrame;
+        auto start = std::chrono::steady_clock::now();
+        auto previous = start;
+        u64 profiledFrame = 0;
+
+        for (u32 loop = 0; loop < loops; ++loop)
+        {
+            auto loopStart = std::chrono::steady_clock::now();
+
+            for (u32 frame = 0; frame < replay.getFrameCount(); ++frame)
+            {
+                // Paced replay keeps the captured spacing between frame begins
+                if (paced)
+                {
+                    auto offset = std::chrono::duration<f64, std::milli>(replay.getFrameTimestamp(frame) - replay.getFrameTimestamp(0));
+                    std::this_thread::sleep_until(loopStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset));
+                }
+
+                lastFrame = replay.playFrame(frame);
+
+                auto now = std::chrono::steady_clock::now();
+                intervals.push_back(std::chrono::duration<f64, std::milli>(now - previous).count());
+                previous = now;
+                ++frameCount;
+
+                // Profiles arrive a few frames late, each one is counted once
+                auto& profile = context.getProfiler().getLatestProfile();
+                if (profile.frameNumber == profiledFrame)
+                {
+                    continue;
+                }
+                profiledFrame = profile.frameNumber;
+
+                for (auto& zone : profile.zones)
+                {
+                    auto& [total, count] = zones[zone.name];
+                    total += zone.durationMilliseconds;
+                    ++count;
+                }
+            }
+        }
+
+        lastFrame.wait();
+        seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        missingReferences = replay.getMissingReferences();
+    }
+
+    std::sort(intervals.begin(), intervals.end());
+    auto percentile = [&](f64 t_fraction) { return intervals[static_cast<size_t>(t_fraction * static_cast<f64>(intervals.size() - 1))]; };
+    f64 average = 0.0;
+    for (f64 interval : intervals) average += interval;
+    average /= static_cast<f64>(intervals.size());
+
+    std::cout << "[INFO]\tReplayed " << frameCount << " frames in " << seconds << "s ("
+              << static_cast<f64>(frameCount) / seconds << " frames/s)" << std::endl;
+    std::cout << "[INFO]\tFrame interval ms: avg " << average << " min " << intervals.front() << " p50 " << percentile(0.5)
+              << " p95 " << percentile(0.95) << " max " << intervals.back() << std::endl;
+
+    for (auto& [name, zone] : zones)
+    {
+        std::cout << "[INFO]\tGPU zone " << name << ": " << zone.first / zone.second << "ms avg" << std::endl;
+    }
+
+    if (missingReferences)
+    {
+        std::cout << "[INFO]\tSkipped " << missingReferences << " references to resources missing from the capture" << std::endl;
+    }
+}
\ No newline at end of file